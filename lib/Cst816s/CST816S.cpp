@@ -134,6 +134,22 @@ uint8_t CST816S::getTouchType(void)
 	return Touch_Data[3] >> 7;
 }
 
+uint8_t CST816S::getGesture(void)
+{
+	return Touch_Data[1];
+}
+
+uint8_t CST816S::getFingerNum(void)
+{
+	return Touch_Data[2];
+}
+
+// IRQ_* bits: which events pulse the INT pin
+void CST816S::setIrqMode(uint8_t mode)
+{
+	_writeReg(IrqCtl, &mode, 1);
+}
+
 uint16_t CST816S::getX(void)
 {
 	return ((uint16_t)(Touch_Data[3] & 0x0F) << 8) + (uint16_t)Touch_Data[4];
@@ -40,6 +40,13 @@
 #define IOCtl 0XFD
 #define DisAutoSleep 0XFE
 
+// IrqCtl bits
+#define IRQ_EN_TEST 0x80
+#define IRQ_EN_TOUCH 0x40  // pulse periodically while touched
+#define IRQ_EN_CHANGE 0x20 // pulse when the touch state changes
+#define IRQ_EN_MOTION 0x10 // pulse when a gesture is recognized
+#define IRQ_ONCE_WLP 0x01  // a single pulse for a long press
+
 enum
 {
 	No_Gesture = 0x00,
@@ -62,9 +69,12 @@ public:
 	void _writeReg(uint8_t reg, uint8_t *data, uint8_t len);
 	uint8_t _readReg(uint8_t reg, uint8_t *data, uint8_t len);
 	bool ReadTouch(void);
-	void TouchInt(void);
+	void TouchInt(void); // refreshes the touch data after an INT pulse
 	uint8_t CheckID(void);
 	uint8_t getTouchType(void);
+	uint8_t getGesture(void);
+	uint8_t getFingerNum(void);
+	void setIrqMode(uint8_t mode);
 	uint16_t getX(void);
 	uint16_t getY(void);
 
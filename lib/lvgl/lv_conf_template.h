@@ -121,6 +121,16 @@
     * radius * 4 bytes are used per circle (the most often used radiuses are saved)
     * 0: to disable caching */
     #define LV_CIRCLE_CACHE_SIZE 4
+
+    /*Keep the anti-aliasing data of the circles in an LRU cache of this many bytes after each refresh
+     *instead of freeing the LV_CIRCLE_CACHE_SIZE entries. The masks look their circle up in it first and
+     *calculate it into the entries on a miss, as without it.
+     *0: to free the circles after each refresh*/
+    #define LV_CIRCLE_CACHE_LRU_SIZE 0
+
+    /*Draw skewed lines by computing the coverage of each pixel from its distance to the line
+     *instead of with line masks. Faster, most of all for thin lines*/
+    #define LV_DRAW_SW_LINE_ANALYTIC 0
 #endif /*LV_DRAW_COMPLEX*/
 
 /**
@@ -172,6 +182,16 @@
  *Only used if software rotation is enabled in the display driver.*/
 #define LV_DISP_ROT_MAX_BUF (10*1024)
 
+/*Cache the resolved value of each style property per object, part and state
+ *so that reading a property doesn't walk all the styles of the object every time.
+ *Costs about 20 bytes per object whose properties are read and about 470 more for each part/state
+ *combination it caches, up to LV_STYLE_CACHE_PARTS, with 4-byte pointers.*/
+#define LV_USE_STYLE_CACHE 0
+#if LV_USE_STYLE_CACHE
+    /*Number of part/state combinations cached per object*/
+    #define LV_STYLE_CACHE_PARTS 4
+#endif
+
 /*-------------
  * GPU
  *-----------*/
@@ -541,6 +561,10 @@
 #define LV_USE_MENU       1
 
 #define LV_USE_METER      1
+#if LV_USE_METER
+    /*Render the scales (ticks, labels and arcs) into an image and redraw only the needles from then on*/
+    #define LV_METER_SCALE_CACHE 0
+#endif
 
 #define LV_USE_MSGBOX     1
 
@@ -459,6 +459,10 @@ static void lv_obj_destructor(const lv_obj_class_t * class_p, lv_obj_t * obj)
         lv_mem_free(obj->spec_attr);
         obj->spec_attr = NULL;
     }
+
+#if LV_USE_STYLE_CACHE
+    _lv_obj_style_cache_free(obj);
+#endif
 }
 
 static void lv_obj_draw(lv_event_t * e)
@@ -27,6 +27,23 @@ typedef struct {
     lv_style_value_t end_value;
 } trans_t;
 
+#if LV_USE_STYLE_CACHE
+/*The resolved properties of one part in one state*/
+typedef struct {
+    lv_style_value_t values[_LV_STYLE_NUM_BUILT_IN_PROPS];
+    uint32_t valid[(_LV_STYLE_NUM_BUILT_IN_PROPS + 31) / 32];  /*Bit per property: set in `values`*/
+    uint32_t generation;    /*`_lv_style_generation` when the values were resolved*/
+    lv_state_t state;
+    uint8_t part;           /*The part shifted down to 8 bits*/
+} style_cache_slot_t;
+
+typedef struct _lv_obj_style_cache_t {
+    style_cache_slot_t * slots[LV_STYLE_CACHE_PARTS];   /*Allocated when first needed*/
+    uint8_t last;           /*The slot found the last time, checked first*/
+    uint8_t next_evict;
+} lv_obj_style_cache_t;
+#endif
+
 typedef enum {
     CACHE_ZERO = 0,
     CACHE_TRUE = 1,
@@ -54,15 +71,34 @@ static void trans_anim_ready_cb(lv_anim_t * a);
 static lv_layer_type_t calculate_layer_type(lv_obj_t * obj);
 static void fade_anim_cb(void * obj, int32_t v);
 static void fade_in_anim_ready(lv_anim_t * a);
+#if LV_USE_STYLE_CACHE
+    static style_cache_slot_t * style_cache_get_slot(lv_obj_t * obj, lv_part_t part);
+    static void style_cache_invalidate(lv_obj_t * obj);
+#endif
 
 /**********************
  *  STATIC VARIABLES
  **********************/
 static bool style_refr = true;
+#if LV_USE_STYLE_CACHE
+    static bool style_cache_en = true;
+    static lv_obj_style_cache_stats_t style_cache_stats;
+    static uint32_t style_cache_objects;
+    static uint32_t style_cache_slots;
+#endif
 
 /**********************
  *      MACROS
  **********************/
+#if LV_USE_STYLE_CACHE
+    /*A local or transition style is used only by its object whose cache is invalidated on refresh,
+     *so changing it shouldn't outdate the cache of all the other objects*/
+    #define OWN_STYLE_CHANGE_BEGIN() uint32_t style_gen_saved = _lv_style_generation
+    #define OWN_STYLE_CHANGE_END()   _lv_style_generation = style_gen_saved
+#else
+    #define OWN_STYLE_CHANGE_BEGIN()
+    #define OWN_STYLE_CHANGE_END()
+#endif
 
 /**********************
  *   GLOBAL FUNCTIONS
@@ -142,6 +178,9 @@ void lv_obj_remove_style(lv_obj_t * obj, lv_style_t * style, lv_style_selector_t
         obj->styles = lv_mem_realloc(obj->styles, obj->style_cnt * sizeof(_lv_obj_style_t));
 
         deleted = true;
+#if LV_USE_STYLE_CACHE
+        style_cache_invalidate(obj);
+#endif
         /*The style from the current `i` index is removed, so `i` points to the next style.
          *Therefore it doesn't needs to be incremented*/
     }
@@ -168,6 +207,11 @@ void lv_obj_refresh_style(lv_obj_t * obj, lv_style_selector_t selector, lv_style
 {
     LV_ASSERT_OBJ(obj, MY_CLASS);
 
+#if LV_USE_STYLE_CACHE
+    /*Only the values resolved from the object's own styles are cached, so its children needn't be invalidated*/
+    style_cache_invalidate(obj);
+#endif
+
     if(!style_refr) return;
 
     lv_obj_invalidate(obj);
@@ -222,6 +266,19 @@ void lv_obj_enable_style_refresh(bool en)
 
 lv_style_value_t lv_obj_get_style_prop(const lv_obj_t * obj, lv_part_t part, lv_style_prop_t prop)
 {
+#if LV_USE_STYLE_CACHE
+    /*`skip_trans` is set only temporarily to read the values without the transitions. Don't cache these.*/
+    style_cache_slot_t * slot = NULL;
+    if(style_cache_en && prop < _LV_STYLE_NUM_BUILT_IN_PROPS && !obj->skip_trans) {
+        slot = style_cache_get_slot((lv_obj_t *)obj, part);
+        if(slot && (slot->valid[prop >> 5] & (1UL << (prop & 0x1F)))) {
+            style_cache_stats.hits++;
+            return slot->values[prop];
+        }
+    }
+    const lv_obj_t * obj_ori = obj;
+#endif
+
     lv_style_value_t value_act;
     bool inheritable = lv_style_prop_has_flag(prop, LV_STYLE_PROP_INHERIT);
     lv_style_res_t found = LV_STYLE_RES_NOT_FOUND;
@@ -264,22 +321,78 @@ lv_style_value_t lv_obj_get_style_prop(const lv_obj_t * obj, lv_part_t part, lv_
             value_act = lv_style_prop_get_default(prop);
         }
     }
+
+#if LV_USE_STYLE_CACHE
+    /*Values inherited from a parent depend on the parent's styles and state too. Don't cache them.*/
+    if(slot && obj == obj_ori) {
+        slot->values[prop] = value_act;
+        slot->valid[prop >> 5] |= 1UL << (prop & 0x1F);
+        style_cache_stats.misses++;
+    }
+    else {
+        style_cache_stats.bypasses++;
+    }
+#endif
     return value_act;
 }
 
+#if LV_USE_STYLE_CACHE
+
+void lv_obj_enable_style_cache(bool en)
+{
+    /*The styles might have changed in the meantime without the objects being invalidated*/
+    if(en && !style_cache_en) _lv_style_generation++;
+    style_cache_en = en;
+}
+
+void lv_obj_get_style_cache_stats(lv_obj_style_cache_stats_t * stats)
+{
+    *stats = style_cache_stats;
+    stats->objects = style_cache_objects;
+    stats->slots = style_cache_slots;
+    stats->size = style_cache_objects * sizeof(lv_obj_style_cache_t) + style_cache_slots * sizeof(style_cache_slot_t);
+}
+
+void lv_obj_reset_style_cache_stats(void)
+{
+    lv_memset_00(&style_cache_stats, sizeof(style_cache_stats));
+}
+
+void _lv_obj_style_cache_free(lv_obj_t * obj)
+{
+    if(obj->style_cache == NULL) return;
+
+    uint32_t i;
+    for(i = 0; i < LV_STYLE_CACHE_PARTS; i++) {
+        if(obj->style_cache->slots[i]) {
+            lv_mem_free(obj->style_cache->slots[i]);
+            style_cache_slots--;
+        }
+    }
+    lv_mem_free(obj->style_cache);
+    obj->style_cache = NULL;
+    style_cache_objects--;
+}
+
+#endif
+
 void lv_obj_set_local_style_prop(lv_obj_t * obj, lv_style_prop_t prop, lv_style_value_t value,
                                  lv_style_selector_t selector)
 {
+    OWN_STYLE_CHANGE_BEGIN();
     lv_style_t * style = get_local_style(obj, selector);
     lv_style_set_prop(style, prop, value);
+    OWN_STYLE_CHANGE_END();
     lv_obj_refresh_style(obj, selector, prop);
 }
 
 void lv_obj_set_local_style_prop_meta(lv_obj_t * obj, lv_style_prop_t prop, uint16_t meta,
                                       lv_style_selector_t selector)
 {
+    OWN_STYLE_CHANGE_BEGIN();
     lv_style_t * style = get_local_style(obj, selector);
     lv_style_set_prop_meta(style, prop, meta);
+    OWN_STYLE_CHANGE_END();
     lv_obj_refresh_style(obj, selector, prop);
 }
 
@@ -314,7 +427,9 @@ bool lv_obj_remove_local_style_prop(lv_obj_t * obj, lv_style_prop_t prop, lv_sty
     /*The style is not found*/
     if(i == obj->style_cnt) return false;
 
+    OWN_STYLE_CHANGE_BEGIN();
     lv_res_t res = lv_style_remove_prop(obj->styles[i].style, prop);
+    OWN_STYLE_CHANGE_END();
     if(res == LV_RES_OK) {
         lv_obj_refresh_style(obj, selector, prop);
     }
@@ -774,7 +889,9 @@ static void trans_anim_cb(void * _tr, int32_t v)
                 refr = false;
             }
         }
+        OWN_STYLE_CHANGE_BEGIN();
         lv_style_set_prop(obj->styles[i].style, tr->prop, value_final);
+        OWN_STYLE_CHANGE_END();
         if(refr) lv_obj_refresh_style(tr->obj, tr->selector, tr->prop);
         break;
 
@@ -863,4 +980,83 @@ static void fade_in_anim_ready(lv_anim_t * a)
     lv_obj_remove_local_style_prop(a->var, LV_STYLE_OPA, 0);
 }
 
+#if LV_USE_STYLE_CACHE
+
+static inline void style_cache_slot_reset(style_cache_slot_t * slot, uint8_t part, lv_state_t state)
+{
+    lv_memset_00(slot->valid, sizeof(slot->valid));
+    slot->generation = _lv_style_generation;
+    slot->part = part;
+    slot->state = state;
+}
+
+/**
+ * Get the cache slot of a part in the current state of the object.
+ * If there is none, a new slot is allocated or the least recently added one is reused.
+ * @param obj   pointer to an object
+ * @param part  the part
+ * @return      the slot or NULL if out of memory
+ */
+static style_cache_slot_t * style_cache_get_slot(lv_obj_t * obj, lv_part_t part)
+{
+    lv_obj_style_cache_t * cache = obj->style_cache;
+    uint8_t part_id = (uint8_t)(part >> 16);
+    style_cache_slot_t * slot;
+
+    if(cache == NULL) {
+        cache = lv_mem_alloc(sizeof(lv_obj_style_cache_t));
+        LV_ASSERT_MALLOC(cache);
+        if(cache == NULL) return NULL;
+        lv_memset_00(cache, sizeof(lv_obj_style_cache_t));
+        obj->style_cache = cache;
+        style_cache_objects++;
+    }
+
+    slot = cache->slots[cache->last];
+    if(slot == NULL || slot->part != part_id || slot->state != obj->state) {
+        uint32_t i;
+        for(i = 0; i < LV_STYLE_CACHE_PARTS; i++) {
+            slot = cache->slots[i];
+            if(slot == NULL || (slot->part == part_id && slot->state == obj->state)) break;
+        }
+
+        if(i == LV_STYLE_CACHE_PARTS) {
+            /*All slots are used by other parts or states*/
+            i = cache->next_evict;
+            cache->next_evict = (cache->next_evict + 1) % LV_STYLE_CACHE_PARTS;
+            slot = cache->slots[i];
+            style_cache_slot_reset(slot, part_id, obj->state);
+            style_cache_stats.evictions++;
+        }
+        else if(slot == NULL) {
+            slot = lv_mem_alloc(sizeof(style_cache_slot_t));
+            LV_ASSERT_MALLOC(slot);
+            if(slot == NULL) return NULL;
+            style_cache_slot_reset(slot, part_id, obj->state);
+            cache->slots[i] = slot;
+            style_cache_slots++;
+        }
+        cache->last = i;
+    }
+
+    if(slot->generation != _lv_style_generation) {
+        style_cache_slot_reset(slot, part_id, obj->state);
+    }
+
+    return slot;
+}
+
+static void style_cache_invalidate(lv_obj_t * obj)
+{
+    lv_obj_style_cache_t * cache = obj->style_cache;
+    if(cache == NULL) return;
+
+    uint32_t i;
+    for(i = 0; i < LV_STYLE_CACHE_PARTS; i++) {
+        if(cache->slots[i]) lv_memset_00(cache->slots[i]->valid, sizeof(cache->slots[i]->valid));
+    }
+}
+
+#endif
+
 
@@ -43,6 +43,18 @@ typedef struct {
     uint32_t is_trans : 1;
 } _lv_obj_style_t;
 
+#if LV_USE_STYLE_CACHE
+typedef struct {
+    uint32_t hits;          /**< Properties read from the cache*/
+    uint32_t misses;        /**< Properties resolved from the styles and saved in the cache*/
+    uint32_t bypasses;      /**< Properties resolved from the styles without caching them*/
+    uint32_t evictions;     /**< Part/state slots reused for an other part or state*/
+    uint32_t objects;       /**< Objects with a cache now*/
+    uint32_t slots;         /**< Part/state slots allocated now*/
+    uint32_t size;          /**< Bytes used by the caches of the objects and their slots now*/
+} lv_obj_style_cache_stats_t;
+#endif
+
 typedef struct {
     uint16_t time;
     uint16_t delay;
@@ -130,6 +142,34 @@ void lv_obj_enable_style_refresh(bool en);
  */
 lv_style_value_t lv_obj_get_style_prop(const struct _lv_obj_t * obj, lv_part_t part, lv_style_prop_t prop);
 
+#if LV_USE_STYLE_CACHE
+
+/**
+ * Enable or disable the resolved style cache of the objects.
+ * When disabled `lv_obj_get_style_prop` searches the styles on every call.
+ * @param en        true: enable the cache; false: disable it
+ */
+void lv_obj_enable_style_cache(bool en);
+
+/**
+ * Get the hit/miss counters of the resolved style cache, summed up for all objects, and its current size
+ * @param stats     the counters will be copied here
+ */
+void lv_obj_get_style_cache_stats(lv_obj_style_cache_stats_t * stats);
+
+/**
+ * Zero the counters of the resolved style cache
+ */
+void lv_obj_reset_style_cache_stats(void);
+
+/**
+ * Free the resolved style cache of an object. Called by LVGL when the object is deleted.
+ * @param obj       pointer to an object
+ */
+void _lv_obj_style_cache_free(struct _lv_obj_t * obj);
+
+#endif
+
 /**
  * Set local style property on an object's part and state.
  * @param obj       pointer to an object
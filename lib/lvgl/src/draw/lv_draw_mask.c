@@ -18,6 +18,7 @@
  *********************/
 #define CIRCLE_CACHE_LIFE_MAX   1000
 #define CIRCLE_CACHE_AGING(life, r)   life = LV_MIN(life + (r < 16 ? 1 : (r >> 4)), 1000)
+#define CIRCLE_LRU_AVG_SIZE     128     /*Bytes of an average circle, to size the hash table of the LRU cache*/
 
 /**********************
  *      TYPEDEFS
@@ -56,6 +57,14 @@ static void circ_init(lv_point_t * c, lv_coord_t * tmp, lv_coord_t radius);
 static bool circ_cont(lv_point_t * c);
 static void circ_next(lv_point_t * c, lv_coord_t * tmp);
 static void circ_calc_aa4(_lv_draw_mask_radius_circle_dsc_t * c, lv_coord_t radius);
+static uint32_t circ_size(const _lv_draw_mask_radius_circle_dsc_t * c);
+static void circ_free(_lv_draw_mask_radius_circle_dsc_t * c);
+#if LV_CIRCLE_CACHE_LRU_SIZE
+static void circ_shrink(_lv_draw_mask_radius_circle_dsc_t * c);
+static _lv_draw_mask_radius_circle_dsc_t * circ_lru_get(lv_coord_t radius);
+static void circ_lru_add(const _lv_draw_mask_radius_circle_dsc_t * entry);
+static void circ_lru_free_cb(void * v);
+#endif
 static lv_opa_t * get_next_line(_lv_draw_mask_radius_circle_dsc_t * c, lv_coord_t y, lv_coord_t * len,
                                 lv_coord_t * x_start);
 LV_ATTRIBUTE_FAST_MEM static inline lv_opa_t mask_mix(lv_opa_t mask_act, lv_opa_t mask_new);
@@ -63,6 +72,11 @@ LV_ATTRIBUTE_FAST_MEM static inline lv_opa_t mask_mix(lv_opa_t mask_act, lv_opa_
 /**********************
  *  STATIC VARIABLES
  **********************/
+static lv_draw_mask_circle_cache_stats_t circle_stats;
+#if LV_CIRCLE_CACHE_LRU_SIZE
+static bool circle_lru_en = true;
+static uint32_t circle_lru_entries;
+#endif
 
 /**********************
  *      MACROS
@@ -213,13 +227,9 @@ void lv_draw_mask_free_param(void * p)
     if(pdsc->type == LV_DRAW_MASK_TYPE_RADIUS) {
         lv_draw_mask_radius_param_t * radius_p = (lv_draw_mask_radius_param_t *) p;
         if(radius_p->circle) {
-            if(radius_p->circle->life < 0) {
-                lv_mem_free(radius_p->circle->cir_opa);
-                lv_mem_free(radius_p->circle);
-            }
-            else {
-                radius_p->circle->used_cnt--;
-            }
+            /*Not in a cache (anymore): free it with its last mask*/
+            radius_p->circle->used_cnt--;
+            if(radius_p->circle->life < 0 && radius_p->circle->used_cnt == 0) circ_free(radius_p->circle);
         }
     }
     else if(pdsc->type == LV_DRAW_MASK_TYPE_POLYGON) {
@@ -233,12 +243,54 @@ void _lv_draw_mask_cleanup(void)
     uint8_t i;
     for(i = 0; i < LV_CIRCLE_CACHE_SIZE; i++) {
         if(LV_GC_ROOT(_lv_circle_cache[i]).buf) {
+#if LV_CIRCLE_CACHE_LRU_SIZE
+            /*Keep the circles of this refresh in the LRU cache for the next ones*/
+            if(circle_lru_en) circ_lru_add(&LV_GC_ROOT(_lv_circle_cache[i]));
+            else lv_mem_free(LV_GC_ROOT(_lv_circle_cache[i]).buf);
+#else
             lv_mem_free(LV_GC_ROOT(_lv_circle_cache[i]).buf);
+#endif
         }
         lv_memset_00(&LV_GC_ROOT(_lv_circle_cache[i]), sizeof(LV_GC_ROOT(_lv_circle_cache[i])));
     }
 }
 
+void lv_draw_mask_get_circle_cache_stats(lv_draw_mask_circle_cache_stats_t * stats)
+{
+    *stats = circle_stats;
+    uint8_t i;
+    for(i = 0; i < LV_CIRCLE_CACHE_SIZE; i++) {
+        if(LV_GC_ROOT(_lv_circle_cache[i]).buf) {
+            stats->entries++;
+            stats->size += circ_size(&LV_GC_ROOT(_lv_circle_cache[i]));
+        }
+    }
+
+#if LV_CIRCLE_CACHE_LRU_SIZE
+    lv_lru_t * lru = LV_GC_ROOT(_lv_circle_lru);
+    if(lru) {
+        stats->entries += circle_lru_entries;
+        stats->size += lru->total_memory - lru->free_memory;
+    }
+#endif
+}
+
+void lv_draw_mask_reset_circle_cache_stats(void)
+{
+    lv_memset_00(&circle_stats, sizeof(circle_stats));
+}
+
+#if LV_CIRCLE_CACHE_LRU_SIZE
+void lv_draw_mask_enable_circle_lru(bool en)
+{
+    if(!en && LV_GC_ROOT(_lv_circle_lru)) {
+        lv_lru_del(LV_GC_ROOT(_lv_circle_lru));
+        LV_GC_ROOT(_lv_circle_lru) = NULL;
+    }
+    circle_lru_en = en;
+}
+#endif
+
 /**
  * Count the currently added masks
  * @return number of active masks
@@ -490,11 +542,19 @@ void lv_draw_mask_radius_init(lv_draw_mask_radius_param_t * param, const lv_area
         return;
     }
 
+#if LV_CIRCLE_CACHE_LRU_SIZE
+    if(circle_lru_en) {
+        param->circle = circ_lru_get(radius);
+        if(param->circle) return;
+    }
+#endif
+
     uint32_t i;
 
     /*Try to reuse a circle cache entry*/
     for(i = 0; i < LV_CIRCLE_CACHE_SIZE; i++) {
         if(LV_GC_ROOT(_lv_circle_cache[i]).radius == radius) {
+            circle_stats.hits++;
             LV_GC_ROOT(_lv_circle_cache[i]).used_cnt++;
             CIRCLE_CACHE_AGING(LV_GC_ROOT(_lv_circle_cache[i]).life, radius);
             param->circle = &LV_GC_ROOT(_lv_circle_cache[i]);
@@ -503,6 +563,7 @@ void lv_draw_mask_radius_init(lv_draw_mask_radius_param_t * param, const lv_area
     }
 
     /*If not found find a free entry with lowest life*/
+    circle_stats.misses++;
     _lv_draw_mask_radius_circle_dsc_t * entry = NULL;
     for(i = 0; i < LV_CIRCLE_CACHE_SIZE; i++) {
         if(LV_GC_ROOT(_lv_circle_cache[i]).used_cnt == 0) {
@@ -516,8 +577,10 @@ void lv_draw_mask_radius_init(lv_draw_mask_radius_param_t * param, const lv_area
         LV_ASSERT_MALLOC(entry);
         lv_memset_00(entry, sizeof(_lv_draw_mask_radius_circle_dsc_t));
         entry->life = -1;
+        entry->used_cnt = 1;
     }
     else {
+        if(entry->buf) circle_stats.evictions++;
         entry->used_cnt++;
         entry->life = 0;
         CIRCLE_CACHE_AGING(entry->life, radius);
@@ -1369,11 +1432,12 @@ static void circ_calc_aa4(_lv_draw_mask_radius_circle_dsc_t * c, lv_coord_t radi
     /*Allocate buffers*/
     if(c->buf) lv_mem_free(c->buf);
 
-    c->buf = lv_mem_alloc(radius * 6 + 6);  /*Use uint16_t for opa_start_on_y and x_start_on_y*/
+    /*Use uint16_t for opa_start_on_y and x_start_on_y, then at most 2 * radius + 2 values in cir_opa*/
+    c->buf = lv_mem_alloc(radius * 6 + 6);
     LV_ASSERT_MALLOC(c->buf);
-    c->cir_opa = c->buf;
-    c->opa_start_on_y = (uint16_t *)(c->buf + 2 * radius + 2);
-    c->x_start_on_y = (uint16_t *)(c->buf + 4 * radius + 4);
+    c->opa_start_on_y = (uint16_t *)c->buf;
+    c->x_start_on_y = (uint16_t *)(c->buf + 2 * radius + 2);
+    c->cir_opa = c->buf + 4 * radius + 4;
 
     /*Special case, handle manually*/
     if(radius == 1) {
@@ -1509,6 +1573,104 @@ static void circ_calc_aa4(_lv_draw_mask_radius_circle_dsc_t * c, lv_coord_t radi
     lv_mem_buf_release(cir_x);
 }
 
+/**
+ * Get the bytes used by a circle
+ * @param c the calculated circle
+ * @return the size of the descriptor and the buffer
+ */
+static uint32_t circ_size(const _lv_draw_mask_radius_circle_dsc_t * c)
+{
+    return sizeof(_lv_draw_mask_radius_circle_dsc_t) + 4 * c->radius + 4 + c->opa_start_on_y[c->radius];
+}
+
+static void circ_free(_lv_draw_mask_radius_circle_dsc_t * c)
+{
+    lv_mem_free(c->buf);
+    lv_mem_free(c);
+}
+
+#if LV_CIRCLE_CACHE_LRU_SIZE
+/**
+ * Free the end of `cir_opa` not used by the rows of the circle.
+ * The last row, `y == radius`, is never read.
+ * @param c the calculated circle
+ */
+static void circ_shrink(_lv_draw_mask_radius_circle_dsc_t * c)
+{
+    uint8_t * buf = lv_mem_realloc(c->buf, circ_size(c) - sizeof(_lv_draw_mask_radius_circle_dsc_t));
+    if(buf == NULL) return;
+
+    c->buf = buf;
+    c->opa_start_on_y = (uint16_t *)buf;
+    c->x_start_on_y = (uint16_t *)(buf + 2 * c->radius + 2);
+    c->cir_opa = buf + 4 * c->radius + 4;
+}
+
+/**
+ * Look a circle up in the LRU cache
+ * @param radius the radius of the circle
+ * @return the circle, with `used_cnt` incremented, or NULL if it's not cached
+ */
+static _lv_draw_mask_radius_circle_dsc_t * circ_lru_get(lv_coord_t radius)
+{
+    lv_lru_t * lru = LV_GC_ROOT(_lv_circle_lru);
+    if(lru == NULL) return NULL;
+
+    _lv_draw_mask_radius_circle_dsc_t * entry = NULL;
+    lv_lru_get(lru, &radius, sizeof(radius), (void **)&entry);
+    if(entry) {
+        circle_stats.hits++;
+        entry->used_cnt++;
+    }
+    return entry;
+}
+
+/**
+ * Move the circle of a circle cache entry to the LRU cache. The masks miss the LRU cache into the entries,
+ * so a miss costs the same as without it and the LRU cache is updated at most `LV_CIRCLE_CACHE_SIZE` times a refresh.
+ * @param entry an unused entry, its buffer is taken or freed
+ */
+static void circ_lru_add(const _lv_draw_mask_radius_circle_dsc_t * entry)
+{
+    if(LV_GC_ROOT(_lv_circle_lru) == NULL) {
+        LV_GC_ROOT(_lv_circle_lru) = lv_lru_create(LV_CIRCLE_CACHE_LRU_SIZE, CIRCLE_LRU_AVG_SIZE, circ_lru_free_cb,
+                                                   NULL);
+    }
+    lv_lru_t * lru = LV_GC_ROOT(_lv_circle_lru);
+    _lv_draw_mask_radius_circle_dsc_t * c = lru ? lv_mem_alloc(sizeof(_lv_draw_mask_radius_circle_dsc_t)) : NULL;
+    if(c == NULL) {
+        lv_mem_free(entry->buf);
+        return;
+    }
+
+    lv_memcpy_small(c, entry, sizeof(_lv_draw_mask_radius_circle_dsc_t));
+    c->used_cnt = 0;
+    c->life = 0;
+    circ_shrink(c);
+
+    lv_coord_t radius = c->radius;
+    uint32_t entries = circle_lru_entries;
+    if(lv_lru_set(lru, &radius, sizeof(radius), c, circ_size(c)) != LV_LRU_OK) {
+        circ_free(c);
+        return;
+    }
+    circle_lru_entries++;
+    circle_stats.evictions += entries + 1 - circle_lru_entries;
+}
+
+/**
+ * Called by the LRU cache when it drops a circle. If masks still use it, the last one frees it.
+ * @param v the circle
+ */
+static void circ_lru_free_cb(void * v)
+{
+    _lv_draw_mask_radius_circle_dsc_t * entry = v;
+    circle_lru_entries--;
+    if(entry->used_cnt == 0) circ_free(entry);
+    else entry->life = -1;
+}
+#endif
+
 static lv_opa_t * get_next_line(_lv_draw_mask_radius_circle_dsc_t * c, lv_coord_t y, lv_coord_t * len,
                                 lv_coord_t * x_start)
 {
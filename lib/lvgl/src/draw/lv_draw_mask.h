@@ -165,6 +165,14 @@ typedef struct  {
 
 typedef _lv_draw_mask_radius_circle_dsc_t _lv_draw_mask_radius_circle_dsc_arr_t[LV_CIRCLE_CACHE_SIZE];
 
+typedef struct {
+    uint32_t hits;          /**< Radius masks that found their circle in the cache*/
+    uint32_t misses;        /**< Radius masks that calculated their circle*/
+    uint32_t evictions;     /**< Circles dropped from the cache to make room for an other one*/
+    uint32_t entries;       /**< Circles in the cache now*/
+    uint32_t size;          /**< Bytes used by the circles in the cache now*/
+} lv_draw_mask_circle_cache_stats_t;
+
 typedef struct {
     /*The first element must be the common descriptor*/
     _lv_draw_mask_common_dsc_t dsc;
@@ -293,6 +301,26 @@ void lv_draw_mask_free_param(void * p);
  */
 void _lv_draw_mask_cleanup(void);
 
+/**
+ * Get the hit/miss counters of the circle cache of the radius masks and its current size
+ * @param stats     the counters will be copied here
+ */
+void lv_draw_mask_get_circle_cache_stats(lv_draw_mask_circle_cache_stats_t * stats);
+
+/**
+ * Zero the hit/miss counters of the circle cache
+ */
+void lv_draw_mask_reset_circle_cache_stats(void);
+
+#if LV_CIRCLE_CACHE_LRU_SIZE
+/**
+ * Keep the circles of the `LV_CIRCLE_CACHE_SIZE` entries in the LRU cache after each refresh, or free them.
+ * Disabling it frees the cached circles. Don't call it while drawing.
+ * @param en        true: use the LRU cache (default); false: only the entries
+ */
+void lv_draw_mask_enable_circle_lru(bool en);
+#endif
+
 //! @cond Doxygen_Suppress
 
 /**
@@ -67,6 +67,15 @@ LV_ATTRIBUTE_FAST_MEM void lv_draw_sw_img_decoded(struct _lv_draw_ctx_t * draw_c
 LV_ATTRIBUTE_FAST_MEM void lv_draw_sw_line(struct _lv_draw_ctx_t * draw_ctx, const lv_draw_line_dsc_t * dsc,
                                            const lv_point_t * point1, const lv_point_t * point2);
 
+#if LV_DRAW_COMPLEX && LV_DRAW_SW_LINE_ANALYTIC
+/**
+ * Draw skewed lines from the distance of the pixels to the line (the default)
+ * or with line masks as without `LV_DRAW_SW_LINE_ANALYTIC`, e.g. to compare them.
+ * @param en    true: from the distances; false: with masks
+ */
+void lv_draw_sw_line_enable_analytic(bool en);
+#endif
+
 void lv_draw_sw_polygon(struct _lv_draw_ctx_t * draw_ctx, const lv_draw_rect_dsc_t * draw_dsc,
                         const lv_point_t * points, uint16_t point_cnt);
 
@@ -14,6 +14,8 @@
 /*********************
  *      DEFINES
  *********************/
+/*Longest line (plus width) drawn from the distances: they are 16.16 fixed point*/
+#define ANALYTIC_MAX_LEN 16384
 
 /**********************
  *      TYPEDEFS
@@ -29,10 +31,20 @@ LV_ATTRIBUTE_FAST_MEM static void draw_line_hor(struct _lv_draw_ctx_t * draw_ctx
                                                 const lv_point_t * point1, const lv_point_t * point2);
 LV_ATTRIBUTE_FAST_MEM static void draw_line_ver(struct _lv_draw_ctx_t * draw_ctx, const lv_draw_line_dsc_t * dsc,
                                                 const lv_point_t * point1, const lv_point_t * point2);
+#if LV_DRAW_COMPLEX && LV_DRAW_SW_LINE_ANALYTIC
+LV_ATTRIBUTE_FAST_MEM static bool draw_line_skew_analytic(struct _lv_draw_ctx_t * draw_ctx,
+                                                          const lv_draw_line_dsc_t * dsc,
+                                                          const lv_point_t * point1, const lv_point_t * point2);
+static void span_clip(int32_t * x1, int32_t * x2, int32_t x0, int32_t min, int32_t max, int32_t step);
+static uint32_t sqrt_u64(uint64_t x);
+#endif
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+#if LV_DRAW_COMPLEX && LV_DRAW_SW_LINE_ANALYTIC
+static bool analytic_en = true;
+#endif
 
 /**********************
  *      MACROS
@@ -104,6 +116,13 @@ LV_ATTRIBUTE_FAST_MEM void lv_draw_sw_line(struct _lv_draw_ctx_t * draw_ctx, con
     draw_ctx->clip_area = clip_area_ori;
 }
 
+#if LV_DRAW_COMPLEX && LV_DRAW_SW_LINE_ANALYTIC
+void lv_draw_sw_line_enable_analytic(bool en)
+{
+    analytic_en = en;
+}
+#endif
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -279,6 +298,10 @@ LV_ATTRIBUTE_FAST_MEM static void draw_line_skew(struct _lv_draw_ctx_t * draw_ct
                                                  const lv_point_t * point1, const lv_point_t * point2)
 {
 #if LV_DRAW_COMPLEX
+#if LV_DRAW_SW_LINE_ANALYTIC
+    if(analytic_en && draw_line_skew_analytic(draw_ctx, dsc, point1, point2)) return;
+#endif
+
     /*Keep the great y in p1*/
     lv_point_t p1;
     lv_point_t p2;
@@ -441,3 +464,126 @@ LV_ATTRIBUTE_FAST_MEM static void draw_line_skew(struct _lv_draw_ctx_t * draw_ct
 #endif /*LV_DRAW_COMPLEX*/
 }
 
+#if LV_DRAW_COMPLEX && LV_DRAW_SW_LINE_ANALYTIC
+/**
+ * Draw a skewed line without masks. Each pixel is covered by
+ * `width / 2 + 0.5 - |the distance of its center across the line|` and, unless `raw_end` is set,
+ * by `0.5 + the distance along the line to the nearer end`, both clamped to 0..1,
+ * so the edges fade over 1 pixel. The other masks (e.g. of a rounded parent) are applied too.
+ * @return false if the line is too long for the fixed point math
+ */
+LV_ATTRIBUTE_FAST_MEM static bool draw_line_skew_analytic(struct _lv_draw_ctx_t * draw_ctx,
+                                                          const lv_draw_line_dsc_t * dsc,
+                                                          const lv_point_t * point1, const lv_point_t * point2)
+{
+    int32_t dx = point2->x - point1->x;
+    int32_t dy = point2->y - point1->y;
+    int32_t w = dsc->width;
+    if(LV_ABS(dx) + w >= ANALYTIC_MAX_LEN || LV_ABS(dy) + w >= ANALYTIC_MAX_LEN) return false;
+
+    lv_area_t blend_area;
+    blend_area.x1 = LV_MIN(point1->x, point2->x) - w;
+    blend_area.x2 = LV_MAX(point1->x, point2->x) + w;
+    blend_area.y1 = LV_MIN(point1->y, point2->y) - w;
+    blend_area.y2 = LV_MAX(point1->y, point2->y) + w;
+    if(!_lv_area_intersect(&blend_area, &blend_area, draw_ctx->clip_area)) return true;
+
+    /*The unit vector along the line and the lengths in 1/65536 px*/
+    int32_t len = (int32_t)sqrt_u64((uint64_t)(dx * dx + dy * dy) << 32);
+    int32_t ux = (int32_t)(((int64_t)dx << 32) / len);
+    int32_t uy = (int32_t)(((int64_t)dy << 32) / len);
+    int32_t half_w = (w << 15) + 0x8000;
+
+    bool masked = lv_draw_mask_is_any(&blend_area);
+    lv_opa_t * mask_buf = lv_mem_buf_get(lv_area_get_width(&blend_area));
+
+    lv_area_t row_area;
+    lv_draw_sw_blend_dsc_t blend_dsc;
+    lv_memset_00(&blend_dsc, sizeof(blend_dsc));
+    blend_dsc.blend_area = &row_area;
+    blend_dsc.mask_area = &row_area;
+    blend_dsc.color = dsc->color;
+    blend_dsc.opa = dsc->opa;
+    blend_dsc.mask_buf = mask_buf;
+
+    int32_t y;
+    for(y = blend_area.y1; y <= blend_area.y2; y++) {
+        /*Only the pixels closer to the line than the fading edges*/
+        int32_t ry = y - point1->y;
+        int32_t across = ry * ux;
+        int32_t along = ry * uy;
+        int32_t x1 = blend_area.x1;
+        int32_t x2 = blend_area.x2;
+        span_clip(&x1, &x2, point1->x, across - half_w, across + half_w, uy);
+        if(!dsc->raw_end) span_clip(&x1, &x2, point1->x, -along - 0x8000, len - along + 0x8000, ux);
+        if(x1 > x2) continue;
+
+        int32_t rx = x1 - point1->x;
+        int32_t s = across - rx * uy;   /*Across the line*/
+        int32_t t = along + rx * ux;    /*Along the line from point1*/
+        int32_t cnt = x2 - x1 + 1;
+        int32_t i;
+        for(i = 0; i < cnt; i++) {
+            int32_t cov = half_w - LV_ABS(s);
+            cov = LV_CLAMP(0, cov, 0x10000);
+            if(!dsc->raw_end) {
+                int32_t cov_end = LV_MIN(t, len - t) + 0x8000;
+                cov_end = LV_CLAMP(0, cov_end, 0x10000);
+                cov = (cov >> 8) * (cov_end >> 8);
+            }
+            mask_buf[i] = (cov * LV_OPA_COVER + 0x8000) >> 16;
+            s -= uy;
+            t += ux;
+        }
+
+        row_area.x1 = x1;
+        row_area.x2 = x2;
+        row_area.y1 = y;
+        row_area.y2 = y;
+        if(masked && lv_draw_mask_apply(mask_buf, x1, y, cnt) == LV_DRAW_MASK_RES_TRANSP) continue;
+        blend_dsc.mask_res = LV_DRAW_MASK_RES_CHANGED;
+        lv_draw_sw_blend(draw_ctx, &blend_dsc);
+    }
+
+    lv_mem_buf_release(mask_buf);
+    return true;
+}
+
+/**
+ * Narrow `x1..x2` to where `min < (x - x0) * step < max`, give or take a pixel
+ */
+static void span_clip(int32_t * x1, int32_t * x2, int32_t x0, int32_t min, int32_t max, int32_t step)
+{
+    if(step == 0) {
+        if(min >= 0 || max <= 0) *x2 = *x1 - 1;
+        return;
+    }
+    int32_t q1 = min / step;
+    int32_t q2 = max / step;
+    *x1 = LV_MAX(*x1, x0 + LV_MIN(q1, q2) - 1);
+    *x2 = LV_MIN(*x2, x0 + LV_MAX(q1, q2) + 1);
+}
+
+/**
+ * The square root rounded down. `lv_sqrt` has only 4 fractional bits, too few for the ends of the lines.
+ */
+static uint32_t sqrt_u64(uint64_t x)
+{
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while(bit > x) bit >>= 2;
+
+    while(bit) {
+        if(x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+#endif /*LV_DRAW_COMPLEX && LV_DRAW_SW_LINE_ANALYTIC*/
+
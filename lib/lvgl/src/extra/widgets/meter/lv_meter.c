@@ -10,6 +10,8 @@
 #if LV_USE_METER != 0
 
 #include "../../../misc/lv_assert.h"
+#include "../../../misc/lv_gc.h"
+#include <string.h>
 
 /*********************
  *      DEFINES
@@ -19,6 +21,27 @@
 /**********************
  *      TYPEDEFS
  **********************/
+#if LV_METER_SCALE_CACHE
+/*The styles and size an image was drawn with. Not every style change is reported to the widget so they are compared on each draw*/
+typedef struct {
+    lv_draw_line_dsc_t line_dsc;
+    lv_draw_label_dsc_t label_dsc;
+    lv_area_t scale_area;           /*Relative to the image*/
+    lv_coord_t w;
+    lv_coord_t h;
+    lv_opa_t opa;
+    bool arc_rounded;
+} lv_meter_scale_key_t;
+
+typedef struct _lv_meter_scale_cache_t {
+    struct _lv_meter_scale_cache_t * next;  /*The next image in `_lv_meter_scale_caches`*/
+    uint32_t ref_cnt;                       /*The meters drawing this image*/
+    lv_img_dsc_t img;
+    lv_meter_scale_key_t key;
+    uint8_t * parts;                        /*The scales and the arc and scale lines indicators it was drawn with*/
+    uint32_t parts_size;
+} lv_meter_scale_cache_t;
+#endif
 
 /**********************
  *  STATIC PROTOTYPES
@@ -31,6 +54,14 @@ static void draw_ticks_and_labels(lv_obj_t * obj, lv_draw_ctx_t * draw_ctx, cons
 static void draw_needles(lv_obj_t * obj, lv_draw_ctx_t * draw_ctx, const lv_area_t * scale_area);
 static void inv_arc(lv_obj_t * obj, lv_meter_indicator_t * indic, int32_t old_value, int32_t new_value);
 static void inv_line(lv_obj_t * obj, lv_meter_indicator_t * indic, int32_t value);
+#if LV_METER_SCALE_CACHE
+static bool draw_scale_cache(lv_obj_t * obj, lv_draw_ctx_t * draw_ctx, const lv_area_t * scale_area);
+static bool scale_cache_update(lv_obj_t * obj, const lv_area_t * scale_area);
+static uint8_t * scale_cache_get_parts(lv_obj_t * obj, uint32_t * size);
+static lv_meter_scale_cache_t * scale_cache_find(const lv_meter_scale_key_t * key, const uint8_t * parts,
+                                                 uint32_t parts_size);
+static void scale_cache_release(lv_meter_t * meter);
+#endif
 
 /**********************
  *  STATIC VARIABLES
@@ -46,6 +77,11 @@ const lv_obj_class_t lv_meter_class = {
 /**********************
  *      MACROS
  **********************/
+#if LV_METER_SCALE_CACHE
+    #define SCALE_CACHE_INVALIDATE(obj) ((lv_meter_t *)(obj))->scale_cache_valid = 0
+#else
+    #define SCALE_CACHE_INVALIDATE(obj)
+#endif
 
 /**********************
  *   GLOBAL FUNCTIONS
@@ -81,6 +117,7 @@ lv_meter_scale_t * lv_meter_add_scale(lv_obj_t * obj)
     scale->tick_width = 2;
     scale->label_gap = 2;
 
+    SCALE_CACHE_INVALIDATE(obj);
     return scale;
 }
 
@@ -91,6 +128,7 @@ void lv_meter_set_scale_ticks(lv_obj_t * obj, lv_meter_scale_t * scale, uint16_t
     scale->tick_width = width;
     scale->tick_length = len;
     scale->tick_color = color;
+    SCALE_CACHE_INVALIDATE(obj);
     lv_obj_invalidate(obj);
 }
 
@@ -102,6 +140,7 @@ void lv_meter_set_scale_major_ticks(lv_obj_t * obj, lv_meter_scale_t * scale, ui
     scale->tick_major_length = len;
     scale->tick_major_color = color;
     scale->label_gap = label_gap;
+    SCALE_CACHE_INVALIDATE(obj);
     lv_obj_invalidate(obj);
 }
 
@@ -112,6 +151,7 @@ void lv_meter_set_scale_range(lv_obj_t * obj, lv_meter_scale_t * scale, int32_t
     scale->max = max;
     scale->angle_range = angle_range;
     scale->rotation = rotation;
+    SCALE_CACHE_INVALIDATE(obj);
     lv_obj_invalidate(obj);
 }
 
@@ -175,6 +215,7 @@ lv_meter_indicator_t * lv_meter_add_arc(lv_obj_t * obj, lv_meter_scale_t * scale
     indic->type_data.arc.color = color;
     indic->type_data.arc.r_mod = r_mod;
 
+    SCALE_CACHE_INVALIDATE(obj);
     lv_obj_invalidate(obj);
     return indic;
 }
@@ -196,6 +237,7 @@ lv_meter_indicator_t * lv_meter_add_scale_lines(lv_obj_t * obj, lv_meter_scale_t
     indic->type_data.scale_lines.local_grad = local;
     indic->type_data.scale_lines.width_mod = width_mod;
 
+    SCALE_CACHE_INVALIDATE(obj);
     lv_obj_invalidate(obj);
     return indic;
 }
@@ -212,6 +254,7 @@ void lv_meter_set_indicator_value(lv_obj_t * obj, lv_meter_indicator_t * indic,
     indic->end_value = value;
 
     if(indic->type == LV_METER_INDICATOR_TYPE_ARC) {
+        SCALE_CACHE_INVALIDATE(obj);
         inv_arc(obj, indic, old_start, value);
         inv_arc(obj, indic, old_end, value);
     }
@@ -221,6 +264,7 @@ void lv_meter_set_indicator_value(lv_obj_t * obj, lv_meter_indicator_t * indic,
         inv_line(obj, indic, value);
     }
     else {
+        SCALE_CACHE_INVALIDATE(obj);
         lv_obj_invalidate(obj);
     }
 }
@@ -231,6 +275,7 @@ void lv_meter_set_indicator_start_value(lv_obj_t * obj, lv_meter_indicator_t * i
     indic->start_value = value;
 
     if(indic->type == LV_METER_INDICATOR_TYPE_ARC) {
+        SCALE_CACHE_INVALIDATE(obj);
         inv_arc(obj, indic, old_value, value);
     }
     else if(indic->type == LV_METER_INDICATOR_TYPE_NEEDLE_IMG || indic->type == LV_METER_INDICATOR_TYPE_NEEDLE_LINE) {
@@ -238,6 +283,7 @@ void lv_meter_set_indicator_start_value(lv_obj_t * obj, lv_meter_indicator_t * i
         inv_line(obj, indic, value);
     }
     else {
+        SCALE_CACHE_INVALIDATE(obj);
         lv_obj_invalidate(obj);
     }
 }
@@ -248,6 +294,7 @@ void lv_meter_set_indicator_end_value(lv_obj_t * obj, lv_meter_indicator_t * ind
     indic->end_value = value;
 
     if(indic->type == LV_METER_INDICATOR_TYPE_ARC) {
+        SCALE_CACHE_INVALIDATE(obj);
         inv_arc(obj, indic, old_value, value);
     }
     else if(indic->type == LV_METER_INDICATOR_TYPE_NEEDLE_IMG || indic->type == LV_METER_INDICATOR_TYPE_NEEDLE_LINE) {
@@ -255,10 +302,26 @@ void lv_meter_set_indicator_end_value(lv_obj_t * obj, lv_meter_indicator_t * ind
         inv_line(obj, indic, value);
     }
     else {
+        SCALE_CACHE_INVALIDATE(obj);
         lv_obj_invalidate(obj);
     }
 }
 
+#if LV_METER_SCALE_CACHE
+
+void lv_meter_enable_scale_cache(lv_obj_t * obj, bool en)
+{
+    LV_ASSERT_OBJ(obj, MY_CLASS);
+    lv_meter_t * meter = (lv_meter_t *)obj;
+
+    meter->scale_cache_en = en;
+    if(!en) scale_cache_release(meter);
+    meter->scale_cache_valid = 0;
+    lv_obj_invalidate(obj);
+}
+
+#endif /*LV_METER_SCALE_CACHE*/
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -283,7 +346,9 @@ static void lv_meter_destructor(const lv_obj_class_t * class_p, lv_obj_t * obj)
     lv_meter_t * meter = (lv_meter_t *)obj;
     _lv_ll_clear(&meter->indicator_ll);
     _lv_ll_clear(&meter->scale_ll);
-
+#if LV_METER_SCALE_CACHE
+    scale_cache_release(meter);
+#endif
 }
 
 static void lv_meter_event(const lv_obj_class_t * class_p, lv_event_t * e)
@@ -300,8 +365,14 @@ static void lv_meter_event(const lv_obj_class_t * class_p, lv_event_t * e)
         lv_area_t scale_area;
         lv_obj_get_content_coords(obj, &scale_area);
 
-        draw_arcs(obj, draw_ctx, &scale_area);
-        draw_ticks_and_labels(obj, draw_ctx, &scale_area);
+#if LV_METER_SCALE_CACHE
+        lv_meter_t * meter = (lv_meter_t *)obj;
+        if(!meter->scale_cache_en || !draw_scale_cache(obj, draw_ctx, &scale_area))
+#endif
+        {
+            draw_arcs(obj, draw_ctx, &scale_area);
+            draw_ticks_and_labels(obj, draw_ctx, &scale_area);
+        }
         draw_needles(obj, draw_ctx, &scale_area);
 
         lv_coord_t r_edge = lv_area_get_width(&scale_area) / 2;
@@ -695,4 +766,241 @@ static void inv_line(lv_obj_t * obj, lv_meter_indicator_t * indic, int32_t value
         lv_obj_invalidate_area(obj, &a);
     }
 }
+
+#if LV_METER_SCALE_CACHE
+
+/**
+ * Draw the arcs, ticks and labels from the cached image
+ * @return false if the image couldn't be drawn for lack of memory
+ */
+static bool draw_scale_cache(lv_obj_t * obj, lv_draw_ctx_t * draw_ctx, const lv_area_t * scale_area)
+{
+    lv_meter_t * meter = (lv_meter_t *)obj;
+    if(!scale_cache_update(obj, scale_area)) return false;
+
+    lv_coord_t ext_size = _lv_obj_get_ext_draw_size(obj);
+    lv_area_t img_area;
+    lv_area_copy(&img_area, &obj->coords);
+    lv_area_increase(&img_area, ext_size, ext_size);
+
+    lv_draw_img_dsc_t img_dsc;
+    lv_draw_img_dsc_init(&img_dsc);
+    lv_draw_img(draw_ctx, &img_dsc, &img_area, &meter->scale_cache->img);
+    return true;
+}
+
+/**
+ * Make sure the meter has an image of its scales drawn with its current scales and styles.
+ * Meters drawn the same share one image. Otherwise it's drawn like `lv_snapshot` draws,
+ * on a display of its own, and relative to the meter so moving the meter keeps it valid.
+ * @return false if there's no memory for the image
+ */
+static bool scale_cache_update(lv_obj_t * obj, const lv_area_t * scale_area)
+{
+    lv_meter_t * meter = (lv_meter_t *)obj;
+
+    lv_coord_t ext_size = _lv_obj_get_ext_draw_size(obj);
+
+    /*Zeroed first so the padding compares equal too*/
+    lv_meter_scale_key_t key;
+    lv_memset_00(&key, sizeof(key));
+    lv_draw_line_dsc_init(&key.line_dsc);
+    lv_obj_init_draw_line_dsc(obj, LV_PART_TICKS, &key.line_dsc);
+    lv_draw_label_dsc_init(&key.label_dsc);
+    lv_obj_init_draw_label_dsc(obj, LV_PART_TICKS, &key.label_dsc);
+    lv_area_copy(&key.scale_area, scale_area);
+    lv_area_move(&key.scale_area, ext_size - obj->coords.x1, ext_size - obj->coords.y1);
+    key.w = lv_obj_get_width(obj) + ext_size * 2;
+    key.h = lv_obj_get_height(obj) + ext_size * 2;
+    key.opa = lv_obj_get_style_opa(obj, LV_PART_MAIN);
+    key.arc_rounded = lv_obj_get_style_arc_rounded(obj, LV_PART_ITEMS);
+
+    lv_meter_scale_cache_t * cache = meter->scale_cache;
+    if(meter->scale_cache_valid && memcmp(&cache->key, &key, sizeof(key)) == 0) return true;
+
+    /*Something changed: use the image of a meter drawn the same or draw one*/
+    uint32_t parts_size;
+    uint8_t * parts = scale_cache_get_parts(obj, &parts_size);
+    if(parts == NULL) return false;
+
+    lv_meter_scale_cache_t * shared = scale_cache_find(&key, parts, parts_size);
+    if(shared) {
+        lv_mem_free(parts);
+        if(shared != cache) {
+            scale_cache_release(meter);
+            shared->ref_cnt++;
+            meter->scale_cache = shared;
+        }
+        meter->scale_cache_valid = 1;
+        return true;
+    }
+
+    uint32_t size = (uint32_t)key.w * key.h * LV_IMG_PX_SIZE_ALPHA_BYTE;
+    if(cache && cache->ref_cnt == 1 && cache->img.data_size == size) {
+        /*Only this meter uses the image so draw the new one over it*/
+        lv_mem_free(cache->parts);
+    }
+    else {
+        scale_cache_release(meter);
+        cache = lv_mem_alloc(sizeof(lv_meter_scale_cache_t));
+        if(cache == NULL) {
+            lv_mem_free(parts);
+            return false;
+        }
+        cache->img.data = lv_mem_alloc(size);
+        if(cache->img.data == NULL) {
+            LV_LOG_WARN("no memory for the scales' image, drawing them directly");
+            lv_mem_free(parts);
+            lv_mem_free(cache);
+            return false;
+        }
+        cache->img.data_size = size;
+        cache->ref_cnt = 1;
+        cache->next = LV_GC_ROOT(_lv_meter_scale_caches);
+        LV_GC_ROOT(_lv_meter_scale_caches) = cache;
+        meter->scale_cache = cache;
+    }
+    cache->parts = parts;
+    cache->parts_size = parts_size;
+    lv_memcpy(&cache->key, &key, sizeof(key));
+
+    lv_disp_t * obj_disp = lv_obj_get_disp(obj);
+    lv_draw_ctx_t * draw_ctx = lv_mem_alloc(obj_disp->driver->draw_ctx_size);
+    if(draw_ctx == NULL) {
+        scale_cache_release(meter);
+        return false;
+    }
+
+    lv_memset_00((void *)cache->img.data, size);
+    cache->img.header.always_zero = 0;
+    cache->img.header.w = key.w;
+    cache->img.header.h = key.h;
+    cache->img.header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+
+    lv_disp_drv_t driver;
+    lv_disp_drv_init(&driver);
+    driver.hor_res = key.w;
+    driver.ver_res = key.h;
+    lv_disp_drv_use_generic_set_px_cb(&driver, LV_IMG_CF_TRUE_COLOR_ALPHA);
+
+    lv_disp_t fake_disp;
+    lv_memset_00(&fake_disp, sizeof(lv_disp_t));
+    fake_disp.driver = &driver;
+
+    lv_area_t img_area;
+    lv_area_set(&img_area, 0, 0, key.w - 1, key.h - 1);
+    obj_disp->driver->draw_ctx_init(fake_disp.driver, draw_ctx);
+    draw_ctx->clip_area = &img_area;
+    draw_ctx->buf_area = &img_area;
+    draw_ctx->buf = (void *)cache->img.data;
+    driver.draw_ctx = draw_ctx;
+
+    /*The masks of the area being refreshed (e.g. a rounded parent's) don't belong to the image*/
+    _lv_draw_mask_saved_t masks[_LV_MASK_MAX_NUM];
+    lv_memcpy(masks, LV_GC_ROOT(_lv_draw_mask_list), sizeof(masks));
+    lv_memset_00(LV_GC_ROOT(_lv_draw_mask_list), sizeof(masks));
+    lv_disp_t * refr_ori = _lv_refr_get_disp_refreshing();
+    _lv_refr_set_disp_refreshing(&fake_disp);
+
+    draw_arcs(obj, draw_ctx, &cache->key.scale_area);
+    draw_ticks_and_labels(obj, draw_ctx, &cache->key.scale_area);
+
+    _lv_refr_set_disp_refreshing(refr_ori);
+    lv_memcpy(LV_GC_ROOT(_lv_draw_mask_list), masks, sizeof(masks));
+    obj_disp->driver->draw_ctx_deinit(fake_disp.driver, draw_ctx);
+    lv_mem_free(draw_ctx);
+
+    lv_img_cache_invalidate_src(&cache->img);
+    meter->scale_cache_valid = 1;
+    return true;
+}
+
+/**
+ * Copy what the image is drawn from besides the styles: the scales and the arc and scale lines
+ * indicators, with their scale as an index. They are zeroed when added so they can be compared as memory.
+ * @param obj           pointer to a meter object
+ * @param size          store the size of the copy here
+ * @return              the copy, to free with `lv_mem_free`, or NULL if there's no memory
+ */
+static uint8_t * scale_cache_get_parts(lv_obj_t * obj, uint32_t * size)
+{
+    lv_meter_t * meter = (lv_meter_t *)obj;
+
+    uint32_t scale_cnt = _lv_ll_get_len(&meter->scale_ll);
+    uint32_t indic_cnt = 0;
+    lv_meter_indicator_t * indic;
+    _LV_LL_READ_BACK(&meter->indicator_ll, indic) {
+        if(indic->type == LV_METER_INDICATOR_TYPE_ARC || indic->type == LV_METER_INDICATOR_TYPE_SCALE_LINES) indic_cnt++;
+    }
+
+    *size = scale_cnt * sizeof(lv_meter_scale_t) + indic_cnt * sizeof(lv_meter_indicator_t);
+    uint8_t * parts = lv_mem_alloc(*size > 0 ? *size : 1);
+    if(parts == NULL) return NULL;
+
+    uint8_t * p = parts;
+    lv_meter_scale_t * scale;
+    _LV_LL_READ_BACK(&meter->scale_ll, scale) {
+        lv_memcpy(p, scale, sizeof(lv_meter_scale_t));
+        p += sizeof(lv_meter_scale_t);
+    }
+    _LV_LL_READ_BACK(&meter->indicator_ll, indic) {
+        if(indic->type != LV_METER_INDICATOR_TYPE_ARC && indic->type != LV_METER_INDICATOR_TYPE_SCALE_LINES) continue;
+
+        lv_meter_indicator_t * copy = (lv_meter_indicator_t *)p;
+        lv_memcpy(copy, indic, sizeof(lv_meter_indicator_t));
+        uintptr_t scale_id = 0;
+        _LV_LL_READ_BACK(&meter->scale_ll, scale) {
+            if(scale == indic->scale) break;
+            scale_id++;
+        }
+        copy->scale = (lv_meter_scale_t *)scale_id;
+        p += sizeof(lv_meter_indicator_t);
+    }
+    return parts;
+}
+
+/**
+ * Find the image drawn with the given styles, size, scales and indicators
+ * @return              the image or NULL if no meter is drawn so
+ */
+static lv_meter_scale_cache_t * scale_cache_find(const lv_meter_scale_key_t * key, const uint8_t * parts,
+                                                 uint32_t parts_size)
+{
+    lv_meter_scale_cache_t * cache;
+    for(cache = LV_GC_ROOT(_lv_meter_scale_caches); cache; cache = cache->next) {
+        if(cache->parts_size == parts_size && memcmp(&cache->key, key, sizeof(*key)) == 0 &&
+           memcmp(cache->parts, parts, parts_size) == 0) {
+            return cache;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Stop using the meter's image and free it if no other meter uses it
+ */
+static void scale_cache_release(lv_meter_t * meter)
+{
+    meter->scale_cache_valid = 0;
+    lv_meter_scale_cache_t * cache = meter->scale_cache;
+    if(cache == NULL) return;
+    meter->scale_cache = NULL;
+    if(--cache->ref_cnt > 0) return;
+
+    if(LV_GC_ROOT(_lv_meter_scale_caches) == cache) {
+        LV_GC_ROOT(_lv_meter_scale_caches) = cache->next;
+    }
+    else {
+        lv_meter_scale_cache_t * prev = LV_GC_ROOT(_lv_meter_scale_caches);
+        while(prev->next != cache) prev = prev->next;
+        prev->next = cache->next;
+    }
+
+    lv_img_cache_invalidate_src(&cache->img);
+    lv_mem_free((void *)cache->img.data);
+    lv_mem_free(cache->parts);
+    lv_mem_free(cache);
+}
+
+#endif /*LV_METER_SCALE_CACHE*/
 #endif
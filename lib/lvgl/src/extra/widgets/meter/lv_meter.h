@@ -95,6 +95,11 @@ typedef struct {
     lv_obj_t obj;
     lv_ll_t scale_ll;
     lv_ll_t indicator_ll;
+#if LV_METER_SCALE_CACHE
+    struct _lv_meter_scale_cache_t * scale_cache;   /*The image of the arcs, ticks and labels, found or drawn on the first draw*/
+    uint8_t scale_cache_en : 1;
+    uint8_t scale_cache_valid : 1;
+#endif
 } lv_meter_t;
 
 extern const lv_obj_class_t lv_meter_class;
@@ -254,6 +259,24 @@ void lv_meter_set_indicator_start_value(lv_obj_t * obj, lv_meter_indicator_t * i
  */
 void lv_meter_set_indicator_end_value(lv_obj_t * obj, lv_meter_indicator_t * indic, int32_t value);
 
+#if LV_METER_SCALE_CACHE
+
+/**
+ * Draw the arcs, ticks and labels of the scales into an image once and only draw that image
+ * until a scale, an arc or scale lines indicator, a style property they're drawn with or the size changes.
+ * The needles are drawn over it as usual, so moving them redraws a small area quickly.
+ * Takes an image as large as the meter (3 bytes per pixel at 16 bit color depth), shared by the meters
+ * with the same size, scales, arc and scale lines indicators and styles. So they should also change
+ * the same parts in their `LV_EVENT_DRAW_PART_BEGIN/END` events.
+ * `LV_METER_DRAW_PART_ARC` and `LV_METER_DRAW_PART_TICK` are sent only when the image is redrawn
+ * and their coordinates are relative to the image.
+ * @param obj           pointer to a meter object
+ * @param en            true: cache the scales; false: draw them every time
+ */
+void lv_meter_enable_scale_cache(lv_obj_t * obj, bool en);
+
+#endif /*LV_METER_SCALE_CACHE*/
+
 /**********************
  *      MACROS
  **********************/
@@ -313,6 +313,28 @@
             #define LV_CIRCLE_CACHE_SIZE 4
         #endif
     #endif
+
+    /*Keep the anti-aliasing data of the circles in an LRU cache of this many bytes after each refresh
+     *instead of freeing the LV_CIRCLE_CACHE_SIZE entries. The masks look their circle up in it first and
+     *calculate it into the entries on a miss, as without it.
+     *0: to free the circles after each refresh*/
+    #ifndef LV_CIRCLE_CACHE_LRU_SIZE
+        #ifdef CONFIG_LV_CIRCLE_CACHE_LRU_SIZE
+            #define LV_CIRCLE_CACHE_LRU_SIZE CONFIG_LV_CIRCLE_CACHE_LRU_SIZE
+        #else
+            #define LV_CIRCLE_CACHE_LRU_SIZE 0
+        #endif
+    #endif
+
+    /*Draw skewed lines by computing the coverage of each pixel from its distance to the line
+     *instead of with line masks. Faster, most of all for thin lines*/
+    #ifndef LV_DRAW_SW_LINE_ANALYTIC
+        #ifdef CONFIG_LV_DRAW_SW_LINE_ANALYTIC
+            #define LV_DRAW_SW_LINE_ANALYTIC CONFIG_LV_DRAW_SW_LINE_ANALYTIC
+        #else
+            #define LV_DRAW_SW_LINE_ANALYTIC 0
+        #endif
+    #endif
 #endif /*LV_DRAW_COMPLEX*/
 
 /**
@@ -412,6 +434,28 @@
     #endif
 #endif
 
+/*Cache the resolved value of each style property per object, part and state
+ *so that reading a property doesn't walk all the styles of the object every time.
+ *Costs about 20 bytes per object whose properties are read and about 470 more for each part/state
+ *combination it caches, up to LV_STYLE_CACHE_PARTS, with 4-byte pointers.*/
+#ifndef LV_USE_STYLE_CACHE
+    #ifdef CONFIG_LV_USE_STYLE_CACHE
+        #define LV_USE_STYLE_CACHE CONFIG_LV_USE_STYLE_CACHE
+    #else
+        #define LV_USE_STYLE_CACHE 0
+    #endif
+#endif
+#if LV_USE_STYLE_CACHE
+    /*Number of part/state combinations cached per object*/
+    #ifndef LV_STYLE_CACHE_PARTS
+        #ifdef CONFIG_LV_STYLE_CACHE_PARTS
+            #define LV_STYLE_CACHE_PARTS CONFIG_LV_STYLE_CACHE_PARTS
+        #else
+            #define LV_STYLE_CACHE_PARTS 4
+        #endif
+    #endif
+#endif
+
 /*-------------
  * GPU
  *-----------*/
@@ -1751,6 +1795,16 @@
         #define LV_USE_METER      1
     #endif
 #endif
+#if LV_USE_METER
+    /*Render the scales (ticks, labels and arcs) into an image and redraw only the needles from then on*/
+    #ifndef LV_METER_SCALE_CACHE
+        #ifdef CONFIG_LV_METER_SCALE_CACHE
+            #define LV_METER_SCALE_CACHE CONFIG_LV_METER_SCALE_CACHE
+        #else
+            #define LV_METER_SCALE_CACHE 0
+        #endif
+    #endif
+#endif
 
 #ifndef LV_USE_MSGBOX
     #ifdef _LV_KCONFIG_PRESENT
@@ -334,6 +334,12 @@ typedef struct {
     uint8_t prop_cnt;
 } lv_style_t;
 
+#if LV_USE_STYLE_CACHE
+/*Incremented whenever a property of any style is set or removed.
+ *Values resolved from the styles and saved with an older generation are outdated.*/
+extern uint32_t _lv_style_generation;
+#endif
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -23,6 +23,15 @@ extern "C" {
 void lv_test_assert_fail(void);
 #define LV_ASSERT_HANDLER lv_test_assert_fail();
 
+/*Run all the tests with the style cache, so the screenshots check it too*/
+#define LV_USE_STYLE_CACHE 1
+
+#define LV_METER_SCALE_CACHE 1
+
+#define LV_DRAW_SW_LINE_ANALYTIC 1
+
+#define LV_CIRCLE_CACHE_LRU_SIZE (8 * 1024)
+
 /**********************
  *      TYPEDEFS
  **********************/
@@ -7,9 +7,6 @@
 #include <stdlib.h>
 #include "../unity/unity.h"
 
-#define HOR_RES 800
-#define VER_RES 480
-
 static void hal_init(void);
 static void dummy_flush_cb(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p);
 
@@ -17,8 +14,9 @@ lv_indev_t * lv_test_mouse_indev;
 lv_indev_t * lv_test_keypad_indev;
 lv_indev_t * lv_test_encoder_indev;
 
-lv_color_t test_fb[HOR_RES * VER_RES];
-static lv_color_t disp_buf1[HOR_RES * VER_RES];
+lv_color_t test_fb[LV_TEST_HOR_RES * LV_TEST_VER_RES];
+static lv_color_t disp_buf1[LV_TEST_HOR_RES * LV_TEST_VER_RES];
+static void (*flush_area_cb)(const lv_area_t * area);
 
 void lv_test_init(void)
 {
@@ -31,18 +29,23 @@ void lv_test_deinit(void)
     lv_mem_deinit();
 }
 
+void lv_test_set_flush_area_cb(void (*cb)(const lv_area_t * area))
+{
+    flush_area_cb = cb;
+}
+
 static void hal_init(void)
 {
     static lv_disp_draw_buf_t draw_buf;
 
-    lv_disp_draw_buf_init(&draw_buf, disp_buf1, NULL, HOR_RES * VER_RES);
+    lv_disp_draw_buf_init(&draw_buf, disp_buf1, NULL, LV_TEST_HOR_RES * LV_TEST_VER_RES);
 
     static lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
     disp_drv.draw_buf = &draw_buf;
     disp_drv.flush_cb = dummy_flush_cb;
-    disp_drv.hor_res = HOR_RES;
-    disp_drv.ver_res = VER_RES;
+    disp_drv.hor_res = LV_TEST_HOR_RES;
+    disp_drv.ver_res = LV_TEST_VER_RES;
     lv_disp_drv_register(&disp_drv);
 
     static lv_indev_drv_t indev_mouse_drv;
@@ -66,10 +69,12 @@ static void hal_init(void)
 
 static void dummy_flush_cb(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t * color_p)
 {
-    LV_UNUSED(area);
-    LV_UNUSED(color_p);
-
-    memcpy(test_fb, color_p, lv_area_get_size(area) * sizeof(lv_color_t));
+    lv_coord_t w = lv_area_get_width(area);
+    lv_coord_t y;
+    for(y = area->y1; y <= area->y2; y++) {
+        memcpy(&test_fb[y * LV_TEST_HOR_RES + area->x1], &color_p[(y - area->y1) * w], w * sizeof(lv_color_t));
+    }
+    if(flush_area_cb) flush_area_cb(area);
 
     lv_disp_flush_ready(disp_drv);
 }
@@ -9,9 +9,18 @@ extern "C" {
 #include <stdio.h>
 #include <../lvgl.h>
 
+#define LV_TEST_HOR_RES 800
+#define LV_TEST_VER_RES 480
+
+/*The screen as flushed: every area is copied to its place*/
+extern lv_color_t test_fb[LV_TEST_HOR_RES * LV_TEST_VER_RES];
+
 void lv_test_init(void);
 void lv_test_deinit(void);
 
+/*Call `cb` with every area flushed, NULL to stop*/
+void lv_test_set_flush_area_cb(void (*cb)(const lv_area_t * area));
+
 #ifdef __cplusplus
 } /*extern "C"*/
 #endif
@@ -0,0 +1,229 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "../src/misc/lv_gc.h"
+
+#include "unity/unity.h"
+#include "lv_test_init.h"
+
+static lv_draw_mask_circle_cache_stats_t stats(void)
+{
+    lv_draw_mask_circle_cache_stats_t s;
+    lv_draw_mask_get_circle_cache_stats(&s);
+    return s;
+}
+
+/*Init and free a mask of a radius, just to use its circle*/
+static void touch(lv_coord_t radius)
+{
+    lv_draw_mask_radius_param_t p;
+    lv_area_t a;
+    lv_area_set(&a, 0, 0, 2 * radius, 2 * radius);
+    lv_draw_mask_radius_init(&p, &a, radius, false);
+    lv_draw_mask_free_param(&p);
+}
+
+void setUp(void)
+{
+    /*Start with empty caches*/
+    lv_draw_mask_enable_circle_lru(false);
+    _lv_draw_mask_cleanup();
+    lv_draw_mask_enable_circle_lru(true);
+    lv_draw_mask_reset_circle_cache_stats();
+}
+
+void tearDown(void)
+{
+    lv_draw_mask_enable_circle_lru(true);
+    lv_obj_clean(lv_scr_act());
+    lv_refr_now(NULL);
+}
+
+void test_circle_cache_shared(void)
+{
+    /*The inner and outer masks of a radius use the same circle*/
+    lv_draw_mask_radius_param_t inner;
+    lv_draw_mask_radius_param_t outer;
+    lv_area_t a;
+    lv_area_set(&a, 10, 10, 110, 60);
+    lv_draw_mask_radius_init(&inner, &a, 20, false);
+    lv_draw_mask_radius_init(&outer, &a, 20, true);
+    TEST_ASSERT_EQUAL_PTR(inner.circle, outer.circle);
+    TEST_ASSERT_EQUAL(1, stats().misses);
+    TEST_ASSERT_EQUAL(1, stats().hits);
+    TEST_ASSERT_EQUAL(1, stats().entries);
+    lv_draw_mask_free_param(&inner);
+    lv_draw_mask_free_param(&outer);
+
+    /*Kept when no mask uses it*/
+    touch(20);
+    TEST_ASSERT_EQUAL(2, stats().hits);
+
+    /*Moved to the LRU cache after the refresh*/
+    _lv_draw_mask_cleanup();
+    touch(20);
+    TEST_ASSERT_EQUAL(3, stats().hits);
+    TEST_ASSERT_EQUAL(1, stats().entries);
+}
+
+void test_circle_cache_miss_into_entries(void)
+{
+    /*A miss is calculated into the entries, the LRU cache isn't touched until the refresh is over*/
+    lv_draw_mask_radius_param_t p;
+    lv_area_t a;
+    lv_area_set(&a, 0, 0, 79, 79);
+    lv_draw_mask_radius_init(&p, &a, 40, false);
+    TEST_ASSERT_TRUE(p.circle >= &LV_GC_ROOT(_lv_circle_cache)[0]);
+    TEST_ASSERT_TRUE(p.circle < &LV_GC_ROOT(_lv_circle_cache)[LV_CIRCLE_CACHE_SIZE]);
+    TEST_ASSERT_NULL(LV_GC_ROOT(_lv_circle_lru));
+    lv_draw_mask_free_param(&p);
+
+    _lv_draw_mask_cleanup();
+    lv_draw_mask_radius_init(&p, &a, 40, false);
+    TEST_ASSERT_FALSE(p.circle >= &LV_GC_ROOT(_lv_circle_cache)[0] &&
+                      p.circle < &LV_GC_ROOT(_lv_circle_cache)[LV_CIRCLE_CACHE_SIZE]);
+    TEST_ASSERT_EQUAL(1, stats().hits);
+    lv_draw_mask_free_param(&p);
+}
+
+void test_circle_cache_kept_between_refreshes(void)
+{
+    touch(30);
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+    lv_draw_mask_reset_circle_cache_stats();
+    touch(30);
+    TEST_ASSERT_EQUAL(1, stats().hits);
+    TEST_ASSERT_EQUAL(0, stats().misses);
+
+    /*The LV_CIRCLE_CACHE_SIZE entries are freed after each refresh*/
+    lv_draw_mask_enable_circle_lru(false);
+    touch(30);
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+    lv_draw_mask_reset_circle_cache_stats();
+    touch(30);
+    TEST_ASSERT_EQUAL(0, stats().hits);
+    TEST_ASSERT_EQUAL(1, stats().misses);
+}
+
+void test_circle_cache_size_bound(void)
+{
+    lv_coord_t r;
+    for(r = 1; r <= 100; r++) {
+        touch(r);
+        touch(5);   /*Kept as the most recently used one*/
+        _lv_draw_mask_cleanup();
+        TEST_ASSERT_LESS_OR_EQUAL(LV_CIRCLE_CACHE_LRU_SIZE, stats().size);
+    }
+    TEST_ASSERT_GREATER_THAN(0, stats().evictions);
+    TEST_ASSERT_LESS_THAN(100, stats().entries);
+    TEST_ASSERT_EQUAL(100, stats().misses);
+
+    lv_draw_mask_reset_circle_cache_stats();
+    touch(5);
+    touch(100);
+    TEST_ASSERT_EQUAL(2, stats().hits);
+    touch(1);
+    TEST_ASSERT_EQUAL(1, stats().misses);
+}
+
+void test_circle_cache_compact(void)
+{
+    /*Smaller than the 6 * radius + 6 bytes of the buffer of an entry*/
+    touch(60);
+    _lv_draw_mask_cleanup();
+    TEST_ASSERT_LESS_THAN(sizeof(_lv_draw_mask_radius_circle_dsc_t) + 6 * 60 + 6, stats().size);
+}
+
+static void apply_row(lv_draw_mask_radius_param_t * p, lv_coord_t y, lv_opa_t * buf)
+{
+    int16_t id = lv_draw_mask_add(p, NULL);
+    lv_memset_ff(buf, 64);
+    lv_draw_mask_apply(buf, 0, y, 64);
+    lv_draw_mask_remove_id(id);
+}
+
+void test_circle_cache_evicted_in_use(void)
+{
+    /*A circle dropped from the cache stays with the mask using it*/
+    touch(50);
+    _lv_draw_mask_cleanup();
+    lv_draw_mask_radius_param_t held;
+    lv_area_t a;
+    lv_area_set(&a, 0, 0, 99, 99);
+    lv_draw_mask_radius_init(&held, &a, 50, false);
+    TEST_ASSERT_EQUAL(1, stats().hits);
+
+    lv_coord_t r;
+    for(r = 51; r <= 120; r++) {
+        touch(r);
+        _lv_draw_mask_cleanup();
+    }
+    TEST_ASSERT_GREATER_THAN(0, stats().evictions);
+    lv_draw_mask_reset_circle_cache_stats();
+    touch(50);
+    TEST_ASSERT_EQUAL(1, stats().misses);
+
+    lv_draw_mask_radius_param_t fresh;
+    lv_draw_mask_radius_init(&fresh, &a, 50, false);
+    TEST_ASSERT_NOT_EQUAL(held.circle, fresh.circle);
+
+    lv_opa_t buf_held[64];
+    lv_opa_t buf_fresh[64];
+    lv_coord_t y;
+    for(y = 0; y < 50; y += 7) {
+        apply_row(&held, y, buf_held);
+        apply_row(&fresh, y, buf_fresh);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(buf_fresh, buf_held, 64);
+    }
+
+    lv_draw_mask_free_param(&held);
+    lv_draw_mask_free_param(&fresh);
+}
+
+static void draw_scene(void)
+{
+    static const lv_coord_t radii[] = {3, 7, 12, 25, LV_RADIUS_CIRCLE};
+    uint32_t i;
+    for(i = 0; i < 20; i++) {
+        lv_obj_t * obj = lv_obj_create(lv_scr_act());
+        lv_obj_set_pos(obj, 10 + (i % 5) * 150, 10 + (i / 5) * 110);
+        lv_obj_set_size(obj, 60 + i * 3, 50 + i * 2);
+        lv_obj_set_style_radius(obj, radii[i % 5], 0);
+        lv_obj_set_style_shadow_width(obj, i % 3 ? 0 : 8, 0);
+    }
+    lv_obj_t * arc = lv_arc_create(lv_scr_act());
+    lv_obj_set_size(arc, 150, 150);
+    lv_obj_align(arc, LV_ALIGN_BOTTOM_RIGHT, -20, -20);
+    lv_arc_set_value(arc, 70);
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+}
+
+void test_circle_cache_same_pixels(void)
+{
+    static lv_color_t fb_entries[LV_TEST_HOR_RES * LV_TEST_VER_RES];
+
+    lv_draw_mask_enable_circle_lru(false);
+    draw_scene();
+    lv_memcpy(fb_entries, test_fb, sizeof(test_fb));
+    lv_obj_clean(lv_scr_act());
+
+    lv_draw_mask_enable_circle_lru(true);
+    draw_scene();
+    TEST_ASSERT_EQUAL_MEMORY(fb_entries, test_fb, sizeof(test_fb));
+
+    /*Each refresh moves at most LV_CIRCLE_CACHE_SIZE circles to the LRU cache, then all of them are there*/
+    uint32_t i;
+    for(i = 0; i < 20; i++) {
+        lv_draw_mask_reset_circle_cache_stats();
+        lv_obj_invalidate(lv_scr_act());
+        lv_refr_now(NULL);
+        TEST_ASSERT_EQUAL_MEMORY(fb_entries, test_fb, sizeof(test_fb));
+        if(stats().misses == 0) break;
+    }
+    TEST_ASSERT_EQUAL(0, stats().misses);
+    TEST_ASSERT_EQUAL(0, stats().evictions);
+}
+
+#endif
@@ -0,0 +1,202 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "../src/draw/sw/lv_draw_sw.h"
+
+#include "unity/unity.h"
+#include "lv_test_init.h"
+
+/*The fixed point math rounds a little differently, and the blending makes the least and most
+ *covered pixels transparent and opaque*/
+#define MAX_COVERAGE_DIFF 3
+
+static lv_obj_t * canvas;
+static lv_point_t p1;
+static lv_point_t p2;
+static lv_draw_line_dsc_t line_dsc;
+static bool circle_mask;
+
+/*Skewed in every direction, steep and flat. Not on an exact diagonal: the pixels of every row would sample
+ *the fading edges at the same offsets and the coverages wouldn't add up to the area.*/
+static const lv_point_t ends[][2] = {
+    {{100, 100}, {300, 160}},
+    {{300, 100}, {100, 130}},
+    {{100, 100}, {137, 400}},
+    {{220, 380}, {180, 90}},
+    {{400, 250}, {700, 251}},
+    {{500, 100}, {505, 420}},
+    {{600, 400}, {400, 207}},
+    {{123, 456}, {345, 321}},
+};
+
+static void draw_event_cb(lv_event_t * e)
+{
+    lv_draw_ctx_t * draw_ctx = lv_event_get_draw_ctx(e);
+    lv_draw_mask_radius_param_t mask;
+    int16_t mask_id = LV_MASK_ID_INV;
+    if(circle_mask) {
+        lv_area_t a;
+        lv_area_set(&a, 150, 150, 250, 250);
+        lv_draw_mask_radius_init(&mask, &a, LV_RADIUS_CIRCLE, false);
+        mask_id = lv_draw_mask_add(&mask, NULL);
+    }
+    lv_draw_line(draw_ctx, &line_dsc, &p1, &p2);
+    if(circle_mask) {
+        lv_draw_mask_free_param(&mask);
+        lv_draw_mask_remove_id(mask_id);
+    }
+}
+
+/*The tests aren't linked with libm*/
+static double sqrt_d(double v)
+{
+    double r = v > 1 ? v : 1;
+    uint32_t i;
+    for(i = 0; i < 64; i++) r = (r + v / r) / 2;
+    return r;
+}
+
+/*The coverage the line should have at a pixel, in double precision*/
+static int32_t ref_coverage(int32_t x, int32_t y)
+{
+    /*lv_draw_sw_line() clips the lines to this*/
+    int32_t w = line_dsc.width;
+    if(x < LV_MIN(p1.x, p2.x) - w / 2 || x > LV_MAX(p1.x, p2.x) + w / 2) return 0;
+    if(y < LV_MIN(p1.y, p2.y) - w / 2 || y > LV_MAX(p1.y, p2.y) + w / 2) return 0;
+
+    double dx = p2.x - p1.x;
+    double dy = p2.y - p1.y;
+    double len = sqrt_d(dx * dx + dy * dy);
+    double rx = x - p1.x;
+    double ry = y - p1.y;
+    double across = (ry * dx - rx * dy) / len;
+    double along = (rx * dx + ry * dy) / len;
+
+    double cov = LV_CLAMP(0.0, w / 2.0 + 0.5 - LV_ABS(across), 1.0);
+    if(!line_dsc.raw_end) cov *= LV_CLAMP(0.0, LV_MIN(along, len - along) + 0.5, 1.0);
+    return (int32_t)(cov * 255 + 0.5);
+}
+
+static int32_t coverage(int32_t x, int32_t y)
+{
+    return 255 - test_fb[y * LV_TEST_HOR_RES + x].ch.red;
+}
+
+/*Draw the line and check every pixel around it, return the sum of the coverages*/
+static int32_t draw_and_check(void)
+{
+    lv_obj_invalidate(canvas);
+    lv_refr_now(NULL);
+
+    int32_t w = line_dsc.width;
+    int32_t sum = 0;
+    int32_t x;
+    int32_t y;
+    for(y = LV_MIN(p1.y, p2.y) - w - 2; y <= LV_MAX(p1.y, p2.y) + w + 2; y++) {
+        for(x = LV_MIN(p1.x, p2.x) - w - 2; x <= LV_MAX(p1.x, p2.x) + w + 2; x++) {
+            int32_t ref = ref_coverage(x, y);
+            int32_t cov = coverage(x, y);
+            if(LV_ABS(ref - cov) > MAX_COVERAGE_DIFF) {
+                TEST_PRINTF("(%d;%d)-(%d;%d) width %d at (%d;%d)", p1.x, p1.y, p2.x, p2.y, w, x, y);
+            }
+            TEST_ASSERT_INT_WITHIN(MAX_COVERAGE_DIFF, ref, cov);
+            sum += cov;
+        }
+    }
+    return sum;
+}
+
+void setUp(void)
+{
+    lv_obj_set_style_bg_color(lv_scr_act(), lv_color_white(), 0);
+    canvas = lv_obj_create(lv_scr_act());
+    lv_obj_remove_style_all(canvas);
+    lv_obj_set_size(canvas, LV_TEST_HOR_RES, LV_TEST_VER_RES);
+    lv_obj_add_event_cb(canvas, draw_event_cb, LV_EVENT_DRAW_MAIN, NULL);
+
+    lv_draw_line_dsc_init(&line_dsc);
+    line_dsc.color = lv_color_black();
+    circle_mask = false;
+}
+
+void tearDown(void)
+{
+    lv_draw_sw_line_enable_analytic(true);
+    lv_obj_clean(lv_scr_act());
+    lv_obj_remove_local_style_prop(lv_scr_act(), LV_STYLE_BG_COLOR, 0);
+    lv_refr_now(NULL);
+}
+
+void test_draw_line_analytic_widths(void)
+{
+    uint32_t i;
+    for(i = 0; i < sizeof(ends) / sizeof(ends[0]); i++) {
+        p1 = ends[i][0];
+        p2 = ends[i][1];
+        double len = sqrt_d((double)(p2.x - p1.x) * (p2.x - p1.x) + (double)(p2.y - p1.y) * (p2.y - p1.y));
+        for(line_dsc.width = 1; line_dsc.width <= 8; line_dsc.width++) {
+            /*The coverages add up to the area of the line*/
+            int32_t area = (int32_t)(line_dsc.width * len * 255);
+            TEST_ASSERT_INT_WITHIN(area / 100 + 255, area, draw_and_check());
+        }
+    }
+}
+
+void test_draw_line_analytic_raw_end(void)
+{
+    line_dsc.raw_end = 1;
+    uint32_t i;
+    for(i = 0; i < sizeof(ends) / sizeof(ends[0]); i++) {
+        p1 = ends[i][0];
+        p2 = ends[i][1];
+        for(line_dsc.width = 1; line_dsc.width <= 8; line_dsc.width += 3) draw_and_check();
+    }
+}
+
+void test_draw_line_analytic_other_masks(void)
+{
+    /*Clipped to the circle like with the line masks*/
+    circle_mask = true;
+    p1 = ends[0][0];
+    p2 = ends[0][1];
+    line_dsc.width = 5;
+    lv_obj_invalidate(canvas);
+    lv_refr_now(NULL);
+
+    int32_t x;
+    int32_t y;
+    for(y = p1.y - 10; y <= p2.y + 10; y++) {
+        for(x = p1.x - 10; x <= p2.x + 10; x++) {
+            int32_t cx = x - 200;
+            int32_t cy = y - 200;
+            if(cx * cx + cy * cy > 52 * 52) TEST_ASSERT_EQUAL(0, coverage(x, y));
+            else if(cx * cx + cy * cy < 48 * 48) TEST_ASSERT_INT_WITHIN(MAX_COVERAGE_DIFF, ref_coverage(x, y), coverage(x, y));
+        }
+    }
+}
+
+void test_draw_line_analytic_like_masks(void)
+{
+    /*About as much ink as the line masks put down: they can be a pixel thinner or thicker*/
+    uint32_t i;
+    for(i = 0; i < sizeof(ends) / sizeof(ends[0]); i++) {
+        p1 = ends[i][0];
+        p2 = ends[i][1];
+        double len = sqrt_d((double)(p2.x - p1.x) * (p2.x - p1.x) + (double)(p2.y - p1.y) * (p2.y - p1.y));
+        line_dsc.width = 4;
+        int32_t analytic = draw_and_check();
+
+        lv_draw_sw_line_enable_analytic(false);
+        lv_obj_invalidate(canvas);
+        lv_refr_now(NULL);
+        int32_t masks = 0;
+        int32_t x;
+        int32_t y;
+        for(y = LV_MIN(p1.y, p2.y) - 10; y <= LV_MAX(p1.y, p2.y) + 10; y++) {
+            for(x = LV_MIN(p1.x, p2.x) - 10; x <= LV_MAX(p1.x, p2.x) + 10; x++) masks += coverage(x, y);
+        }
+        lv_draw_sw_line_enable_analytic(true);
+        TEST_ASSERT_INT_WITHIN((int32_t)(len * 255), masks, analytic);
+    }
+}
+
+#endif
@@ -0,0 +1,193 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+
+#include "unity/unity.h"
+#include "lv_test_init.h"
+
+/*Drawing the scales through an image blends their anti-aliased edges twice*/
+#define MAX_CHANNEL_DIFF 3
+
+static lv_color_t fb_direct[LV_TEST_HOR_RES * LV_TEST_VER_RES];
+static lv_obj_t * meter;
+static lv_meter_scale_t * scale;
+static lv_meter_indicator_t * needle;
+static lv_meter_indicator_t * arc;
+static uint32_t tick_events;
+
+static void draw_part_event_cb(lv_event_t * e)
+{
+    lv_obj_draw_part_dsc_t * dsc = lv_event_get_draw_part_dsc(e);
+    if(dsc->class_p == &lv_meter_class && dsc->type == LV_METER_DRAW_PART_TICK) tick_events++;
+}
+
+static void assert_same_as_direct(void)
+{
+    uint32_t i;
+    for(i = 0; i < LV_TEST_HOR_RES * LV_TEST_VER_RES; i++) {
+        TEST_ASSERT_INT_WITHIN(MAX_CHANNEL_DIFF, fb_direct[i].ch.red, test_fb[i].ch.red);
+        TEST_ASSERT_INT_WITHIN(MAX_CHANNEL_DIFF, fb_direct[i].ch.green, test_fb[i].ch.green);
+        TEST_ASSERT_INT_WITHIN(MAX_CHANNEL_DIFF, fb_direct[i].ch.blue, test_fb[i].ch.blue);
+    }
+}
+
+/*Render the screen without the cache into `fb_direct`, then with it into `test_fb`*/
+static void render_both(void)
+{
+    lv_meter_enable_scale_cache(meter, false);
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+    lv_memcpy(fb_direct, test_fb, sizeof(test_fb));
+
+    lv_meter_enable_scale_cache(meter, true);
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+}
+
+/*Sets `meter`, `scale`, `needle` and `arc`*/
+static void create_meter(lv_coord_t x, lv_coord_t y)
+{
+    meter = lv_meter_create(lv_scr_act());
+    lv_obj_set_size(meter, 240, 240);
+    lv_obj_set_pos(meter, x, y);
+    scale = lv_meter_add_scale(meter);
+    lv_meter_set_scale_ticks(meter, scale, 21, 2, 10, lv_palette_main(LV_PALETTE_GREY));
+    lv_meter_set_scale_major_ticks(meter, scale, 5, 4, 15, lv_color_black(), 10);
+    lv_meter_set_scale_range(meter, scale, -10, 10, 270, 135);
+    arc = lv_meter_add_arc(meter, scale, 6, lv_palette_main(LV_PALETTE_BLUE), 0);
+    lv_meter_set_indicator_start_value(meter, arc, 5);
+    lv_meter_set_indicator_end_value(meter, arc, 10);
+    needle = lv_meter_add_needle_line(meter, scale, 4, lv_palette_main(LV_PALETTE_RED), -10);
+    lv_obj_add_event_cb(meter, draw_part_event_cb, LV_EVENT_DRAW_PART_BEGIN, NULL);
+}
+
+void setUp(void)
+{
+    create_meter(31, 17);
+    tick_events = 0;
+}
+
+void tearDown(void)
+{
+    lv_obj_clean(lv_scr_act());
+    lv_refr_now(NULL);
+}
+
+void test_meter_cache_same_image(void)
+{
+    render_both();
+    assert_same_as_direct();
+}
+
+void test_meter_cache_needle_only(void)
+{
+    lv_meter_enable_scale_cache(meter, true);
+    lv_refr_now(NULL);
+    TEST_ASSERT_NOT_NULL(((lv_meter_t *)meter)->scale_cache);
+    TEST_ASSERT_EQUAL(21, tick_events);
+
+    /*Moving the needle draws the image, not the ticks*/
+    int32_t v;
+    for(v = -10; v <= 10; v += 3) {
+        lv_meter_set_indicator_value(meter, needle, v);
+        lv_refr_now(NULL);
+    }
+    TEST_ASSERT_EQUAL(21, tick_events);
+
+    /*Partly redrawn from the image the same as drawn all at once without it*/
+    static lv_color_t fb_partial[LV_TEST_HOR_RES * LV_TEST_VER_RES];
+    lv_memcpy(fb_partial, test_fb, sizeof(test_fb));
+    render_both();
+    lv_memcpy(test_fb, fb_partial, sizeof(test_fb));
+    assert_same_as_direct();
+}
+
+void test_meter_cache_scale_changed(void)
+{
+    lv_meter_enable_scale_cache(meter, true);
+    lv_refr_now(NULL);
+
+    /*A style the ticks are drawn with*/
+    lv_obj_set_style_text_color(meter, lv_palette_main(LV_PALETTE_ORANGE), LV_PART_TICKS);
+    tick_events = 0;
+    lv_refr_now(NULL);
+    TEST_ASSERT_EQUAL(21, tick_events);
+
+    lv_meter_set_scale_ticks(meter, scale, 11, 3, 12, lv_palette_main(LV_PALETTE_GREEN));
+    lv_meter_set_indicator_end_value(meter, arc, 8);
+    tick_events = 0;
+    lv_refr_now(NULL);
+    TEST_ASSERT_EQUAL(11, tick_events);
+
+    /*The same as drawn without the cache*/
+    render_both();
+    assert_same_as_direct();
+}
+
+void test_meter_cache_moved_and_resized(void)
+{
+    lv_meter_enable_scale_cache(meter, true);
+    lv_refr_now(NULL);
+
+    /*Moving keeps the image*/
+    lv_obj_set_pos(meter, 400, 200);
+    tick_events = 0;
+    lv_refr_now(NULL);
+    TEST_ASSERT_EQUAL(0, tick_events);
+
+    lv_obj_set_size(meter, 200, 200);
+    lv_refr_now(NULL);
+    TEST_ASSERT_EQUAL(21, tick_events);
+
+    render_both();
+    assert_same_as_direct();
+}
+
+void test_meter_cache_shared(void)
+{
+    lv_obj_t * first = meter;
+    create_meter(400, 200);
+    lv_meter_enable_scale_cache(first, true);
+    lv_meter_enable_scale_cache(meter, true);
+    lv_refr_now(NULL);
+
+    /*Drawn once for both*/
+    TEST_ASSERT_EQUAL(21, tick_events);
+    TEST_ASSERT_EQUAL_PTR(((lv_meter_t *)first)->scale_cache, ((lv_meter_t *)meter)->scale_cache);
+
+    /*Changing one of them draws an image of its own*/
+    lv_meter_set_indicator_end_value(meter, arc, 8);
+    lv_refr_now(NULL);
+    TEST_ASSERT_EQUAL(42, tick_events);
+    TEST_ASSERT_NOT_EQUAL(((lv_meter_t *)first)->scale_cache, ((lv_meter_t *)meter)->scale_cache);
+
+    /*Changing it back shares the first one's again*/
+    lv_meter_set_indicator_end_value(meter, arc, 10);
+    lv_refr_now(NULL);
+    TEST_ASSERT_EQUAL(42, tick_events);
+    TEST_ASSERT_EQUAL_PTR(((lv_meter_t *)first)->scale_cache, ((lv_meter_t *)meter)->scale_cache);
+
+    /*Kept for the other one when a meter is deleted*/
+    lv_obj_del(first);
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+    TEST_ASSERT_EQUAL(42, tick_events);
+    TEST_ASSERT_NOT_NULL(((lv_meter_t *)meter)->scale_cache);
+
+    render_both();
+    assert_same_as_direct();
+}
+
+void test_meter_cache_disable(void)
+{
+    lv_meter_enable_scale_cache(meter, true);
+    lv_refr_now(NULL);
+    lv_meter_enable_scale_cache(meter, false);
+    TEST_ASSERT_NULL(((lv_meter_t *)meter)->scale_cache);
+
+    tick_events = 0;
+    lv_meter_set_indicator_value(meter, needle, 3);
+    lv_refr_now(NULL);
+    TEST_ASSERT_GREATER_THAN(0, tick_events);
+}
+
+#endif
@@ -0,0 +1,165 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+
+#include "unity/unity.h"
+
+static lv_obj_style_cache_stats_t stats;
+
+static void read_stats(void)
+{
+    lv_obj_get_style_cache_stats(&stats);
+    lv_obj_reset_style_cache_stats();
+}
+
+void setUp(void)
+{
+    lv_obj_enable_style_cache(true);
+    lv_obj_reset_style_cache_stats();
+}
+
+void tearDown(void)
+{
+    lv_obj_clean(lv_scr_act());
+}
+
+void test_style_cache_hit(void)
+{
+    lv_obj_t * obj = lv_obj_create(lv_scr_act());
+    lv_obj_set_style_radius(obj, 7, 0);
+
+    lv_obj_reset_style_cache_stats();
+    TEST_ASSERT_EQUAL(7, lv_obj_get_style_radius(obj, LV_PART_MAIN));
+    TEST_ASSERT_EQUAL(7, lv_obj_get_style_radius(obj, LV_PART_MAIN));
+    TEST_ASSERT_EQUAL(7, lv_obj_get_style_radius(obj, LV_PART_MAIN));
+    read_stats();
+    TEST_ASSERT_EQUAL(1, stats.misses);
+    TEST_ASSERT_EQUAL(2, stats.hits);
+}
+
+void test_style_cache_local_style_change(void)
+{
+    lv_obj_t * obj = lv_obj_create(lv_scr_act());
+    lv_obj_t * other = lv_obj_create(lv_scr_act());
+    lv_obj_set_style_border_width(obj, 3, 0);
+    TEST_ASSERT_EQUAL(3, lv_obj_get_style_border_width(obj, LV_PART_MAIN));
+    lv_obj_get_style_border_width(other, LV_PART_MAIN);
+
+    lv_obj_set_style_border_width(obj, 5, 0);
+    TEST_ASSERT_EQUAL(5, lv_obj_get_style_border_width(obj, LV_PART_MAIN));
+    lv_obj_remove_local_style_prop(obj, LV_STYLE_BORDER_WIDTH, 0);
+    TEST_ASSERT_NOT_EQUAL(5, lv_obj_get_style_border_width(obj, LV_PART_MAIN));
+
+    /*A local style belongs to its object only. The other object's cache stays valid.*/
+    lv_obj_reset_style_cache_stats();
+    lv_obj_get_style_border_width(other, LV_PART_MAIN);
+    read_stats();
+    TEST_ASSERT_EQUAL(1, stats.hits);
+}
+
+void test_style_cache_shared_style_change(void)
+{
+    static lv_style_t style;
+    lv_style_init(&style);
+    lv_style_set_pad_left(&style, 10);
+
+    lv_obj_t * obj = lv_obj_create(lv_scr_act());
+    lv_obj_add_style(obj, &style, 0);
+    TEST_ASSERT_EQUAL(10, lv_obj_get_style_pad_left(obj, LV_PART_MAIN));
+
+    /*Changed without reporting it to the objects*/
+    lv_style_set_pad_left(&style, 12);
+    TEST_ASSERT_EQUAL(12, lv_obj_get_style_pad_left(obj, LV_PART_MAIN));
+
+    lv_style_set_pad_left(&style, 14);
+    lv_obj_report_style_change(&style);
+    TEST_ASSERT_EQUAL(14, lv_obj_get_style_pad_left(obj, LV_PART_MAIN));
+
+    lv_obj_remove_style(obj, &style, 0);
+    TEST_ASSERT_NOT_EQUAL(14, lv_obj_get_style_pad_left(obj, LV_PART_MAIN));
+    lv_style_reset(&style);
+}
+
+void test_style_cache_state_change(void)
+{
+    lv_obj_t * obj = lv_obj_create(lv_scr_act());
+    lv_obj_set_style_bg_opa(obj, 100, 0);
+    lv_obj_set_style_bg_opa(obj, 200, LV_STATE_PRESSED);
+    lv_obj_set_style_bg_opa(obj, 50, LV_STATE_PRESSED | LV_STATE_CHECKED);
+
+    TEST_ASSERT_EQUAL(100, lv_obj_get_style_bg_opa(obj, LV_PART_MAIN));
+    lv_obj_add_state(obj, LV_STATE_PRESSED);
+    TEST_ASSERT_EQUAL(200, lv_obj_get_style_bg_opa(obj, LV_PART_MAIN));
+    lv_obj_add_state(obj, LV_STATE_CHECKED);
+    TEST_ASSERT_EQUAL(50, lv_obj_get_style_bg_opa(obj, LV_PART_MAIN));
+    lv_obj_clear_state(obj, LV_STATE_PRESSED | LV_STATE_CHECKED);
+    TEST_ASSERT_EQUAL(100, lv_obj_get_style_bg_opa(obj, LV_PART_MAIN));
+
+    /*Each state has its own slot*/
+    lv_obj_reset_style_cache_stats();
+    lv_obj_add_state(obj, LV_STATE_PRESSED);
+    TEST_ASSERT_EQUAL(200, lv_obj_get_style_bg_opa(obj, LV_PART_MAIN));
+    read_stats();
+    TEST_ASSERT_EQUAL(0, stats.misses);
+}
+
+void test_style_cache_inherited(void)
+{
+    lv_obj_t * parent = lv_obj_create(lv_scr_act());
+    lv_obj_t * child = lv_obj_create(parent);
+    lv_obj_remove_style_all(child);
+    lv_obj_set_style_text_color(parent, lv_color_hex(0x112233), 0);
+    TEST_ASSERT_EQUAL_COLOR(lv_color_hex(0x112233), lv_obj_get_style_text_color(child, LV_PART_MAIN));
+
+    /*Follows the parent's state without touching the child*/
+    lv_obj_set_style_text_color(parent, lv_color_hex(0x445566), LV_STATE_FOCUSED);
+    lv_obj_add_state(parent, LV_STATE_FOCUSED);
+    TEST_ASSERT_EQUAL_COLOR(lv_color_hex(0x445566), lv_obj_get_style_text_color(child, LV_PART_MAIN));
+
+    /*Found in the main part of the same object: cached*/
+    lv_obj_set_style_text_color(child, lv_color_hex(0x778899), 0);
+    lv_obj_reset_style_cache_stats();
+    lv_obj_get_style_text_color(child, LV_PART_SCROLLBAR);
+    TEST_ASSERT_EQUAL_COLOR(lv_color_hex(0x778899), lv_obj_get_style_text_color(child, LV_PART_SCROLLBAR));
+    read_stats();
+    TEST_ASSERT_EQUAL(1, stats.hits);
+}
+
+void test_style_cache_more_parts_than_slots(void)
+{
+    static const lv_part_t parts[] = {LV_PART_MAIN, LV_PART_SCROLLBAR, LV_PART_INDICATOR, LV_PART_KNOB,
+                                      LV_PART_SELECTED, LV_PART_ITEMS, LV_PART_TICKS, LV_PART_CURSOR
+                                     };
+    lv_obj_t * obj = lv_obj_create(lv_scr_act());
+    uint32_t i;
+    for(i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+        lv_obj_set_style_width(obj, 10 + i, parts[i]);
+    }
+
+    uint32_t round;
+    for(round = 0; round < 3; round++) {
+        for(i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+            TEST_ASSERT_EQUAL(10 + i, lv_obj_get_style_width(obj, parts[i]));
+        }
+    }
+    read_stats();
+    TEST_ASSERT_GREATER_THAN(0, stats.evictions);
+}
+
+void test_style_cache_disabled(void)
+{
+    lv_obj_t * obj = lv_obj_create(lv_scr_act());
+    lv_obj_set_style_radius(obj, 4, 0);
+    lv_obj_get_style_radius(obj, LV_PART_MAIN);
+
+    lv_obj_enable_style_cache(false);
+    lv_obj_reset_style_cache_stats();
+    lv_obj_set_style_radius(obj, 6, 0);
+    TEST_ASSERT_EQUAL(6, lv_obj_get_style_radius(obj, LV_PART_MAIN));
+    read_stats();
+    TEST_ASSERT_EQUAL(0, stats.hits + stats.misses);
+
+    lv_obj_enable_style_cache(true);
+    TEST_ASSERT_EQUAL(6, lv_obj_get_style_radius(obj, LV_PART_MAIN));
+}
+
+#endif
@@ -0,0 +1,101 @@
+#pragma once
+
+// Host stand-in for the Arduino core, just enough for the app and the
+// vendored libraries to build and run in the simulator (see sim.h)
+
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+  uint32_t millis(void);
+  uint32_t micros(void);
+  void delay(uint32_t ms);
+  void yield(void);
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+#include <algorithm>
+#include "Stream.h"
+#include "esp_attr.h"
+#include "WString.h"
+
+using std::max;
+using std::min;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define digitalPinToInterrupt(pin) (pin)
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+// The handler runs on whichever thread raises the simulated edge
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+
+void *ps_malloc(size_t size);
+void *ps_realloc(void *ptr, size_t size);
+
+#define CONFIG_IDF_TARGET_ESP32 1 // the simulated chip
+
+typedef int gpio_num_t;
+typedef enum
+{
+  ESP_SLEEP_WAKEUP_UNDEFINED,
+  ESP_SLEEP_WAKEUP_EXT0 = 2
+} esp_sleep_wakeup_cause_t;
+
+typedef enum
+{
+  ESP_EXT1_WAKEUP_ALL_LOW,
+  ESP_EXT1_WAKEUP_ANY_HIGH
+} esp_sleep_ext1_wakeup_mode_t;
+
+bool esp_sleep_is_valid_wakeup_gpio(gpio_num_t pin);
+int esp_sleep_enable_ext0_wakeup(gpio_num_t pin, int level);
+int esp_sleep_enable_ext1_wakeup(uint64_t mask, esp_sleep_ext1_wakeup_mode_t mode);
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void); // EXT0 after --resume
+void esp_deep_sleep_start(void); // ends the simulation
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server);
+
+class HardwareSerial
+{
+public:
+  void begin(unsigned long baud) {}
+  void flush();
+  size_t print(const char *s);
+  size_t print(char c);
+  size_t print(const String &s) { return print(s.c_str()); }
+  size_t println(const char *s = "");
+  size_t println(const String &s) { return println(s.c_str()); }
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HardwareSerial Serial;
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+enum
+{
+  No_Gesture = 0x00,
+  Slide_Up,
+  Slide_Down,
+  Slide_Left,
+  Slide_Right,
+  Click_On,
+  Double_Click,
+  Press
+};
+
+#define IRQ_EN_TEST 0x80
+#define IRQ_EN_TOUCH 0x40
+#define IRQ_EN_CHANGE 0x20
+#define IRQ_EN_MOTION 0x10
+#define IRQ_ONCE_WLP 0x01
+
+// Reports the touch points and gestures scripted by the simulation (sim.h),
+// pulsing INT whenever they change, like the real controller
+class CST816S
+{
+public:
+  bool begin(TwoWire &port, uint8_t res, uint8_t irq);
+  bool ReadTouch(void);
+  void TouchInt(void) { ReadTouch(); }
+  uint8_t getTouchType(void) { return _pressed; }
+  uint8_t getGesture(void) { return _gesture; }
+  void setIrqMode(uint8_t mode) {}
+  uint16_t getX(void) { return _x; }
+  uint16_t getY(void) { return _y; }
+
+private:
+  bool _pressed = false;
+  uint8_t _gesture = No_Gesture;
+  uint16_t _x = 0;
+  uint16_t _y = 0;
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+// Only the status and error codes; PriceClient speaks HTTP/1.1 itself and
+// the mock ticker server answers on the socket (sim.cpp)
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_TOO_MANY_REQUESTS 429
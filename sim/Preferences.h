@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+// NVS stand-in, kept in memory for the lifetime of the process
+class Preferences
+{
+public:
+  bool begin(const char *name, bool readOnly = false);
+  void end() {}
+
+  uint32_t getUInt(const char *key, uint32_t defaultValue = 0) { return get(key, defaultValue); }
+  uint16_t getUShort(const char *key, uint16_t defaultValue = 0) { return get(key, defaultValue); }
+  size_t putUInt(const char *key, uint32_t value) { return put(key, value, 4); }
+  size_t putUShort(const char *key, uint16_t value) { return put(key, value, 2); }
+  size_t getBytesLength(const char *key);
+  size_t getBytes(const char *key, void *buf, size_t maxLen);
+  size_t putBytes(const char *key, const void *value, size_t len);
+
+private:
+  uint32_t get(const char *key, uint32_t defaultValue);
+  size_t put(const char *key, uint32_t value, size_t size);
+
+  std::string _name;
+  bool _readOnly = true;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+extern "C" uint32_t millis(void);
+extern "C" void delay(uint32_t ms);
+
+// Arduino's Stream without Print; read() returns -1 when nothing is left
+class Stream
+{
+public:
+  virtual ~Stream() {}
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+  // Waits up to the timeout for each byte, like the Arduino core
+  size_t readBytes(char *buffer, size_t length)
+  {
+    size_t n = 0;
+    int c;
+    while (n < length && (c = timedRead()) >= 0)
+      buffer[n++] = (char)c;
+    return n;
+  }
+
+protected:
+  int timedRead()
+  {
+    uint32_t start = millis();
+    for (;;)
+    {
+      int c = read();
+      if (c >= 0 || millis() - start >= _timeout)
+        return c;
+      delay(1);
+    }
+  }
+
+  unsigned long _timeout = 1000;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define TFT_BL 12
+
+// Renders into the simulator's in-memory framebuffer (sim.h). DMA transfers
+// complete immediately.
+class TFT_eSPI
+{
+public:
+  TFT_eSPI(int16_t width, int16_t height) : _width(width), _height(height) {}
+
+  void begin();
+  void setRotation(uint8_t rotation) {}
+  void setSwapBytes(bool swap) { _swapBytes = swap; }
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data);
+
+  bool initDMA(bool ctrlCs = false) { return true; }
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t const *data);
+  bool dmaBusy() { return false; }
+  void dmaWait() {}
+  void startWrite() {}
+  void endWrite() {}
+
+private:
+  void copy(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, bool swap);
+
+  int16_t _width;
+  int16_t _height;
+  bool _swapBytes = false;
+};
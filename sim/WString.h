@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <string>
+
+// The subset of Arduino's String the app uses, on top of std::string
+class String
+{
+public:
+  String() {}
+  String(const char *s) : _s(s != NULL ? s : "") {}
+  String(const std::string &s) : _s(s) {}
+  explicit String(char c) : _s(1, c) {}
+  explicit String(int n) : _s(std::to_string(n)) {}
+
+  const char *c_str() const { return _s.c_str(); }
+  unsigned int length() const { return _s.length(); }
+  bool isEmpty() const { return _s.empty(); }
+
+  String &operator+=(const String &s)
+  {
+    _s += s._s;
+    return *this;
+  }
+  String &operator+=(const char *s)
+  {
+    _s += s;
+    return *this;
+  }
+  String &operator+=(char c)
+  {
+    _s += c;
+    return *this;
+  }
+  friend String operator+(const String &a, const String &b) { return String(a._s + b._s); }
+  friend String operator+(const String &a, const char *b) { return String(a._s + b); }
+  friend String operator+(const char *a, const String &b) { return String(a + b._s); }
+  bool operator==(const char *s) const { return _s == s; }
+
+  int indexOf(char c, unsigned int from = 0) const { return find(_s.find(c, from)); }
+  int indexOf(const char *s, unsigned int from = 0) const { return find(_s.find(s, from)); }
+  String substring(unsigned int from) const { return from < _s.size() ? String(_s.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const
+  {
+    return from < to && from < _s.size() ? String(_s.substr(from, to - from)) : String();
+  }
+  bool startsWith(const char *prefix) const { return _s.compare(0, strlen(prefix), prefix) == 0; }
+  bool equalsIgnoreCase(const char *s) const { return strcasecmp(_s.c_str(), s) == 0; }
+  long toInt() const { return atol(_s.c_str()); }
+
+private:
+  static int find(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+
+  std::string _s;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define WIFI_STA 1
+
+typedef enum
+{
+  WL_IDLE_STATUS = 0,
+  WL_CONNECTED = 3,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+class IPAddress
+{
+public:
+  String toString() const { return "127.0.0.1"; }
+};
+
+// Associates after a delay: a full scan takes SIM_WIFI_SCAN_MS, a fast
+// connect to the right channel and BSSID SIM_WIFI_FAST_MS, and a fast connect
+// with stale parameters never succeeds.
+#define SIM_WIFI_SCAN_MS 1200
+#define SIM_WIFI_FAST_MS 150
+#define SIM_WIFI_CHANNEL 6
+
+class WiFiClass
+{
+public:
+  bool mode(int mode) { return true; }
+  wl_status_t begin(const char *ssid, const char *password, int32_t channel = 0,
+                    const uint8_t *bssid = NULL);
+  bool disconnect() { _begun = false; return true; }
+  wl_status_t status();
+  IPAddress localIP() const { return IPAddress(); }
+  String SSID() const { return _ssid; }
+  int32_t channel() const { return SIM_WIFI_CHANNEL; }
+  uint8_t *BSSID();
+
+private:
+  String _ssid;
+  bool _begun = false;
+  uint32_t _connectAt = 0; // millis(), 0 = never
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Arduino.h>
+#include <string>
+
+class SimPeer;
+
+// A "socket" whose receive side is filled by the simulated server: the mock
+// ticker server answers a request at once, a streaming peer (sim.h) adds
+// data as it becomes due whenever the client looks for some.
+class WiFiClientSecure : public Stream
+{
+public:
+  ~WiFiClientSecure();
+  void setInsecure() {}
+  int connect(const char *host, uint16_t port);
+  uint8_t connected() { return _connected || _pos < _rx.size(); } // data left is still readable
+  void stop();
+  size_t write(const uint8_t *data, size_t length);
+
+  int available()
+  {
+    pump();
+    return (int)(_rx.size() - _pos);
+  }
+  int read()
+  {
+    if (_pos >= _rx.size())
+      pump();
+    return _pos < _rx.size() ? (uint8_t)_rx[_pos++] : -1;
+  }
+  int peek() { return _pos < _rx.size() ? (uint8_t)_rx[_pos] : -1; }
+
+private:
+  void pump();
+
+  std::string _rx;
+  size_t _pos = 0;
+  bool _connected = false;
+  SimPeer *_peer = NULL;
+};
+
+typedef WiFiClientSecure WiFiClient;
@@ -0,0 +1,16 @@
+#pragma once
+
+// Used when there is no src/config.h; the simulated network ignores the
+// credentials, and the host only picks the stand-in that answers
+#include "../src/config_template.h"
+
+// Two sources, so failover and consensus can be tried
+// A level that the mock's first prices cross, so a short run shows an
+// alert; the move and the average need a few minutes of prices
+#ifndef PRICE_ALERTS
+#define PRICE_ALERTS "BTC>1,ETH%1/2,GMT^3"
+#endif
+
+#ifndef BITFINEX_HOST
+#define BITFINEX_HOST "https://api-pub.bitfinex.com"
+#endif
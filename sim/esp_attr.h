@@ -0,0 +1,6 @@
+#pragma once
+
+// RTC slow memory survives deep sleep. The simulator keeps such variables in
+// one section, so --resume can save and restore them across runs.
+#define RTC_DATA_ATTR __attribute__((section("sim_rtc")))
+#define IRAM_ATTR
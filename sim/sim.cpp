@@ -0,0 +1,716 @@
+#include "sim.h"
+
+#include <Arduino.h>
+#include <CST816S.h>
+#include <Preferences.h>
+#include <TFT_eSPI.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <Wire.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <math.h>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+SimOptions simOptions = {10000, 1000, 3000, 1, false, false, NULL, NULL, true, 20, 0, NULL, 0, NULL, 0, 0, 0};
+
+HardwareSerial Serial;
+TwoWire Wire;
+WiFiClass WiFi;
+
+// Arduino core
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+uint32_t millis(void)
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+uint32_t micros(void)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+static thread_local uint64_t sleptUs;
+
+void delay(uint32_t ms)
+{
+  uint32_t start = micros();
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  sleptUs += micros() - start;
+}
+
+uint64_t simSleptUs()
+{
+  return sleptUs;
+}
+
+void yield(void)
+{
+  std::this_thread::yield();
+}
+
+static uint8_t pinLevels[64];
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  if (pin < sizeof(pinLevels) && mode == INPUT_PULLUP)
+    pinLevels[pin] = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  if (pin < sizeof(pinLevels))
+    pinLevels[pin] = value;
+}
+
+int digitalRead(uint8_t pin)
+{
+  return pin < sizeof(pinLevels) ? pinLevels[pin] : LOW;
+}
+
+static void raiseInterrupt(uint8_t pin);
+
+void simSetPin(uint8_t pin, int level)
+{
+  bool changed = digitalRead(pin) != level;
+  digitalWrite(pin, level);
+  if (changed)
+    raiseInterrupt(pin);
+}
+
+static void (*interruptHandlers[64])(void);
+static void (*interruptArgHandlers[64])(void *);
+static void *interruptArgs[64];
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode)
+{
+  if (pin < 64)
+    interruptHandlers[pin] = handler;
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode)
+{
+  if (pin < 64)
+  {
+    interruptArgHandlers[pin] = handler;
+    interruptArgs[pin] = arg;
+  }
+}
+
+void detachInterrupt(uint8_t pin)
+{
+  if (pin < 64)
+  {
+    interruptHandlers[pin] = NULL;
+    interruptArgHandlers[pin] = NULL;
+  }
+}
+
+static void raiseInterrupt(uint8_t pin)
+{
+  if (pin >= 64)
+    return;
+  if (interruptHandlers[pin] != NULL)
+    interruptHandlers[pin]();
+  else if (interruptArgHandlers[pin] != NULL)
+    interruptArgHandlers[pin](interruptArgs[pin]);
+}
+
+long random(long howbig)
+{
+  return howbig > 0 ? ::random() % howbig : 0;
+}
+
+long random(long howsmall, long howbig)
+{
+  return howsmall < howbig ? howsmall + random(howbig - howsmall) : howsmall;
+}
+
+void *ps_malloc(size_t size)
+{
+  return malloc(size);
+}
+
+void *ps_realloc(void *ptr, size_t size)
+{
+  return realloc(ptr, size);
+}
+
+// The ESP32's RTC GPIOs
+bool esp_sleep_is_valid_wakeup_gpio(gpio_num_t pin)
+{
+  return pin == 0 || pin == 2 || pin == 4 || (pin >= 12 && pin <= 15) || pin == 25 || pin == 26 || pin == 27 ||
+         (pin >= 32 && pin <= 39);
+}
+
+int esp_sleep_enable_ext0_wakeup(gpio_num_t pin, int level)
+{
+  return 0;
+}
+
+int esp_sleep_enable_ext1_wakeup(uint64_t mask, esp_sleep_ext1_wakeup_mode_t mode)
+{
+  return 0;
+}
+
+// The linker's bounds of the RTC_DATA_ATTR section
+extern "C" char __start_sim_rtc[], __stop_sim_rtc[];
+static bool rtcRestored;
+
+bool simRtcLoad(const char *path)
+{
+  FILE *file = fopen(path, "rb");
+  if (file == NULL)
+    return false;
+  size_t size = __stop_sim_rtc - __start_sim_rtc;
+  std::vector<char> data(size + 1);
+  rtcRestored = fread(data.data(), 1, data.size(), file) == size; // a different build doesn't match
+  fclose(file);
+  if (rtcRestored)
+    memcpy(__start_sim_rtc, data.data(), size);
+  return rtcRestored;
+}
+
+bool simRtcSave(const char *path)
+{
+  FILE *file = fopen(path, "wb");
+  if (file == NULL)
+    return false;
+  size_t size = __stop_sim_rtc - __start_sim_rtc;
+  bool ok = fwrite(__start_sim_rtc, 1, size, file) == size;
+  fclose(file);
+  return ok;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void)
+{
+  return rtcRestored ? ESP_SLEEP_WAKEUP_EXT0 : ESP_SLEEP_WAKEUP_UNDEFINED;
+}
+
+void esp_deep_sleep_start(void)
+{
+  if (simOptions.resumePath != NULL)
+    simRtcSave(simOptions.resumePath);
+  simFinish("deep sleep");
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server)
+{
+}
+
+void HardwareSerial::flush()
+{
+  fflush(stdout);
+}
+
+size_t HardwareSerial::print(const char *s)
+{
+  return simOptions.verbose ? fputs(s, stdout), strlen(s) : 0;
+}
+
+size_t HardwareSerial::print(char c)
+{
+  return simOptions.verbose ? fputc(c, stdout) != EOF : 0;
+}
+
+size_t HardwareSerial::println(const char *s)
+{
+  return print(s) + print('\n');
+}
+
+// Like the core's Print::printf(): lines longer than its 64-byte buffer
+// go through the heap, so the allocation counts see them
+size_t HardwareSerial::printf(const char *format, ...)
+{
+  char line[64];
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if (n < 0)
+    return 0;
+  char *text = line;
+  if ((size_t)n >= sizeof(line))
+  {
+    text = (char *)malloc(n + 1);
+    va_start(args, format);
+    vsnprintf(text, n + 1, format, args);
+    va_end(args);
+  }
+  print(text);
+  if (text != line)
+    free(text);
+  return n;
+}
+
+// Network
+
+static uint8_t simBssid[6] = {0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56};
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *password, int32_t channel, const uint8_t *bssid)
+{
+  _ssid = ssid;
+  _begun = true;
+  if (channel == 0)
+    _connectAt = millis() + SIM_WIFI_SCAN_MS;
+  else if (channel == SIM_WIFI_CHANNEL && bssid != NULL && memcmp(bssid, simBssid, sizeof(simBssid)) == 0)
+    _connectAt = millis() + SIM_WIFI_FAST_MS;
+  else
+    _connectAt = 0;
+  return status();
+}
+
+wl_status_t WiFiClass::status()
+{
+  return _begun && _connectAt != 0 && millis() >= _connectAt ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+uint8_t *WiFiClass::BSSID()
+{
+  return simBssid;
+}
+
+WiFiClientSecure::~WiFiClientSecure()
+{
+  delete _peer;
+}
+
+int WiFiClientSecure::connect(const char *host, uint16_t port)
+{
+  SimHeapPause pause; // the socket and the server on its other end
+  stop();
+  bool refused = false;
+  _peer = simConnect(host, port, &refused);
+  _connected = !refused;
+  return _connected;
+}
+
+void WiFiClientSecure::stop()
+{
+  SimHeapPause pause; // the socket and the server on its other end
+  delete _peer;
+  _peer = NULL;
+  _connected = false;
+  _rx.clear();
+  _pos = 0;
+}
+
+size_t WiFiClientSecure::write(const uint8_t *data, size_t length)
+{
+  SimHeapPause pause; // the socket and the server on its other end
+  if (!_connected)
+    return 0;
+  if (_peer != NULL)
+    _peer->onWrite(data, length);
+  return length;
+}
+
+void WiFiClientSecure::pump()
+{
+  SimHeapPause pause; // the socket and the server on its other end
+  if (_peer == NULL || !_connected)
+    return;
+  if (_pos > 0 && _pos == _rx.size())
+  {
+    _rx.clear();
+    _pos = 0;
+  }
+  if (!_peer->poll(_rx))
+    _connected = false;
+}
+
+static std::atomic<size_t> warmAllocations(0);
+
+// The mock ticker servers' end of a connection. The Binance stand-in has
+// Binance-style limits: a used-weight header on every answer, 429 with
+// Retry-After over the limit; it also takes the injected failures and
+// latency, so the app has a reason to fail over to the Bitfinex one.
+class TickerPeer : public SimPeer
+{
+public:
+  explicit TickerPeer(bool bitfinex) : _bitfinex(bitfinex) {}
+
+  void onWrite(const uint8_t *data, size_t length)
+  {
+    simHeapWatchThread(); // the fetch task
+    _request.append((const char *)data, length);
+    size_t end;
+    while ((end = _request.find("\r\n\r\n")) != std::string::npos)
+    {
+      answer(_request.substr(0, end));
+      _request.erase(0, end + 4);
+    }
+  }
+
+  bool poll(std::string &rx)
+  {
+    if ((int32_t)(millis() - _readyAt) < 0)
+      return true; // still "on the way"
+    rx += _reply;
+    _reply.clear();
+    return true;
+  }
+
+private:
+  void answer(const std::string &request)
+  {
+    static uint32_t requests, minute, inMinute;
+    if (request.compare(0, 4, "GET ") != 0)
+    {
+      _reply += "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n";
+      return;
+    }
+    std::string path = request.substr(4, request.find(' ', 4) - 4);
+    if (_bitfinex)
+    {
+      reply("", simBitfinexResponse(path.c_str()));
+      return;
+    }
+
+    if (++requests == 2)
+      warmAllocations = simHeapWatchedAllocations(); // the first request set up what is kept
+    _readyAt = millis() + simOptions.slowMs;
+    if (millis() / 60000 != minute)
+    {
+      minute = millis() / 60000;
+      inMinute = 0;
+    }
+    inMinute++;
+    std::string weight = "X-MBX-USED-WEIGHT-1M: " + std::to_string(inMinute * 2) + "\r\n";
+    if (simOptions.rateLimit != 0 && inMinute > simOptions.rateLimit)
+    {
+      _reply += "HTTP/1.1 429 Too Many Requests\r\n" + weight + "Retry-After: " +
+                std::to_string(60 - millis() / 1000 % 60) + "\r\nContent-Length: 0\r\n\r\n";
+      return;
+    }
+    if (simOptions.failEvery != 0 && requests % simOptions.failEvery == 0)
+    {
+      _reply += "HTTP/1.1 503 Service Unavailable\r\n" + weight + "Content-Length: 0\r\n\r\n";
+      return;
+    }
+    reply(weight, simTickerResponse(path.c_str()));
+  }
+
+  void reply(const std::string &headers, const std::string &body)
+  {
+    _reply += "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n" + headers;
+    if (!simOptions.chunked)
+    {
+      _reply += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+      return;
+    }
+
+    // A few uneven chunks, so a chunk boundary falls inside tokens
+    _reply += "Transfer-Encoding: chunked\r\n\r\n";
+    size_t pos = 0;
+    for (size_t len = 7; pos < body.size(); len = len * 3 + 1)
+    {
+      size_t n = std::min(len, body.size() - pos);
+      char header[16];
+      snprintf(header, sizeof(header), "%zx\r\n", n);
+      _reply += header;
+      _reply.append(body, pos, n);
+      _reply += "\r\n";
+      pos += n;
+    }
+    _reply += "0\r\n\r\n";
+  }
+
+  bool _bitfinex;
+  std::string _request;
+  std::string _reply;
+  uint32_t _readyAt = 0;
+};
+
+size_t simWarmAllocations()
+{
+  return warmAllocations;
+}
+
+SimPeer *simTickerPeer(const char *host)
+{
+  return new TickerPeer(strstr(host, "bitfinex") != NULL);
+}
+
+// Mock ticker server: every symbol does a seeded random walk, so runs with
+// the same options see the same prices
+
+#define SIM_BITFINEX_SPREAD 0.0004 // its quotes sit this far above the Binance stand-in's
+
+static uint32_t nextRandom(uint32_t &state)
+{
+  state = state * 1664525u + 1013904223u;
+  return state >> 8;
+}
+
+double simTickPrice(double price)
+{
+  int decimals = 2;
+  for (double limit = 1000; price < limit && decimals < 8; limit /= 10)
+    decimals++;
+  double scale = pow(10, decimals);
+  return round(price * scale) / scale;
+}
+
+// The coin's next price on its walk; open is where the step started
+static double mockPrice(const std::string &coin, double *open)
+{
+  static std::map<std::string, double> prices;
+  static std::map<std::string, uint32_t> pricedAt;
+  static uint32_t random = simOptions.seed;
+
+  // Each symbol has its own volatility, up to +-2% per minute
+  double &price = prices[coin];
+  if (price == 0)
+    price = 0.5 + nextRandom(random) % 6000000 / 100.0;
+  uint32_t hash = 0;
+  for (size_t i = 0; i < coin.size(); i++)
+    hash = hash * 31 + coin[i];
+  double volatility = 0.001 * (1 + hash % 20);
+  double minutes = (millis() - pricedAt[coin]) / 60000.0;
+  pricedAt[coin] = millis();
+  *open = price;
+  price *= 1.0 + volatility * sqrt(minutes) * ((int)(nextRandom(random) % 2001) - 1000) / 1000.0;
+  price = simTickPrice(price);
+  return price;
+}
+
+std::string simTickerResponse(const char *url)
+{
+  if (simOptions.payloadPath != NULL)
+  {
+    std::ifstream file(simOptions.payloadPath, std::ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+  }
+
+  static uint32_t random = simOptions.seed;
+  const char *list = strstr(url, "symbols=");
+  std::string symbols = list != NULL ? list + 8 : "";
+
+  std::string body = "[";
+  size_t start = 0;
+  while (start < symbols.size())
+  {
+    size_t end = symbols.find(',', start);
+    if (end == std::string::npos)
+      end = symbols.size();
+    std::string symbol = symbols.substr(start, end - start);
+    start = end + 1;
+
+    double open;
+    double price = mockPrice(symbol, &open);
+    double change = (price - open) / open * 100.0;
+
+    char item[320];
+    snprintf(item, sizeof(item),
+             "%s{\"symbol\":\"%sUSDT\",\"priceChange\":\"%.8f\",\"priceChangePercent\":\"%.3f\","
+             "\"weightedAvgPrice\":\"%.8f\",\"lastPrice\":\"%.8f\",\"lastQty\":\"0.01000000\","
+             "\"openPrice\":\"%.8f\",\"volume\":\"12345.67800000\",\"count\":%u}",
+             body.size() > 1 ? "," : "", symbol.c_str(), price - open, change,
+             (price + open) / 2, price, open, nextRandom(random) % 100000);
+    body += item;
+  }
+  body += "]";
+  return body;
+}
+
+// A JSON number as Bitfinex sends it: no trailing zeros
+static std::string bareNumber(double value, int decimals)
+{
+  char text[40];
+  snprintf(text, sizeof(text), "%.*f", decimals, value);
+  std::string number = text;
+  if (number.find('.') != std::string::npos)
+  {
+    number.erase(number.find_last_not_of('0') + 1);
+    if (number.back() == '.')
+      number.pop_back();
+  }
+  return number;
+}
+
+// The same walk a few bp off, so consensus has something to settle
+std::string simBitfinexResponse(const char *url)
+{
+  const char *list = strstr(url, "symbols=");
+  std::string symbols = list != NULL ? list + 8 : "";
+
+  std::string body = "[";
+  size_t start = 0;
+  while (start < symbols.size())
+  {
+    size_t end = symbols.find(',', start);
+    if (end == std::string::npos)
+      end = symbols.size();
+    std::string symbol = symbols.substr(start, end - start); // tBTCUSD, tDOGE:USD
+    start = end + 1;
+    std::string coin = symbol.substr(1, symbol.size() - 4);
+    if (!coin.empty() && coin.back() == ':')
+      coin.pop_back();
+
+    double open;
+    double price = simTickPrice(mockPrice(coin, &open) * (1.0 + SIM_BITFINEX_SPREAD));
+    std::string last = bareNumber(price, 8);
+    body += body.size() > 1 ? ",[\"" : "[\"";
+    body += symbol + "\"," + last + ",1.5," + last + ",2.25," + bareNumber(price - open, 8) + "," +
+            bareNumber((price - open) / open, 6) + "," + last + ",1234.5," + last + "," + last + "]";
+  }
+  body += "]";
+  return body;
+}
+
+// Touch, set by the script thread and read by the app
+
+static std::mutex touchMutex;
+static bool touchPressed;
+static uint16_t touchX, touchY;
+static uint8_t touchGesture;
+static uint8_t touchIntPin = 0xFF;
+
+void simSetTouch(bool pressed, uint16_t x, uint16_t y, uint8_t gesture)
+{
+  bool changed;
+  {
+    std::lock_guard<std::mutex> lock(touchMutex);
+    changed = pressed != touchPressed || x != touchX || y != touchY || gesture != No_Gesture;
+    if (pressed && !touchPressed)
+      touchGesture = No_Gesture;
+    if (gesture != No_Gesture)
+      touchGesture = gesture;
+    touchPressed = pressed;
+    touchX = x;
+    touchY = y;
+  }
+  if (changed)
+    raiseInterrupt(touchIntPin);
+}
+
+bool simTouch(uint16_t *x, uint16_t *y, uint8_t *gesture)
+{
+  std::lock_guard<std::mutex> lock(touchMutex);
+  *x = touchX;
+  *y = touchY;
+  if (gesture != NULL)
+    *gesture = touchGesture;
+  return touchPressed;
+}
+
+bool CST816S::begin(TwoWire &port, uint8_t res, uint8_t irq)
+{
+  touchIntPin = irq;
+  return true;
+}
+
+bool CST816S::ReadTouch(void)
+{
+  _pressed = simTouch(&_x, &_y, &_gesture);
+  return _pressed;
+}
+
+// Display
+
+static std::vector<uint16_t> framebuffer;
+static int framebufferWidth, framebufferHeight;
+
+void simFramebufferInit(int width, int height)
+{
+  framebufferWidth = width;
+  framebufferHeight = height;
+  framebuffer.assign((size_t)width * height, 0);
+}
+
+const uint16_t *simFramebuffer(int *width, int *height)
+{
+  *width = framebufferWidth;
+  *height = framebufferHeight;
+  return framebuffer.data();
+}
+
+void TFT_eSPI::begin()
+{
+  simFramebufferInit(_width, _height);
+}
+
+void TFT_eSPI::copy(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, bool swap)
+{
+  for (int32_t row = 0; row < h; row++)
+  {
+    if (y + row < 0 || y + row >= _height)
+      continue;
+    for (int32_t col = 0; col < w; col++)
+    {
+      if (x + col < 0 || x + col >= _width)
+        continue;
+      uint16_t c = data[row * w + col];
+      framebuffer[(size_t)(y + row) * _width + x + col] = swap ? (uint16_t)(c << 8 | c >> 8) : c;
+    }
+  }
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data)
+{
+  copy(x, y, w, h, data, false); // the framebuffer holds native RGB565
+}
+
+void TFT_eSPI::pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t const *data)
+{
+  copy(x, y, w, h, data, true); // LVGL renders byte swapped for DMA
+}
+
+// NVS
+
+static std::map<std::string, uint32_t> preferences;
+static std::map<std::string, std::string> preferenceBlobs;
+
+bool Preferences::begin(const char *name, bool readOnly)
+{
+  _name = name;
+  _readOnly = readOnly;
+  return true;
+}
+
+uint32_t Preferences::get(const char *key, uint32_t defaultValue)
+{
+  std::map<std::string, uint32_t>::const_iterator it = preferences.find(_name + "/" + key);
+  return it != preferences.end() ? it->second : defaultValue;
+}
+
+size_t Preferences::put(const char *key, uint32_t value, size_t size)
+{
+  if (_readOnly)
+    return 0;
+  preferences[_name + "/" + key] = value;
+  return size;
+}
+
+size_t Preferences::getBytesLength(const char *key)
+{
+  std::map<std::string, std::string>::const_iterator it = preferenceBlobs.find(_name + "/" + key);
+  return it != preferenceBlobs.end() ? it->second.size() : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen)
+{
+  std::map<std::string, std::string>::const_iterator it = preferenceBlobs.find(_name + "/" + key);
+  if (it == preferenceBlobs.end() || it->second.size() > maxLen)
+    return 0; // as NVS: the buffer must hold the whole blob
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len)
+{
+  if (_readOnly)
+    return 0;
+  preferenceBlobs[_name + "/" + key].assign((const char *)value, len);
+  return len;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// Host simulator of the crypto meter. main.ino runs unchanged against the
+// stand-ins in this directory: LVGL renders into an in-memory framebuffer,
+// HTTP requests are answered by a mock ticker server or a recorded payload,
+// and touches come from a script. Time is the host's real time.
+
+struct SimOptions
+{
+  uint32_t durationMs;     // stop after this long
+  uint32_t refreshMs;      // ask for new prices this often, 0 = app default
+  uint32_t swipeMs;        // swipe to the next tile this often, 0 = never
+  uint32_t seed;           // random walk of the mock ticker
+  bool chunked;            // send the ticker body with chunked encoding
+  bool verbose;            // pass the app's Serial output through
+  const char *payloadPath; // recorded response to serve instead of the mock
+  const char *dumpPath;    // write the last frame there as a PPM image
+  bool stream;             // accept connections to the WebSocket feed
+  uint32_t streamRate;     // messages per second sent by the stream stand-in
+  uint32_t streamDropMs;   // drop every stream after this long, 0 = never
+  const char *framesPath;  // recorded stream messages to replay, one per line
+  uint32_t sleepMs;        // enter deep sleep after this long, 0 = never
+  const char *resumePath;  // RTC memory: restored at start, saved at deep sleep
+  uint32_t pressMs;        // press the first button this often, 0 = never
+  uint32_t rateLimit;      // ticker requests per minute before 429s, 0 = unlimited
+  uint32_t failEvery;      // every Nth ticker request fails with a 503, 0 = never
+  bool expectNoAllocs;     // fail if the fetch task allocates after its first request
+  uint32_t slowMs;         // the Binance stand-in answers this late
+  bool consensus;          // ask every price source each time
+  bool benchParse;         // run simBenchParse() instead of the app
+  bool benchPrices;        // run simBenchPrices() instead of the app
+  bool benchAlerts;        // run simBenchAlerts() instead of the app
+  bool benchStyles;        // run simBenchStyles() instead of the app
+  bool benchMeter;         // run simBenchMeter() instead of the app
+  bool benchLines;         // run simBenchLines() instead of the app
+  bool benchCircles;       // run simBenchCircles() instead of the app
+};
+
+extern SimOptions simOptions;
+
+// Framebuffer the TFT stand-in draws into, RGB565
+const uint16_t *simFramebuffer(int *width, int *height);
+void simFramebufferInit(int width, int height);
+
+uint64_t simSleptUs(); // time the calling thread spent in delay()
+
+// RTC_DATA_ATTR variables (esp_attr.h); false if there was nothing to restore
+bool simRtcLoad(const char *path);
+bool simRtcSave(const char *path);
+
+// Changes pulse the touch controller's INT pin; a gesture is reported with
+// the next change, e.g. Slide_Left with the release ending a swipe
+void simSetTouch(bool pressed, uint16_t x, uint16_t y, uint8_t gesture = 0);
+bool simTouch(uint16_t *x, uint16_t *y, uint8_t *gesture = NULL);
+void simSetPin(uint8_t pin, int level); // e.g. a pressed button reads LOW
+
+// Body the mock server sends for a ticker request, and the Bitfinex stand-in
+std::string simTickerResponse(const char *url);
+std::string simBitfinexResponse(const char *url);
+// Rounds a mock price to a tick of about five significant digits, like the
+// exchange's, which still sends it with 8 decimals
+double simTickPrice(double price);
+
+// Server end of a simulated socket that sends on its own schedule
+class SimPeer
+{
+public:
+  virtual ~SimPeer() {}
+  virtual void onWrite(const uint8_t *data, size_t length) = 0;
+  virtual bool poll(std::string &rx) = 0; // appends what is due; false once it closed
+};
+
+// The WebSocket stand-in (sim_stream.cpp) if host is the stream server,
+// otherwise a mock ticker server. refused is set while the stream is disabled.
+SimPeer *simConnect(const char *host, uint16_t port, bool *refused);
+SimPeer *simTickerPeer(const char *host); // sim.cpp; Bitfinex's format if host is theirs
+
+struct SimStreamStats
+{
+  uint32_t connections;
+  uint32_t messages; // text messages sent
+  uint32_t fragmented;
+  uint32_t pings;
+  uint32_t pongs;
+  uint32_t maxBurst; // messages added by one poll, i.e. the client's worst backlog
+};
+SimStreamStats simStreamStats();
+
+// Heap use of everything linked into the simulator, from sim_heap.cpp
+struct SimHeapStats
+{
+  size_t current;     // bytes in use
+  size_t peak;        // high-water mark
+  size_t allocations; // calls to malloc, calloc and realloc
+};
+SimHeapStats simHeap();
+void simHeapResetPeak();
+
+// Allocations made by the app on watched threads, e.g. the fetch task once it
+// sent a ticker request; the stand-ins pause the count for their own work
+void simHeapWatchThread();
+size_t simHeapWatchedAllocations();
+class SimHeapPause
+{
+public:
+  SimHeapPause();
+  ~SimHeapPause();
+};
+size_t simWarmAllocations(); // watched ones before the second ticker request, sim.cpp
+
+void simFinish(const char *reason); // prints the report and exits
+int simBenchParse();  // sim_bench_parse.cpp; 0 if both paths read the same prices
+int simBenchPrices(); // sim_bench.cpp; 0 if every known answer matched
+int simBenchAlerts(); // sim_bench_alerts.cpp; likewise
+int simBenchStyles(); // sim_bench_styles.cpp
+int simBenchMeter();  // sim_bench_meter.cpp; 0 if both ways drew the same frames
+int simBenchLines();  // sim_bench_lines.cpp; 0 if both ways put down about the same ink
+int simBenchCircles(); // sim_bench_circles.cpp; 0 if both ways drew the same frames
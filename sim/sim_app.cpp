@@ -0,0 +1,2 @@
+// The app itself: main.ino compiled as plain C++ against the stand-ins
+#include "../src/main.ino"
@@ -0,0 +1,215 @@
+// --bench-prices: checks the fixed-point price parsing and formatting
+// against known answers, from BTC-scale to sub-cent prices, and times it
+// against the float path it replaced (strtod, then printf with 3 decimals).
+// The host has an FPU, so the ratio understates the gain on the ESP32.
+// Also holds the display and reports the LVGL benches share (sim_bench.h).
+
+#include "sim.h"
+#include "sim_bench.h"
+
+#include <Arduino.h>
+#include <chrono>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/price_record.h"
+
+#define BENCH_ROUNDS 200000
+
+struct PriceCase
+{
+  const char *text;     // as the exchange sends it
+  uint8_t decimals;     // tick precision
+  const char *expected; // on a tile, PRICE_SIG_DIGITS significant digits
+};
+
+static const PriceCase priceCases[] = {
+    {"67000.01000000", 2, "67,000.01"},
+    {"123456.78000000", 2, "123,456.8"},
+    {"1234567.89000000", 2, "1,234,568"},
+    {"16777217.01000000", 2, "16,777,217"}, // a float has 16777216
+    {"99999.99400000", 2, "99,999.99"},
+    {"99999.99500000", 2, "100,000.0"}, // the carry takes a digit from the fraction
+    {"0.99999999", 8, "1.000000"},
+    {"3012.34000000", 2, "3,012.34"},
+    {"1.00000000", 4, "1.0000"},
+    {"0.52340000", 4, "0.5234"},
+    {"0.01000000", 5, "0.01000"},
+    {"0.00001234", 8, "0.00001234"},
+    {"0.00000001", 8, "0.00000001"},
+    {"0.123456789", 8, "0.1234568"}, // 9th decimal rounded while parsing
+    {"-1.5", 1, "-1.5"},
+    {"0", 0, "0"},
+};
+
+static const char *const badPrices[] = {"", "-", ".", "abc", "1.2.3", "1e5", "99999999999.0"};
+
+struct ChangeCase
+{
+  const char *percent;
+  int32_t bp;
+};
+
+static const ChangeCase changeCases[] = {
+    {"-1.234", -123}, {"2.345", 235}, {"0.005", 1}, {"-0.004", 0}, {"12.000", 1200}, {"-100.000", -10000},
+};
+
+static int check()
+{
+  int failures = 0;
+  char text[32];
+  for (const PriceCase &c : priceCases)
+  {
+    price_fx_t price;
+    if (!parsePrice(c.text, &price))
+    {
+      printf("FAIL parsePrice(\"%s\") rejected\n", c.text);
+      failures++;
+      continue;
+    }
+    formatDisplayPrice(text, sizeof(text), price, c.decimals, PRICE_SIG_DIGITS);
+    if (strcmp(text, c.expected) != 0)
+    {
+      printf("FAIL %s with %u decimals: \"%s\", expected \"%s\"\n", c.text, c.decimals, text, c.expected);
+      failures++;
+    }
+  }
+  for (const char *bad : badPrices)
+  {
+    price_fx_t price;
+    if (parsePrice(bad, &price))
+    {
+      printf("FAIL parsePrice(\"%s\") accepted\n", bad);
+      failures++;
+    }
+  }
+  for (const ChangeCase &c : changeCases)
+  {
+    int32_t bp = INT32_MIN;
+    if (!parseChangeBp(c.percent, &bp) || bp != c.bp)
+    {
+      printf("FAIL parseChangeBp(\"%s\"): %d, expected %d\n", c.percent, (int)bp, (int)c.bp);
+      failures++;
+    }
+  }
+
+  price_fx_t last, open;
+  parsePrice("67000.00", &last);
+  parsePrice("66000.00", &open);
+  if (changeBpFromPrices(last, open) != 152 || changeBpFromPrices(open, last) != -149)
+  {
+    printf("FAIL changeBpFromPrices: %d, %d\n", (int)changeBpFromPrices(last, open), (int)changeBpFromPrices(open, last));
+    failures++;
+  }
+  parsePrice("67000.01000000", &last);
+  if (priceDecimals(last) != 2)
+  {
+    printf("FAIL priceDecimals(67000.01): %u\n", priceDecimals(last));
+    failures++;
+  }
+  return failures;
+}
+
+template <typename Fn>
+static double nsPerPrice(Fn fn)
+{
+  const size_t count = sizeof(priceCases) / sizeof(priceCases[0]);
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < BENCH_ROUNDS; round++)
+  {
+    for (const PriceCase &c : priceCases)
+      fn(c);
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (BENCH_ROUNDS * count);
+}
+
+int simBenchPrices()
+{
+  int failures = check();
+  printf("golden:  %d failures\n", failures);
+
+  static volatile size_t sink; // keeps the work from being optimized away
+  char text[32];
+  double fixedNs = nsPerPrice([&](const PriceCase &c) {
+    price_fx_t price = 0;
+    parsePrice(c.text, &price);
+    sink = sink + formatDisplayPrice(text, sizeof(text), price, c.decimals, PRICE_SIG_DIGITS);
+  });
+  double floatNs = nsPerPrice([&](const PriceCase &c) {
+    float price = strtod(c.text, NULL);
+    sink = sink + snprintf(text, sizeof(text), "%.3f", price);
+  });
+  printf("bench:   fixed point %.0f ns per price, float %.0f ns (parse and format)\n", fixedNs, floatNs);
+  return failures == 0 ? 0 : 1;
+}
+
+// Shared by the LVGL benches, see sim_bench.h
+
+lv_color_t benchScreen[BENCH_WIDTH * BENCH_HEIGHT];
+static lv_disp_draw_buf_t benchDrawBuf;
+static lv_color_t benchDrawPixels[BENCH_WIDTH * BENCH_LINES];
+static BenchFlushFn benchFlushed;
+
+static void benchFlush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *pixels)
+{
+  int width = lv_area_get_width(area);
+  for (lv_coord_t y = area->y1; y <= area->y2; y++)
+    memcpy(&benchScreen[y * BENCH_WIDTH + area->x1], &pixels[(y - area->y1) * width], width * sizeof(lv_color_t));
+  if (benchFlushed != NULL)
+    benchFlushed(area);
+  lv_disp_flush_ready(drv);
+}
+
+void benchDisplayInit(BenchFlushFn flushed, BenchMonitorFn monitor, lv_coord_t lines)
+{
+  lv_init();
+  benchFlushed = flushed;
+  lv_disp_draw_buf_init(&benchDrawBuf, benchDrawPixels, NULL, BENCH_WIDTH * lines);
+  static lv_disp_drv_t driver;
+  lv_disp_drv_init(&driver);
+  driver.hor_res = BENCH_WIDTH;
+  driver.ver_res = BENCH_HEIGHT;
+  driver.flush_cb = benchFlush;
+  driver.monitor_cb = monitor;
+  driver.draw_buf = &benchDrawBuf;
+  lv_disp_drv_register(&driver);
+}
+
+uint32_t benchHashScreen(uint32_t h)
+{
+  const uint8_t *bytes = (const uint8_t *)benchScreen;
+  for (size_t i = 0; i < sizeof(benchScreen); i++)
+    h = (h ^ bytes[i]) * 16777619u; // FNV-1a
+  return h;
+}
+
+double benchNsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int compareDoubles(const void *a, const void *b)
+{
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+double benchMedian(double *values, int count)
+{
+  qsort(values, count, sizeof(double), compareDoubles);
+  return values[count / 2];
+}
+
+int benchGolden(int failures, const char *format, ...)
+{
+  printf("golden:  %d failures (", failures);
+  va_list args;
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+  printf(")\n");
+  return failures == 0 ? 0 : 1;
+}
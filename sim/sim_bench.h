@@ -0,0 +1,28 @@
+#pragma once
+
+// The display and the reports shared by the LVGL benches, in sim_bench.cpp
+
+#include <chrono>
+#include <stdint.h>
+#include <lvgl.h>
+
+#define BENCH_WIDTH 240 // the watch's screen
+#define BENCH_HEIGHT 240
+#define BENCH_LINES 40              // a strip, as DisplayDriver picks them
+#define BENCH_HASH_SEED 2166136261u // FNV-1a's offset basis
+
+extern lv_color_t benchScreen[BENCH_WIDTH * BENCH_HEIGHT]; // what was flushed
+
+typedef void (*BenchFlushFn)(const lv_area_t *area);
+typedef void (*BenchMonitorFn)(lv_disp_drv_t *drv, uint32_t ms, uint32_t pixels);
+
+// lv_init() and a BENCH_WIDTH x BENCH_HEIGHT display drawn in strips of lines
+// and flushed into benchScreen; flushed is called after each flush and
+// monitor after each refresh
+void benchDisplayInit(BenchFlushFn flushed = NULL, BenchMonitorFn monitor = NULL, lv_coord_t lines = BENCH_LINES);
+uint32_t benchHashScreen(uint32_t h); // h, then a previous hash, folded with benchScreen
+double benchNsSince(std::chrono::steady_clock::time_point start);
+double benchMedian(double *values, int count); // sorts values
+// Prints the "golden:" line, failures followed by the details in brackets;
+// returns the bench's exit code
+int benchGolden(int failures, const char *format, ...);
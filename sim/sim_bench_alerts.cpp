@@ -0,0 +1,204 @@
+// --bench-alerts: checks the alert engine against scripted ticks (levels
+// with hysteresis, moves across a gap, average crosses, the rule text and
+// the saved table), then times onTick() with ALERT_MAX_RULES rules spread
+// over the whole watchlist against a scan that recomputes every rule's
+// window from the closes on each tick.
+
+#include "sim.h"
+
+#include <Arduino.h>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include "../src/alert_engine.h"
+
+#define BENCH_TICKS 2000000
+#define BENCH_SCAN_TICKS 2000
+#define BENCH_SERIES_COINS ALERT_SERIES_COINS
+
+static AlertEngine engine;
+static AlertEngine restored;
+static CoinStore coins;
+static int fired;
+static AlertEvent lastEvent;
+
+static void onFire(const AlertEvent &event)
+{
+  fired++;
+  lastEvent = event;
+}
+
+static price_fx_t fx(int units)
+{
+  return (price_fx_t)units * PRICE_SCALE;
+}
+
+static int expectFired(const char *what, int expected)
+{
+  if (fired == expected)
+    return 0;
+  printf("FAIL %s: %d alerts, expected %d\n", what, fired, expected);
+  return 1;
+}
+
+static int check()
+{
+  int failures = 0;
+  coins.count = 0;
+  coins.addList("BTC,ETH,SOL");
+
+  // A level fires once, and again only after going back past the hysteresis
+  engine.begin(onFire);
+  engine.add({fx(100), 0, ALERT_ABOVE, 0, 0, {}});
+  fired = 0;
+  const int levelTicks[] = {99, 100, 101, 100, 99, 100};
+  for (int price : levelTicks)
+    engine.onTick(0, fx(price), 60);
+  failures += expectFired("level", 2);
+  engine.onTick(0, fx(100) - fx(1) / 100, 60); // 99.99: within 10 bp of the level
+  engine.onTick(0, fx(101), 60);
+  failures += expectFired("level hysteresis", 2);
+
+  // A 5% move over 3 minutes, the middle minutes without ticks
+  engine.begin(onFire);
+  engine.add({500, 1, ALERT_MOVE, 3, 0, {}});
+  fired = 0;
+  engine.onTick(1, fx(100), 60 * 10);
+  engine.onTick(1, fx(104), 60 * 13);
+  failures += expectFired("move below threshold", 0);
+  engine.onTick(1, fx(105), 60 * 13 + 30);
+  failures += expectFired("move", 1);
+  if (fired == 1 && (lastEvent.reference != fx(100) || lastEvent.periods != 3))
+  {
+    printf("FAIL move reference %lld\n", (long long)lastEvent.reference);
+    failures++;
+  }
+
+  // The first side of the average only arms a cross
+  engine.begin(onFire);
+  engine.add({0, 2, ALERT_MA_CROSS, 3, 0, {}});
+  fired = 0;
+  engine.onTick(2, fx(100), 60 * 20);
+  engine.onTick(2, fx(101), 60 * 21);
+  engine.onTick(2, fx(102), 60 * 22);
+  failures += expectFired("average side", 0);
+  engine.onTick(2, fx(95), 60 * 23); // average (101 + 102 + 95) / 3
+  failures += expectFired("average cross", 1);
+  if (fired == 1 && lastEvent.reference != (fx(101) + fx(102) + fx(95)) / 3)
+  {
+    printf("FAIL average %lld\n", (long long)lastEvent.reference);
+    failures++;
+  }
+
+  // Rule text, and the table saved with its state
+  engine.begin(onFire);
+  if (engine.parse(coins, "BTC>70000,ETH%5/60,SOL^20,BTC<60000.5") != 4 || engine.parse(coins, "XRP>1") != -1 ||
+      engine.parse(coins, "BTC^99") != -1 || engine.parse(coins, "BTC=1") != -1)
+  {
+    printf("FAIL parse\n");
+    failures++;
+  }
+  engine.onTick(0, fx(71000), 60);
+  uint32_t key = alertKey(coins, "test");
+  if (!engine.save(key) || !restored.load(key) || restored.count() != 4 ||
+      memcmp(&restored.rule(0), &engine.rule(0), sizeof(AlertRule)) != 0 || restored.load(key + 1))
+  {
+    printf("FAIL save and load\n");
+    failures++;
+  }
+  if (!(engine.rule(0).state & ALERT_FIRED) || engine.rule(0).coin != 0 || engine.rule(3).coin != 2)
+  {
+    printf("FAIL rule table order or state\n");
+    failures++;
+  }
+  return failures;
+}
+
+// The engine's rules evaluated the obvious way: every rule on every tick,
+// each window summed up from a plain array of closes
+static uint32_t scanRules(const price_fx_t closes[][ALERT_WINDOW_MAX + 1], int coin, price_fx_t price)
+{
+  uint32_t hits = 0;
+  for (int i = 0; i < engine.count(); i++)
+  {
+    const AlertRule &rule = engine.rule(i);
+    if (rule.coin != coin)
+      continue;
+    if (rule.type == ALERT_MA_CROSS)
+    {
+      price_fx_t sum = 0;
+      for (int k = 0; k < rule.periods; k++)
+        sum += closes[coin][k];
+      hits += price > sum / rule.periods;
+    }
+    else if (rule.type == ALERT_MOVE)
+    {
+      hits += abs(changeBpFromPrices(price, closes[coin][rule.periods])) >= rule.value;
+    }
+    else
+    {
+      hits += rule.type == ALERT_ABOVE ? price >= rule.value : price <= rule.value;
+    }
+  }
+  return hits;
+}
+
+static void addBenchRules()
+{
+  engine.begin(onFire);
+  for (int i = 0; engine.count() < ALERT_MAX_RULES; i++)
+  {
+    AlertRule rule = {};
+    rule.coin = i % MAX_COINS;
+    rule.type = rule.coin < BENCH_SERIES_COINS ? i / MAX_COINS % 4 : i / MAX_COINS % 2;
+    rule.periods = 2 + i % (ALERT_WINDOW_MAX - 1);
+    rule.value = rule.type == ALERT_MOVE ? 50 + i % 200 : rule.type == ALERT_MA_CROSS ? 0 : fx(90 + i % 20);
+    if (!engine.add(rule))
+      break;
+  }
+}
+
+int simBenchAlerts()
+{
+  int failures = check();
+  printf("golden:  %d failures\n", failures);
+
+  addBenchRules();
+  static price_fx_t closes[MAX_COINS][ALERT_WINDOW_MAX + 1];
+  static price_fx_t prices[MAX_COINS];
+  for (int coin = 0; coin < MAX_COINS; coin++)
+  {
+    prices[coin] = fx(100);
+    for (int k = 0; k <= ALERT_WINDOW_MAX; k++)
+      closes[coin][k] = prices[coin];
+  }
+
+  // A random walk of 0.1% steps over all coins, 50 ticks a second
+  uint32_t random = simOptions.seed;
+  fired = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t tick = 0; tick < BENCH_TICKS; tick++)
+  {
+    int coin = tick % MAX_COINS;
+    random = random * 1103515245 + 12345;
+    prices[coin] += prices[coin] / 1000 * ((int)(random >> 16 & 2) - 1);
+    engine.onTick(coin, prices[coin], 1700000000 + tick / 50);
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  const AlertStats &stats = engine.stats();
+  double perTick = elapsed.count() / BENCH_TICKS;
+  printf("bench:   %d rules on %d coins: %.0f ns per tick, %.1f rules evaluated per tick, %u alerts\n",
+         engine.count(), MAX_COINS, perTick, (double)stats.evaluated / stats.ticks, stats.fired);
+
+  static volatile uint32_t sink; // keeps the scan from being optimized away
+  start = std::chrono::steady_clock::now();
+  for (uint32_t tick = 0; tick < BENCH_SCAN_TICKS; tick++)
+  {
+    int coin = tick % MAX_COINS;
+    sink = sink + scanRules(closes, coin, prices[coin]);
+  }
+  elapsed = std::chrono::steady_clock::now() - start;
+  printf("         full scan with summed windows: %.0f ns per tick (%.0fx)\n", elapsed.count() / BENCH_SCAN_TICKS,
+         elapsed.count() / BENCH_SCAN_TICKS / perTick);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+// --bench-circles: redraws two screens full of rounded corners headless, once
+// with the LV_CIRCLE_CACHE_SIZE entries LVGL frees after each refresh and
+// once with the LRU cache of circles: a coin tile like the app's (round
+// meter, arcs of the day's range and volume, rounded labels) and a grid of
+// buttons and arcs of many radii. Checks that both ways draw the same
+// screens, and reports the time per frame, the cache's hit rate and size,
+// then times the masks alone, a few radii or every radius of the screen
+// once per refresh: the cache only pays when the radii in use fit in it.
+
+#include "sim.h"
+#include "sim_bench.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+
+#define BENCH_FRAMES 1000
+#define BENCH_MASK_ROUNDS 200
+#define BENCH_FEW_RADII 24 // about 2.5 KB of circles
+#define BENCH_MAX_RADIUS (BENCH_WIDTH / 2)
+
+struct CircleRun
+{
+  double frameNs;
+  uint32_t image; // hash of every frame drawn
+  lv_draw_mask_circle_cache_stats_t stats;
+};
+
+static lv_obj_t *addArc(lv_coord_t size, lv_coord_t width, lv_align_t align, lv_coord_t x, lv_coord_t y)
+{
+  lv_obj_t *arc = lv_arc_create(lv_scr_act());
+  lv_obj_set_size(arc, size, size);
+  lv_obj_align(arc, align, x, y);
+  lv_obj_set_style_arc_width(arc, width, LV_PART_MAIN);
+  lv_obj_set_style_arc_width(arc, width, LV_PART_INDICATOR);
+  return arc;
+}
+
+static void buildTile(lv_obj_t **arcs, int *count)
+{
+  lv_obj_t *meter = lv_meter_create(lv_scr_act());
+  lv_obj_center(meter);
+  lv_obj_set_size(meter, BENCH_WIDTH, BENCH_HEIGHT);
+  lv_meter_scale_t *scale = lv_meter_add_scale(meter);
+  lv_meter_set_scale_ticks(meter, scale, 21, 2, 10, lv_palette_main(LV_PALETTE_GREY));
+  lv_meter_set_scale_major_ticks(meter, scale, 5, 4, 15, lv_color_black(), 10);
+  lv_meter_set_scale_range(meter, scale, -10, 10, 270, 135);
+  lv_meter_add_needle_line(meter, scale, 4, lv_palette_main(LV_PALETTE_RED), -10);
+
+  arcs[0] = addArc(150, 8, LV_ALIGN_CENTER, 0, 0);
+  arcs[1] = addArc(120, 6, LV_ALIGN_CENTER, 0, 0);
+  *count = 2;
+
+  const char *texts[] = {"BTC", "$67,012.40", "+2.31%"};
+  for (int i = 0; i < 3; i++)
+  {
+    lv_obj_t *label = lv_label_create(lv_scr_act());
+    lv_label_set_text(label, texts[i]);
+    lv_obj_set_style_bg_opa(label, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_color(label, lv_palette_lighten(LV_PALETTE_BLUE, 3), 0);
+    lv_obj_set_style_radius(label, 4 + i * 3, 0);
+    lv_obj_set_style_pad_all(label, 3, 0);
+    lv_obj_align(label, LV_ALIGN_CENTER, 0, -30 + i * 24);
+  }
+}
+
+static void buildGrid(lv_obj_t **arcs, int *count)
+{
+  for (int i = 0; i < 12; i++)
+  {
+    lv_obj_t *button = lv_btn_create(lv_scr_act());
+    lv_obj_set_size(button, 52, 30 + i % 3 * 4);
+    lv_obj_set_pos(button, 8 + i % 4 * 58, 8 + i / 4 * 44);
+    lv_obj_set_style_radius(button, 3 + i, 0);
+  }
+  *count = 0;
+  for (int i = 0; i < 4; i++)
+    arcs[(*count)++] = addArc(44 + i * 6, 4 + i, LV_ALIGN_BOTTOM_LEFT, 6 + i * 58, -10);
+}
+
+static CircleRun runScene(bool lru, void (*build)(lv_obj_t **, int *))
+{
+  CircleRun run = {};
+  run.image = BENCH_HASH_SEED;
+  lv_obj_clean(lv_scr_act());
+  lv_draw_mask_enable_circle_lru(lru);
+
+  lv_obj_t *arcs[8];
+  int count;
+  build(arcs, &count);
+  lv_refr_now(NULL);
+  lv_draw_mask_reset_circle_cache_stats();
+
+  // The arcs move, the whole screen is redrawn as a swipe does
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t frame = 0; frame < BENCH_FRAMES; frame++)
+  {
+    for (int i = 0; i < count; i++)
+      lv_arc_set_value(arcs[i], (frame * (i + 1)) % 100);
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+    run.image = benchHashScreen(run.image);
+  }
+  run.frameNs = benchNsSince(start) / BENCH_FRAMES;
+  lv_draw_mask_get_circle_cache_stats(&run.stats);
+
+  lv_obj_clean(lv_scr_act());
+  lv_refr_now(NULL);
+  lv_draw_mask_enable_circle_lru(true);
+  return run;
+}
+
+// Per mask, with the cleanup of a refresh after each round of radii
+static double timeMasks(bool lru, lv_coord_t maxRadius)
+{
+  lv_draw_mask_enable_circle_lru(lru);
+  lv_area_t area = {0, 0, BENCH_WIDTH - 1, BENCH_HEIGHT - 1};
+  lv_draw_mask_radius_param_t param;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < BENCH_MASK_ROUNDS; round++)
+  {
+    for (lv_coord_t radius = 1; radius <= maxRadius; radius++)
+    {
+      lv_draw_mask_radius_init(&param, &area, radius, false);
+      lv_draw_mask_free_param(&param);
+    }
+    _lv_draw_mask_cleanup();
+  }
+  double ns = benchNsSince(start);
+  lv_draw_mask_enable_circle_lru(true);
+  return ns / BENCH_MASK_ROUNDS / maxRadius;
+}
+
+static void report(const char *scene, const CircleRun &entries, const CircleRun &lru)
+{
+  const lv_draw_mask_circle_cache_stats_t &a = entries.stats;
+  const lv_draw_mask_circle_cache_stats_t &b = lru.stats;
+  printf("         %s, %d entries: %.3f ms per frame, %.1f%% hits\n", scene, LV_CIRCLE_CACHE_SIZE, entries.frameNs / 1e6,
+         100.0 * a.hits / (a.hits + a.misses));
+  printf("         %s, LRU cache:  %.3f ms per frame, %.1f%% hits, %u circles in %u bytes, %u evictions (%.1fx)\n",
+         scene, lru.frameNs / 1e6, 100.0 * b.hits / (b.hits + b.misses), b.entries, b.size, b.evictions,
+         entries.frameNs / lru.frameNs);
+}
+
+int simBenchCircles()
+{
+  benchDisplayInit();
+
+  CircleRun tileEntries = runScene(false, buildTile);
+  CircleRun tileLru = runScene(true, buildTile);
+  CircleRun gridEntries = runScene(false, buildGrid);
+  CircleRun gridLru = runScene(true, buildGrid);
+
+  int failures = (tileEntries.image != tileLru.image) + (gridEntries.image != gridLru.image);
+  int result = benchGolden(failures, "screens drawn differently");
+  printf("bench:   %u frames at %dx%d, %d-line strips, %d bytes of LRU cache\n", BENCH_FRAMES, BENCH_WIDTH,
+         BENCH_HEIGHT, BENCH_LINES, LV_CIRCLE_CACHE_LRU_SIZE);
+  report("coin tile", tileEntries, tileLru);
+  report("buttons and arcs", gridEntries, gridLru);
+
+  for (lv_coord_t maxRadius : {BENCH_FEW_RADII, BENCH_MAX_RADIUS})
+  {
+    double entriesNs = timeMasks(false, maxRadius);
+    lv_draw_mask_reset_circle_cache_stats();
+    double lruNs = timeMasks(true, maxRadius);
+    lv_draw_mask_circle_cache_stats_t stats;
+    lv_draw_mask_get_circle_cache_stats(&stats);
+    printf("         radius masks 1 to %d each refresh: %d entries %.2f us per mask, LRU cache %.2f us (%.1fx), "
+           "%.1f%% hits\n",
+           maxRadius, LV_CIRCLE_CACHE_SIZE, entriesNs / 1e3, lruNs / 1e3, entriesNs / lruNs,
+           100.0 * stats.hits / (stats.hits + stats.misses));
+  }
+  return result;
+}
@@ -0,0 +1,118 @@
+// --bench-lines: draws a fan of skewed lines headless, like the meter's
+// needle swept around the dial, at widths 1 to 8, once with the line masks
+// and once from the distance of each pixel to the line. Checks that both put
+// down about the same ink, give or take a pixel of width, and reports the
+// time per line.
+
+#include "sim.h"
+#include "sim_bench.h"
+
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+#include "src/draw/sw/lv_draw_sw.h"
+
+#define BENCH_FAN 64     // lines per frame, all around the centre
+#define BENCH_RADIUS 100 // the needle's length
+#define BENCH_FRAMES 100 // per width
+#define BENCH_MAX_WIDTH 8
+
+struct LineRun
+{
+  double lineNs[BENCH_MAX_WIDTH + 1]; // per line, by width
+  uint64_t ink[BENCH_MAX_WIDTH + 1];  // of one frame, in 1/255 px
+};
+
+static lv_draw_line_dsc_t lineDsc;
+
+// Black lines on white, not quite on the diagonals
+static void drawFan(lv_event_t *e)
+{
+  lv_draw_ctx_t *drawCtx = lv_event_get_draw_ctx(e);
+  lv_point_t centre = {BENCH_WIDTH / 2, BENCH_HEIGHT / 2};
+  for (int i = 0; i < BENCH_FAN; i++)
+  {
+    double angle = (i + 0.3) * 2 * M_PI / BENCH_FAN;
+    lv_point_t end = {(lv_coord_t)lround(centre.x + BENCH_RADIUS * cos(angle)),
+                      (lv_coord_t)lround(centre.y + BENCH_RADIUS * sin(angle))};
+    lv_draw_line(drawCtx, &lineDsc, &centre, &end);
+  }
+}
+
+static uint64_t ink()
+{
+  uint64_t sum = 0;
+  for (int i = 0; i < BENCH_WIDTH * BENCH_HEIGHT; i++)
+    sum += 255 - lv_color_brightness(benchScreen[i]);
+  return sum;
+}
+
+static LineRun runLines(bool analytic)
+{
+  LineRun run = {};
+  lv_draw_sw_line_enable_analytic(analytic);
+  lv_obj_clean(lv_scr_act());
+  lv_obj_set_style_bg_color(lv_scr_act(), lv_color_white(), 0);
+  lv_obj_t *fan = lv_obj_create(lv_scr_act());
+  lv_obj_remove_style_all(fan);
+  lv_obj_set_size(fan, BENCH_WIDTH, BENCH_HEIGHT);
+  lv_obj_add_event_cb(fan, drawFan, LV_EVENT_DRAW_MAIN, NULL);
+  lv_draw_line_dsc_init(&lineDsc);
+  lineDsc.color = lv_color_black();
+
+  for (int width = 1; width <= BENCH_MAX_WIDTH; width++)
+  {
+    lineDsc.width = width;
+    lv_obj_invalidate(fan);
+    lv_refr_now(NULL);
+    run.ink[width] = ink();
+
+    // The same frames with the lines left out, to take off the rest of the redraw
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+      lv_obj_invalidate(fan);
+      lv_refr_now(NULL);
+    }
+    double lines = benchNsSince(start);
+    lineDsc.width = 0;
+    start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++)
+    {
+      lv_obj_invalidate(fan);
+      lv_refr_now(NULL);
+    }
+    double empty = benchNsSince(start);
+    run.lineNs[width] = (lines - empty) / BENCH_FRAMES / BENCH_FAN;
+  }
+
+  lv_draw_sw_line_enable_analytic(true);
+  lv_obj_clean(lv_scr_act());
+  lv_refr_now(NULL);
+  return run;
+}
+
+int simBenchLines()
+{
+  benchDisplayInit();
+
+  LineRun masks = runLines(false);
+  LineRun analytic = runLines(true);
+
+  int failures = 0;
+  for (int width = 1; width <= BENCH_MAX_WIDTH; width++)
+  {
+    uint64_t most = (uint64_t)BENCH_FAN * BENCH_RADIUS * 255; // a pixel of width on every line
+    uint64_t diff = masks.ink[width] > analytic.ink[width] ? masks.ink[width] - analytic.ink[width]
+                                                            : analytic.ink[width] - masks.ink[width];
+    failures += diff > most;
+  }
+  int result = benchGolden(failures, "widths where the ink differs by more than a pixel of width");
+  printf("bench:   %d lines of %dpx from the centre of %dx%d, %d-line strips\n", BENCH_FAN, BENCH_RADIUS, BENCH_WIDTH,
+         BENCH_HEIGHT, BENCH_LINES);
+  for (int width = 1; width <= BENCH_MAX_WIDTH; width++)
+    printf("         width %d: masks %.2f us per line, distance %.2f us (%.1fx), ink %+.1f%%\n", width,
+           masks.lineNs[width] / 1e3, analytic.lineNs[width] / 1e3, masks.lineNs[width] / analytic.lineNs[width],
+           100.0 * analytic.ink[width] / masks.ink[width] - 100);
+  return result;
+}
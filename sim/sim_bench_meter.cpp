@@ -0,0 +1,168 @@
+// --bench-meter: moves the needle of a meter like the app's coin tile
+// headless, once drawing the scale every time and once from the image
+// lv_meter_enable_scale_cache() keeps of it, then redraws the whole meter as
+// a swipe does. Checks that both ways draw the same screens, give or take the
+// rounding of the scale's anti-aliased edges, that the cached scale isn't
+// drawn again, and reports the median time per frame of a few runs each way,
+// taken in turn.
+
+#include "sim.h"
+#include "sim_bench.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_MOVES 2000
+#define BENCH_REDRAWS 200
+#define BENCH_RUNS 5          // each way; the medians are reported
+#define BENCH_CHECKS 20       // screens kept to compare the runs
+#define BENCH_MAX_STEPS 2     // of a color channel: the cached edges are rounded twice
+#define BENCH_SCALE_PARTS 21  // ticks, each sending a draw part event when drawn
+
+struct MeterRun
+{
+  double moveNs;       // per needle move
+  double redrawNs;     // per redraw of the whole meter
+  uint32_t scaleDraws; // after the first, counted by the ticks' draw part events
+};
+
+static lv_color_t checks[2][BENCH_CHECKS][BENCH_WIDTH * BENCH_HEIGHT];
+static uint32_t tickParts;
+
+static void countTicks(lv_event_t *e)
+{
+  lv_obj_draw_part_dsc_t *dsc = lv_event_get_draw_part_dsc(e);
+  if (dsc->class_p == &lv_meter_class && dsc->type == LV_METER_DRAW_PART_TICK)
+    tickParts++;
+}
+
+static MeterRun runMeter(bool cache, lv_color_t (*kept)[BENCH_WIDTH * BENCH_HEIGHT])
+{
+  MeterRun run = {};
+  lv_obj_clean(lv_scr_act());
+
+  // As create_crypto_watch() builds it
+  lv_obj_t *meter = lv_meter_create(lv_scr_act());
+  lv_obj_center(meter);
+  lv_obj_set_size(meter, BENCH_WIDTH, BENCH_HEIGHT);
+  lv_meter_scale_t *scale = lv_meter_add_scale(meter);
+  lv_meter_set_scale_ticks(meter, scale, BENCH_SCALE_PARTS, 2, 10, lv_palette_main(LV_PALETTE_GREY));
+  lv_meter_set_scale_major_ticks(meter, scale, 5, 4, 15, lv_color_black(), 10);
+  lv_meter_set_scale_range(meter, scale, -10, 10, 270, 135);
+  lv_meter_indicator_t *needle = lv_meter_add_needle_line(meter, scale, 4, lv_palette_main(LV_PALETTE_RED), -10);
+  lv_meter_enable_scale_cache(meter, cache);
+  lv_obj_add_event_cb(meter, countTicks, LV_EVENT_DRAW_PART_BEGIN, NULL);
+  lv_refr_now(NULL);
+
+  // The same walk for both runs, a step each frame
+  uint32_t random = simOptions.seed;
+  int32_t value = 0;
+  tickParts = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t frame = 0; frame < BENCH_MOVES; frame++)
+  {
+    random = random * 1103515245 + 12345;
+    value = constrain(value + ((random >> 16 & 2) ? 1 : -1), -10, 10);
+    lv_meter_set_indicator_value(meter, needle, value);
+    lv_refr_now(NULL);
+    if (frame % (BENCH_MOVES / BENCH_CHECKS) == 0)
+      memcpy(kept[frame / (BENCH_MOVES / BENCH_CHECKS)], benchScreen, sizeof(benchScreen));
+  }
+  run.moveNs = benchNsSince(start) / BENCH_MOVES;
+
+  start = std::chrono::steady_clock::now();
+  for (uint32_t frame = 0; frame < BENCH_REDRAWS; frame++)
+  {
+    lv_obj_invalidate(meter);
+    lv_refr_now(NULL);
+  }
+  run.redrawNs = benchNsSince(start) / BENCH_REDRAWS;
+  run.scaleDraws = tickParts / BENCH_SCALE_PARTS;
+
+  lv_obj_clean(lv_scr_act());
+  lv_refr_now(NULL);
+  return run;
+}
+
+// The largest difference of a channel between the kept screens of the runs,
+// in steps of the channel
+static int maxDifference(uint32_t *pixels)
+{
+  int most = 0;
+  *pixels = 0;
+  for (int check = 0; check < BENCH_CHECKS; check++)
+  {
+    for (int i = 0; i < BENCH_WIDTH * BENCH_HEIGHT; i++)
+    {
+      lv_color_t a = checks[0][check][i];
+      lv_color_t b = checks[1][check][i];
+      int d = max(abs((int)LV_COLOR_GET_R(a) - (int)LV_COLOR_GET_R(b)),
+                  max(abs((int)LV_COLOR_GET_G(a) - (int)LV_COLOR_GET_G(b)),
+                      abs((int)LV_COLOR_GET_B(a) - (int)LV_COLOR_GET_B(b))));
+      *pixels += d != 0;
+      most = max(most, d);
+    }
+  }
+  return most;
+}
+
+static int compareNs(const void *a, const void *b)
+{
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static double median(double *ns)
+{
+  qsort(ns, BENCH_RUNS, sizeof(double), compareNs);
+  return ns[BENCH_RUNS / 2];
+}
+
+// The medians of BENCH_RUNS runs, the most the scale was drawn again
+static MeterRun medianRun(const MeterRun *runs)
+{
+  double moves[BENCH_RUNS];
+  double redraws[BENCH_RUNS];
+  MeterRun run = {};
+  for (int i = 0; i < BENCH_RUNS; i++)
+  {
+    moves[i] = runs[i].moveNs;
+    redraws[i] = runs[i].redrawNs;
+    run.scaleDraws = max(run.scaleDraws, runs[i].scaleDraws);
+  }
+  run.moveNs = median(moves);
+  run.redrawNs = median(redraws);
+  return run;
+}
+
+int simBenchMeter()
+{
+  benchDisplayInit();
+
+  MeterRun directRuns[BENCH_RUNS];
+  MeterRun cachedRuns[BENCH_RUNS];
+  for (int i = 0; i < BENCH_RUNS; i++)
+  {
+    directRuns[i] = runMeter(false, checks[0]);
+    cachedRuns[i] = runMeter(true, checks[1]);
+  }
+  MeterRun direct = medianRun(directRuns);
+  MeterRun cached = medianRun(cachedRuns);
+
+  uint32_t pixels;
+  int most = maxDifference(&pixels);
+  int failures = (most > BENCH_MAX_STEPS) + (cached.scaleDraws != 0);
+  int result = benchGolden(failures, "%u pixels differ by up to %d steps, the cached scale drawn again %u times", pixels,
+                           most, cached.scaleDraws);
+  printf("bench:   %u needle moves at %dx%d, %d-line strips, %.1f KB of image, medians of %d runs\n", BENCH_MOVES,
+         BENCH_WIDTH, BENCH_HEIGHT, BENCH_LINES, BENCH_WIDTH * BENCH_HEIGHT * LV_IMG_PX_SIZE_ALPHA_BYTE / 1024.0,
+         BENCH_RUNS);
+  printf("         needle move: scale drawn %.3f ms, cached %.3f ms (%.1fx)\n", direct.moveNs / 1e6,
+         cached.moveNs / 1e6, direct.moveNs / cached.moveNs);
+  printf("         whole meter: scale drawn %.3f ms, cached %.3f ms (%.1fx)\n", direct.redrawNs / 1e6,
+         cached.redrawNs / 1e6, direct.redrawNs / cached.redrawNs);
+  return result;
+}
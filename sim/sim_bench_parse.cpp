@@ -0,0 +1,233 @@
+// --bench-parse: parses ticker responses in the exchange's full format both
+// ways and reports the peak heap and the time of each: the old path, which
+// read the body into a String and deserialized it into a DynamicJsonDocument
+// of 1024 bytes per coin, and parseTickerStream(), which takes one filtered
+// element at a time off the stream. The responses are the first 1, 3, 10 and
+// 20 coins of sim/ticker_payload.json, or the whole of --payload FILE. Checks
+// that both paths read the same prices.
+
+#include "sim.h"
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <chrono>
+#include <fstream>
+#include <math.h>
+#include <sstream>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "../src/price_record.h"
+#include "../src/ticker_parser.h"
+
+#define BENCH_PAYLOAD "sim/ticker_payload.json" // one element per line
+#define BENCH_ROUNDS 1000
+#define BENCH_PACKET 1436 // bytes per read, a TCP segment's worth
+
+// The body as the socket hands it over
+class PayloadReader
+{
+public:
+  explicit PayloadReader(const std::string &body) : _body(body) {}
+
+  int read() { return _pos < _body.size() ? (uint8_t)_body[_pos++] : -1; }
+
+  size_t readBytes(char *buffer, size_t length)
+  {
+    size_t n = std::min(length, _body.size() - _pos);
+    memcpy(buffer, _body.data() + _pos, n);
+    _pos += n;
+    return n;
+  }
+
+private:
+  const std::string &_body;
+  size_t _pos = 0;
+};
+
+struct OldQuote
+{
+  float price;
+  float change;
+};
+
+struct NewQuote
+{
+  price_fx_t price;
+  int32_t changeBp;
+};
+
+struct ParseRun
+{
+  double parseNs;     // per response
+  size_t peakHeap;    // above what was in use before
+  size_t peakDoc;     // JsonDocument::memoryUsage() of the stream's element
+  bool ok;
+};
+
+// As getCryptoPrices() did before parseTickerStream(): the whole body in a
+// String (reserved to the length first, as HTTPClient::getString() does),
+// deserialized unfiltered into a document of 1024 bytes per coin. The
+// host's pointers and so ArduinoJson's slots are twice the ESP32's, so is
+// the document, or a single coin wouldn't fit as it did on the device.
+static bool parseOld(const std::string &body, int coins, OldQuote *quotes)
+{
+  PayloadReader reader(body);
+  std::string payload;
+  payload.reserve(body.size() + 1);
+  char buffer[BENCH_PACKET];
+  size_t n;
+  while ((n = reader.readBytes(buffer, sizeof(buffer))) > 0)
+    payload.append(buffer, n);
+
+  DynamicJsonDocument doc(1024 * coins * sizeof(void *) / 4);
+  if (deserializeJson(doc, (const char *)payload.c_str(), payload.size()))
+    return false;
+  for (int i = 0; i < coins; i++)
+  {
+    quotes[i].price = doc[i]["lastPrice"];
+    quotes[i].change = doc[i]["priceChangePercent"];
+  }
+  return true;
+}
+
+// As BinanceSource::parse() does
+static bool parseNew(const std::string &body, int coins, NewQuote *quotes, TickerParseStats *stats)
+{
+  PayloadReader reader(body);
+  return parseTickerStream(
+      reader,
+      [&](size_t index, JsonObjectConst item)
+      {
+        const char *lastPrice = item["lastPrice"];
+        const char *changePercent = item["priceChangePercent"];
+        if ((int)index >= coins || lastPrice == NULL || changePercent == NULL)
+          return;
+        parsePrice(lastPrice, &quotes[index].price);
+        parseChangeBp(changePercent, &quotes[index].changeBp);
+      },
+      stats);
+}
+
+template <typename Fn>
+static ParseRun runParse(Fn parse)
+{
+  ParseRun run = {};
+  simHeapResetPeak();
+  size_t before = simHeap().current;
+  run.ok = parse();
+  run.peakHeap = simHeap().peak - before;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < BENCH_ROUNDS; round++)
+    parse();
+  run.parseNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCH_ROUNDS;
+  return run;
+}
+
+static bool readFile(const char *path, std::string &content)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    return false;
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  content = buffer.str();
+  return true;
+}
+
+// The responses to compare: prefixes of the recorded elements, or --payload
+static bool loadPayloads(std::vector<std::string> &bodies)
+{
+  std::string content;
+  if (simOptions.payloadPath != NULL)
+  {
+    if (!readFile(simOptions.payloadPath, content))
+      return false;
+    bodies.push_back(content);
+    return true;
+  }
+  if (!readFile(BENCH_PAYLOAD, content))
+    return false;
+
+  std::vector<std::string> items;
+  std::istringstream lines(content);
+  std::string line;
+  while (std::getline(lines, line))
+  {
+    if (line.empty() || line[0] != '{')
+      continue;
+    if (line.back() == ',')
+      line.pop_back();
+    items.push_back(line);
+  }
+  for (size_t count : {(size_t)1, (size_t)3, (size_t)10, items.size()})
+  {
+    std::string body = "[";
+    for (size_t i = 0; i < count && i < items.size(); i++)
+      body += (i > 0 ? "," : "") + items[i];
+    bodies.push_back(body + "]");
+  }
+  return true;
+}
+
+// The same price to a float's precision and the same change to a basis point
+static int compareQuotes(const OldQuote *old, const NewQuote *fresh, int coins)
+{
+  int failures = 0;
+  for (int i = 0; i < coins; i++)
+  {
+    double price = (double)fresh[i].price / PRICE_SCALE;
+    if (fabs(old[i].price - price) > price * 1e-6 || fabs(old[i].change * 100 - fresh[i].changeBp) > 1)
+    {
+      printf("FAIL coin %d: %.8f and %.2f%%, stream %.8f and %.2f%%\n", i, old[i].price, old[i].change, price,
+             fresh[i].changeBp / 100.0);
+      failures++;
+    }
+  }
+  return failures;
+}
+
+int simBenchParse()
+{
+  std::vector<std::string> bodies;
+  if (!loadPayloads(bodies))
+  {
+    printf("bench:   can't read %s, run from the repository or give --payload FILE\n",
+           simOptions.payloadPath != NULL ? simOptions.payloadPath : BENCH_PAYLOAD);
+    return 1;
+  }
+
+  int failures = 0;
+  std::vector<ParseRun> olds, news;
+  std::vector<int> counts;
+  for (const std::string &body : bodies)
+  {
+    TickerParseStats stats;
+    parseNew(body, 0, NULL, &stats);
+    int coins = (int)stats.count;
+    std::vector<OldQuote> oldQuotes(coins);
+    std::vector<NewQuote> newQuotes(coins);
+
+    ParseRun old = runParse([&]() { return parseOld(body, coins, oldQuotes.data()); });
+    ParseRun fresh = runParse([&]() { return parseNew(body, coins, newQuotes.data(), &stats); });
+    fresh.peakDoc = stats.peakDocUsage;
+    failures += !old.ok + !fresh.ok;
+    if (old.ok && fresh.ok)
+      failures += compareQuotes(oldQuotes.data(), newQuotes.data(), coins);
+    olds.push_back(old);
+    news.push_back(fresh);
+    counts.push_back(coins);
+  }
+
+  printf("golden:  %d failures (responses not parsed or prices read differently)\n", failures);
+  printf("bench:   %d parses of each response, %d-byte reads; the stream's %d-byte document is on the stack\n",
+         BENCH_ROUNDS, BENCH_PACKET, TICKER_DOC_SIZE);
+  for (size_t i = 0; i < bodies.size(); i++)
+    printf("         %d coin%s, %zu bytes: String + document %.1f us, %zu bytes of heap; stream %.1f us (%.1fx), "
+           "%zu bytes of heap, %zu of the document used\n",
+           counts[i], counts[i] == 1 ? "" : "s", bodies[i].size(), olds[i].parseNs / 1e3, olds[i].peakHeap, news[i].parseNs / 1e3,
+           olds[i].parseNs / news[i].parseNs, news[i].peakHeap, news[i].peakDoc);
+  return failures == 0 ? 0 : 1;
+}
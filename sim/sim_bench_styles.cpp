@@ -0,0 +1,150 @@
+// --bench-styles: renders the scenes of LVGL's benchmark demo headless, a
+// number of frames each, once searching the styles on every property read
+// and once through the resolved-style cache, then reads every property of
+// every object of the scene to time the lookups alone. Reports the median
+// time per frame and per read of a few runs each way, taken in turn, the
+// cache's hit rate while rendering and the memory it takes per object.
+
+#include "sim.h"
+#include "sim_bench.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+#include "demos/benchmark/lv_demo_benchmark.h"
+
+#define BENCH_STYLE_LINES 24
+#define BENCH_FRAMES 20      // per scene
+#define BENCH_READ_ROUNDS 50 // of reading every property of the scene
+#define BENCH_RUNS 5         // each way; the medians are reported
+
+#if LV_USE_STYLE_CACHE
+
+struct StyleRun
+{
+  int scenes;
+  uint32_t frames;
+  double renderNs;
+  uint32_t reads;
+  double readNs;
+  lv_obj_style_cache_stats_t render; // the cache's counters while rendering,
+                                     // and its size at the end of each scene summed up
+};
+
+static volatile uint32_t sink; // keeps the reads from being optimized away
+
+static uint32_t readProps(lv_obj_t *obj)
+{
+  uint32_t reads = 0;
+  for (uint32_t prop = 1; prop <= _LV_STYLE_LAST_BUILT_IN_PROP; prop++)
+  {
+    sink = sink + lv_obj_get_style_prop(obj, LV_PART_MAIN, (lv_style_prop_t)prop).num;
+    reads++;
+  }
+  for (uint32_t i = 0; i < lv_obj_get_child_cnt(obj); i++)
+    reads += readProps(lv_obj_get_child(obj, i));
+  return reads;
+}
+
+// False once past the last scene
+static bool runScene(int scene, StyleRun &run)
+{
+  lv_obj_clean(lv_scr_act());
+  lv_timer_t *newest = lv_timer_get_next(NULL);
+  lv_demo_benchmark_run_scene(scene);
+  if (lv_timer_get_next(NULL) != newest)
+    lv_timer_del(lv_timer_get_next(NULL)); // the scene's report timer; timers aren't run here
+  lv_obj_t *sceneBg = lv_obj_get_child(lv_scr_act(), 2);
+  if (lv_obj_get_child_cnt(sceneBg) == 0)
+    return false;
+
+  lv_obj_reset_style_cache_stats();
+  auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < BENCH_FRAMES; frame++)
+  {
+    lv_anim_refr_now();
+    lv_obj_invalidate(lv_scr_act());
+    lv_refr_now(NULL);
+  }
+  run.renderNs += benchNsSince(start);
+  run.frames += BENCH_FRAMES;
+  run.scenes++;
+
+  lv_obj_style_cache_stats_t stats;
+  lv_obj_get_style_cache_stats(&stats);
+  run.render.hits += stats.hits;
+  run.render.misses += stats.misses;
+  run.render.bypasses += stats.bypasses;
+  run.render.evictions += stats.evictions;
+  run.render.objects += stats.objects;
+  run.render.slots += stats.slots;
+  run.render.size += stats.size;
+
+  start = std::chrono::steady_clock::now();
+  for (int round = 0; round < BENCH_READ_ROUNDS; round++)
+    run.reads += readProps(lv_scr_act());
+  run.readNs += benchNsSince(start);
+  return true;
+}
+
+static StyleRun runScenes(bool cache)
+{
+  StyleRun run = {};
+  lv_obj_enable_style_cache(cache);
+  for (int scene = 0; runScene(scene, run); scene++)
+    ;
+  lv_obj_clean(lv_scr_act());
+  return run;
+}
+
+int simBenchStyles()
+{
+  benchDisplayInit(NULL, NULL, BENCH_STYLE_LINES);
+
+  StyleRun search[BENCH_RUNS];
+  StyleRun cached[BENCH_RUNS];
+  double searchFrame[BENCH_RUNS], cachedFrame[BENCH_RUNS], searchRead[BENCH_RUNS], cachedRead[BENCH_RUNS];
+  double change[BENCH_RUNS]; // of the time per frame, in % of each pair of runs
+  for (int i = 0; i < BENCH_RUNS; i++)
+  {
+    search[i] = runScenes(false);
+    cached[i] = runScenes(true);
+    searchFrame[i] = search[i].renderNs / search[i].frames;
+    cachedFrame[i] = cached[i].renderNs / cached[i].frames;
+    searchRead[i] = search[i].readNs / search[i].reads;
+    cachedRead[i] = cached[i].readNs / cached[i].reads;
+    change[i] = 100 * cachedFrame[i] / searchFrame[i] - 100;
+  }
+  double searchNs = benchMedian(searchFrame, BENCH_RUNS);
+  double cachedNs = benchMedian(cachedFrame, BENCH_RUNS);
+  double searchReadNs = benchMedian(searchRead, BENCH_RUNS);
+  double cachedReadNs = benchMedian(cachedRead, BENCH_RUNS);
+  benchMedian(change, BENCH_RUNS); // sorted for the range
+
+  const lv_obj_style_cache_stats_t &stats = cached[0].render;
+  uint32_t lookups = stats.hits + stats.misses + stats.bypasses;
+  // The ESP32's style values and pointers are 4 bytes, the host's 8
+  double esp32Size = stats.size - stats.slots * _LV_STYLE_NUM_BUILT_IN_PROPS * (sizeof(lv_style_value_t) - 4.0) -
+                     stats.objects * LV_STYLE_CACHE_PARTS * (sizeof(void *) - 4.0);
+  printf("bench:   %d scenes x %d frames at %dx%d, %d-line strips, medians of %d runs\n", cached[0].scenes, BENCH_FRAMES,
+         BENCH_WIDTH, BENCH_HEIGHT, BENCH_STYLE_LINES, BENCH_RUNS);
+  printf("         styles searched %.3f ms per frame, cached %.3f ms (%+.1f%%, %+.1f%% to %+.1f%% in pairs of runs)\n",
+         searchNs / 1e6, cachedNs / 1e6, 100 * cachedNs / searchNs - 100, change[0], change[BENCH_RUNS - 1]);
+  printf("         %u property reads per frame, %.1f%% hits, %.1f%% inherited from a parent, %u evictions\n",
+         lookups / cached[0].frames, 100.0 * stats.hits / lookups, 100.0 * stats.bypasses / lookups, stats.evictions);
+  printf("         every property of every object: searched %.1f ns per read, cached %.1f ns (%.1fx)\n", searchReadNs,
+         cachedReadNs, searchReadNs / cachedReadNs);
+  printf("         %.1f slots of %d per object read, %.0f bytes per object here, about %.0f on the ESP32\n",
+         (double)stats.slots / stats.objects, LV_STYLE_CACHE_PARTS, (double)stats.size / stats.objects,
+         esp32Size / stats.objects);
+  return 0;
+}
+
+#else
+
+int simBenchStyles()
+{
+  printf("bench:   skipped, LVGL is built without LV_USE_STYLE_CACHE; set it in lv_conf.h to compare\n");
+  return 0;
+}
+
+#endif
@@ -0,0 +1,145 @@
+// Heap accounting for the simulator. The native build links with
+// -Wl,--wrap=malloc,--wrap=free,--wrap=calloc,--wrap=realloc so every
+// allocation made by the app, LVGL and ArduinoJson passes through here.
+
+#include "sim.h"
+
+#include <atomic>
+#include <malloc.h>
+#include <new>
+
+extern "C"
+{
+  void *__real_malloc(size_t size);
+  void __real_free(void *ptr);
+  void *__real_calloc(size_t count, size_t size);
+  void *__real_realloc(void *ptr, size_t size);
+}
+
+static std::atomic<size_t> heapCurrent(0);
+static std::atomic<size_t> heapPeak(0);
+static std::atomic<size_t> heapAllocations(0);
+
+static std::atomic<size_t> watchedAllocations(0);
+static thread_local bool watched;
+static thread_local int paused;
+
+static void account(size_t added, size_t removed)
+{
+  if (added != 0 && watched && paused == 0)
+    watchedAllocations++;
+  size_t current = heapCurrent.fetch_add(added) + added;
+  heapCurrent.fetch_sub(removed);
+  size_t peak = heapPeak.load();
+  while (current > peak && !heapPeak.compare_exchange_weak(peak, current))
+    ;
+}
+
+extern "C"
+{
+  void *__wrap_malloc(size_t size)
+  {
+    void *ptr = __real_malloc(size);
+    if (ptr != NULL)
+    {
+      heapAllocations++;
+      account(malloc_usable_size(ptr), 0);
+    }
+    return ptr;
+  }
+
+  void __wrap_free(void *ptr)
+  {
+    if (ptr != NULL)
+      account(0, malloc_usable_size(ptr));
+    __real_free(ptr);
+  }
+
+  void *__wrap_calloc(size_t count, size_t size)
+  {
+    void *ptr = __real_calloc(count, size);
+    if (ptr != NULL)
+    {
+      heapAllocations++;
+      account(malloc_usable_size(ptr), 0);
+    }
+    return ptr;
+  }
+
+  void *__wrap_realloc(void *ptr, size_t size)
+  {
+    size_t before = ptr != NULL ? malloc_usable_size(ptr) : 0;
+    void *moved = __real_realloc(ptr, size);
+    if (moved != NULL || size == 0)
+    {
+      heapAllocations++;
+      account(moved != NULL ? malloc_usable_size(moved) : 0, before);
+    }
+    return moved;
+  }
+}
+
+// libstdc++ calls the unwrapped malloc, so route new and delete through the wrappers
+void *operator new(size_t size)
+{
+  void *ptr = __wrap_malloc(size != 0 ? size : 1);
+  if (ptr == NULL)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+  __wrap_free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+  __wrap_free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+  __wrap_free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+  __wrap_free(ptr);
+}
+
+SimHeapStats simHeap()
+{
+  SimHeapStats stats = {heapCurrent.load(), heapPeak.load(), heapAllocations.load()};
+  return stats;
+}
+
+void simHeapResetPeak()
+{
+  heapPeak.store(heapCurrent.load());
+}
+
+void simHeapWatchThread()
+{
+  watched = true;
+}
+
+size_t simHeapWatchedAllocations()
+{
+  return watchedAllocations.load();
+}
+
+SimHeapPause::SimHeapPause()
+{
+  paused++;
+}
+
+SimHeapPause::~SimHeapPause()
+{
+  paused--;
+}
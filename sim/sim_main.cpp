@@ -0,0 +1,371 @@
+#include "sim.h"
+
+#include <Arduino.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "../src/alert_engine.h"
+#include "../src/button_input.h"
+#include "../src/display_driver.h"
+#include "../src/fetch_worker.h"
+#include "../src/idle_scheduler.h"
+#include "../src/price_aggregator.h"
+#include "../src/price_feed.h"
+#include "../src/price_stream.h"
+#include "../src/refresh_scheduler.h"
+#include "../src/touch_input.h"
+#include "../src/wake_state.h"
+#include "../src/ticker_parser.h"
+
+// From main.ino
+void setup();
+void loop();
+extern DisplayDriver displayDriver;
+extern FetchWorker fetchWorker;
+extern RefreshScheduler refreshScheduler;
+extern CoinStore coinStore;
+extern PriceAggregator priceAggregator;
+extern AlertEngine alertEngine;
+extern PriceStream priceStream;
+extern PriceCoalescer priceFeed;
+extern FeedStats feedStats;
+extern BootTimeline bootTimeline;
+extern TouchInput touchInput;
+extern ButtonInput buttonInput;
+extern IdleScheduler idleScheduler;
+extern WakeState wakeState;
+void enterSleepMode();
+
+#define SWIPE_MS 200 // finger down to finger up
+#define SCRIPT_STEP_MS 5
+#define BUTTON_PIN 0     // BUTTON_1
+#define PRESS_MS 80      // a short press
+#define HOLD_MS 1400     // a long one, with a few repeats
+#define LONG_PRESS_EVERY 4
+
+static std::atomic<bool> sleepDue(false);
+static std::atomic<bool> scriptDone(false);
+
+static std::vector<uint32_t> frameUs; // loop() iterations that rendered a frame
+static SimHeapStats setupHeap;
+static uint32_t setupUs;
+
+static void usage(const char *name)
+{
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "  --duration MS   run this long (default %u)\n"
+          "  --refresh MS    request prices this often, 0 = app period (default %u)\n"
+          "  --swipe MS      swipe to the next tile this often, 0 = never (default %u)\n"
+          "  --press MS      press the button this often, every 4th time long, 0 = never\n"
+          "  --seed N        random walk seed of the mock ticker (default %u)\n"
+          "  --chunked       send responses with chunked transfer encoding\n"
+          "  --payload FILE  serve a recorded ticker response instead of the mock\n"
+          "  --rate-limit N  answer 429 after N ticker requests a minute\n"
+          "  --fail-every N  fail every Nth ticker request with a 503\n"
+          "  --slow-ms MS    answer ticker requests this late\n"
+          "  --consensus     ask every price source each time, not just the best one\n"
+          "  --stream-rate N send N stream messages per second (default %u)\n"
+          "  --stream-drop MS drop the stream after this long, 0 = never (default 0)\n"
+          "  --frames FILE   replay recorded stream messages, one per line\n"
+          "  --no-stream     refuse stream connections, so the app polls\n"
+          "  --expect-no-allocs exit with 1 if the fetch task allocates after its first request\n"
+          "  --bench-parse   compare parsing ticker responses whole and streamed, then exit\n"
+          "  --bench-prices  check and time price parsing and formatting, then exit\n"
+          "  --bench-alerts  check and time the alert engine with thousands of rules, then exit\n"
+          "  --bench-styles  time LVGL's benchmark scenes with and without the style cache, then exit\n"
+          "  --bench-meter   time needle moves with and without the meter's cached scale, then exit\n"
+          "  --bench-lines   time skewed lines drawn with masks and from the pixels' distance, then exit\n"
+          "  --bench-circles time rounded screens with and without the LRU cache of circles, then exit\n"
+          "  --sleep MS      enter deep sleep after this long, 0 = never (default 0)\n"
+          "  --resume FILE   wake from the RTC memory saved there by an earlier --sleep\n"
+          "  --dump FILE     write the last frame as a PPM image\n"
+          "  -v              show the app's serial output\n",
+          name, simOptions.durationMs, simOptions.refreshMs, simOptions.swipeMs, simOptions.seed,
+          simOptions.streamRate);
+}
+
+static bool parseOptions(int argc, char **argv)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+    if (strcmp(arg, "-v") == 0)
+      simOptions.verbose = true;
+    else if (strcmp(arg, "--chunked") == 0)
+      simOptions.chunked = true;
+    else if (strcmp(arg, "--no-stream") == 0)
+      simOptions.stream = false;
+    else if (strcmp(arg, "--expect-no-allocs") == 0)
+      simOptions.expectNoAllocs = true;
+    else if (strcmp(arg, "--consensus") == 0)
+      simOptions.consensus = true;
+    else if (strcmp(arg, "--bench-parse") == 0)
+      simOptions.benchParse = true;
+    else if (strcmp(arg, "--bench-prices") == 0)
+      simOptions.benchPrices = true;
+    else if (strcmp(arg, "--bench-alerts") == 0)
+      simOptions.benchAlerts = true;
+    else if (strcmp(arg, "--bench-styles") == 0)
+      simOptions.benchStyles = true;
+    else if (strcmp(arg, "--bench-meter") == 0)
+      simOptions.benchMeter = true;
+    else if (strcmp(arg, "--bench-lines") == 0)
+      simOptions.benchLines = true;
+    else if (strcmp(arg, "--bench-circles") == 0)
+      simOptions.benchCircles = true;
+    else if (value == NULL)
+      return false;
+    else if (strcmp(arg, "--duration") == 0)
+      simOptions.durationMs = strtoul(argv[++i], NULL, 10);
+    else if (strcmp(arg, "--refresh") == 0)
+      simOptions.refreshMs = strtoul(argv[++i], NULL, 10);
+    else if (strcmp(arg, "--swipe") == 0)
+      simOptions.swipeMs = strtoul(argv[++i], NULL, 10);
+    else if (strcmp(arg, "--rate-limit") == 0)
+      simOptions.rateLimit = strtoul(argv[++i], NULL, 10);
+    else if (strcmp(arg, "--fail-every") == 0)
+      simOptions.failEvery = strtoul(argv[++i], NULL, 10);
+    else if (strcmp(arg, "--slow-ms") == 0)
+      simOptions.slowMs = strtoul(argv[++i], NULL, 10);
+    else if (strcmp(arg, "--press") == 0)
+      simOptions.pressMs = strtoul(argv[++i], NULL, 10);
+    else if (strcmp(arg, "--seed") == 0)
+      simOptions.seed = strtoul(argv[++i], NULL, 10);
+    else if (strcmp(arg, "--payload") == 0)
+      simOptions.payloadPath = argv[++i];
+    else if (strcmp(arg, "--stream-rate") == 0)
+      simOptions.streamRate = strtoul(argv[++i], NULL, 10);
+    else if (strcmp(arg, "--stream-drop") == 0)
+      simOptions.streamDropMs = strtoul(argv[++i], NULL, 10);
+    else if (strcmp(arg, "--sleep") == 0)
+      simOptions.sleepMs = strtoul(argv[++i], NULL, 10);
+    else if (strcmp(arg, "--resume") == 0)
+      simOptions.resumePath = argv[++i];
+    else if (strcmp(arg, "--frames") == 0)
+      simOptions.framesPath = argv[++i];
+    else if (strcmp(arg, "--dump") == 0)
+      simOptions.dumpPath = argv[++i];
+    else
+      return false;
+  }
+  return true;
+}
+
+// A right-to-left drag across the middle of the screen every swipeMs
+static void scriptTouch(uint32_t now)
+{
+  if (simOptions.swipeMs == 0)
+    return;
+  uint32_t phase = now % simOptions.swipeMs;
+  if (now < simOptions.swipeMs || phase >= SWIPE_MS)
+  {
+    uint16_t x, y;
+    if (simTouch(&x, &y))
+      simSetTouch(false, x, y, Slide_Left); // the controller recognizes the swipe on release
+    return;
+  }
+  simSetTouch(true, 200 - phase * 160 / SWIPE_MS, 120);
+}
+
+// Presses of the first button, with a few ms of contact bounce on both edges
+static void scriptButton(uint32_t now)
+{
+  static bool down;
+  if (simOptions.pressMs == 0 || now < simOptions.pressMs)
+    return;
+  uint32_t press = now / simOptions.pressMs;
+  uint32_t hold = press % LONG_PRESS_EVERY == 0 ? HOLD_MS : PRESS_MS;
+  bool pressed = now % simOptions.pressMs < min(hold, simOptions.pressMs / 2);
+  if (pressed == down)
+    return;
+  down = pressed;
+  int level = pressed ? LOW : HIGH;
+  simSetPin(BUTTON_PIN, level);
+  delay(1);
+  simSetPin(BUTTON_PIN, !level);
+  delay(1);
+  simSetPin(BUTTON_PIN, level);
+}
+
+// Drives touch, buttons, refresh requests and the sleep trigger in real time, the
+// way the hardware would, while loop() sleeps between timers
+static void runScript()
+{
+  uint32_t lastRefresh = millis();
+  while (!scriptDone)
+  {
+    uint32_t now = millis();
+    if (simOptions.sleepMs != 0 && now >= simOptions.sleepMs && !sleepDue)
+    {
+      sleepDue = true;
+      idleScheduler.wake();
+    }
+    scriptTouch(now);
+    scriptButton(now);
+    if (simOptions.refreshMs != 0 && now - lastRefresh >= simOptions.refreshMs)
+    {
+      refreshScheduler.requestNow();
+      fetchWorker.requestRefresh();
+      lastRefresh = now;
+    }
+    delay(SCRIPT_STEP_MS);
+  }
+}
+
+static void writeDump(const char *path)
+{
+  int width, height;
+  const uint16_t *pixels = simFramebuffer(&width, &height);
+  FILE *file = fopen(path, "wb");
+  if (file == NULL)
+    return;
+  fprintf(file, "P6\n%d %d\n255\n", width, height);
+  for (int i = 0; i < width * height; i++)
+  {
+    uint16_t c = pixels[i];
+    uint8_t rgb[3] = {(uint8_t)((c >> 11) * 255 / 31), (uint8_t)((c >> 5 & 0x3F) * 255 / 63), (uint8_t)((c & 0x1F) * 255 / 31)};
+    fwrite(rgb, 1, sizeof(rgb), file);
+  }
+  fclose(file);
+}
+
+static uint32_t percentile(std::vector<uint32_t> samples, int percent)
+{
+  if (samples.empty())
+    return 0;
+  std::sort(samples.begin(), samples.end());
+  return samples[(samples.size() - 1) * percent / 100];
+}
+
+void simFinish(const char *reason)
+{
+  scriptDone = true;
+  fetchWorker.end();
+  SimHeapStats heap = simHeap();
+  if (simOptions.dumpPath != NULL)
+    writeDump(simOptions.dumpPath);
+
+  uint64_t total = 0;
+  for (size_t i = 0; i < frameUs.size(); i++)
+    total += frameUs[i];
+  const DisplayStats &display = displayDriver.stats();
+
+  printf("Stopped by %s after %u ms\n", reason, millis());
+  printf("setup:   %u us, heap peak %zu bytes\n", setupUs, setupHeap.peak);
+  printf("boot:    %s; display %u ms, first frame %u ms, WiFi %u ms, fresh data %u ms\n",
+         wakeState.warm() ? "warm" : "cold", bootTimeline.ms(BOOT_DISPLAY), bootTimeline.ms(BOOT_FIRST_FRAME),
+         bootTimeline.ms(BOOT_WIFI), bootTimeline.ms(BOOT_FRESH_DATA));
+  printf("frames:  %zu, avg %u us, p50 %u us, p95 %u us, max %u us\n", frameUs.size(),
+         (unsigned)(frameUs.empty() ? 0 : total / frameUs.size()), percentile(frameUs, 50),
+         percentile(frameUs, 95), percentile(frameUs, 100));
+  printf("display: %u-line strips, %u flushes, %u px, %u ms rendering\n", displayDriver.stripLines(),
+         display.flushes, display.pixels, display.renderMs);
+  const TickerParseTimings &parseTimings = priceAggregator.parseTimings();
+  const TickerParseStats &tickerStats = priceAggregator.lastParse();
+  printf("parse:   %u responses, avg %u us, max %u us; last %zu tickers, %zu bytes, peak document %zu bytes\n",
+         parseTimings.parses, parseTimings.parses ? parseTimings.totalUs / parseTimings.parses : 0,
+         parseTimings.maxUs, tickerStats.count, tickerStats.bytesRead, tickerStats.peakDocUsage);
+  printf("sources: %s mode, %u coins divergent\n", simOptions.consensus ? "consensus" : "failover",
+         priceAggregator.divergent());
+  for (int i = 0; i < priceAggregator.count(); i++)
+  {
+    const SourceStats &source = priceAggregator.stats(i);
+    printf("         %s%s: %u requests, %u failures, %u rate limited, %u quotes, error %u permille, "
+           "latency p50 %u ms, p95 %u ms\n",
+           priceAggregator.name(i), i == priceAggregator.primary() ? " (primary)" : "", source.requests,
+           source.failures, source.rateLimited, source.quotes, source.errorPermille, source.latency.percentile(50),
+           source.latency.percentile(95));
+  }
+  SimStreamStats sent = simStreamStats();
+  const StreamStats &stream = priceStream.stats();
+  printf("stream:  %u connections, %u drops; sent %u messages (%u fragmented, %u pings, %u pongs), "
+         "max burst %u\n",
+         stream.connects, stream.drops, sent.messages, sent.fragmented, sent.pings, sent.pongs, sent.maxBurst);
+  printf("         received %u messages, %u bytes, %u parse errors; parse avg %u us, max %u us\n",
+         stream.messages, stream.bytesRead, stream.parseErrors,
+         stream.parse.parses ? stream.parse.totalUs / stream.parse.parses : 0, stream.parse.maxUs);
+  printf("feed:    %u price updates, %u snapshots published, %u applied with %u coin updates\n",
+         priceFeed.updates(), priceFeed.publishes(), feedStats.snapshots, feedStats.coinUpdates);
+  const AlertStats &alerts = alertEngine.stats();
+  printf("alerts:  %d rules, %u ticks, %u rule checks, %u fired\n", alertEngine.count(), alerts.ticks,
+         alerts.evaluated, alerts.fired);
+  const TouchStats &touch = touchInput.stats();
+  printf("touch:   %u interrupts, %u I2C reads, %u samples (%u dropped), %u gestures\n",
+         touch.interrupts, touch.reads, touch.samples, touch.dropped, touch.gestures);
+  const RefreshStats &refresh = refreshScheduler.stats();
+  printf("refresh: %u requests (%u symbols, %u in the last hour), %u failures, %u rate limited, last backoff %u ms\n",
+         refresh.requests, refresh.symbolsRequested, refreshScheduler.requestsLastHour(millis()), refresh.failures,
+         refresh.rateLimited, refresh.backoffMs);
+  printf("         ");
+  for (int i = 0; i < coinStore.count; i++)
+    printf("%s every %u s, max age %u ms%s", coinStore.symbol[i], refreshScheduler.interval(i) / 1000,
+           refreshScheduler.maxAgeMs(i), i + 1 < coinStore.count ? "; " : "\n");
+  const ButtonStats &buttons = buttonInput.stats();
+  printf("buttons: %u edges (%u bounces, %u dropped), %u keys (%u long presses, %u repeats)\n",
+         buttons.edges, buttons.bounces, buttons.dropped, buttons.keys, buttons.longPresses, buttons.repeats);
+  const IdleStats &idle = idleScheduler.stats();
+  uint64_t loopUs = idle.busyUs + idle.idleUs;
+  printf("idle:    %u wakeups (%.1f/s, %u by events), UI loop busy %.1f%% of the time\n", idle.wakeups,
+         idle.wakeups * 1000.0 / (millis() - setupUs / 1000), idle.eventWakeups,
+         loopUs ? idle.busyUs * 100.0 / loopUs : 0.0);
+  printf("heap:    %zu bytes in use, peak %zu bytes after setup, %zu allocations\n",
+         heap.current, heap.peak, heap.allocations);
+  size_t fetchAllocs = simHeapWatchedAllocations();
+  size_t steadyAllocs = fetchAllocs - std::min(fetchAllocs, simWarmAllocations());
+  printf("         fetch task: %zu allocations, %zu after its first request\n", fetchAllocs, steadyAllocs);
+  fflush(stdout);
+  exit(simOptions.expectNoAllocs && steadyAllocs != 0 ? 1 : 0);
+}
+
+int main(int argc, char **argv)
+{
+  if (!parseOptions(argc, argv))
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  if (simOptions.benchParse)
+    return simBenchParse();
+  if (simOptions.benchPrices)
+    return simBenchPrices();
+  if (simOptions.benchAlerts)
+    return simBenchAlerts();
+  if (simOptions.benchStyles)
+    return simBenchStyles();
+  if (simOptions.benchMeter)
+    return simBenchMeter();
+  if (simOptions.benchLines)
+    return simBenchLines();
+  if (simOptions.benchCircles)
+    return simBenchCircles();
+  if (simOptions.resumePath != NULL)
+    simRtcLoad(simOptions.resumePath);
+
+  priceAggregator.setConsensus(simOptions.consensus); // setup() only ever turns it on
+  uint32_t start = micros();
+  setup();
+  setupUs = micros() - start;
+  setupHeap = simHeap();
+  simHeapResetPeak();
+
+  std::thread script(runScript);
+  script.detach();
+  while (millis() < simOptions.durationMs)
+  {
+    if (sleepDue)
+      enterSleepMode();
+
+    uint32_t frames = displayDriver.stats().frames;
+    uint64_t slept = simSleptUs();
+    uint32_t loopStart = micros();
+    loop();
+    uint32_t busy = micros() - loopStart - (uint32_t)(simSleptUs() - slept); // without loop()'s idle wait
+    if (displayDriver.stats().frames != frames)
+      frameUs.push_back(busy);
+  }
+  simFinish("duration");
+}
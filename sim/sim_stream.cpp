@@ -0,0 +1,228 @@
+// WebSocket stand-in for the price stream. It answers the upgrade request
+// and then sends miniTicker messages at simOptions.streamRate per second,
+// either generated for the subscribed symbols or replayed from a file of
+// recorded messages. Every so often it fragments a message, interleaves a
+// ping or sends a binary frame, so the client's framing is exercised too.
+
+#include "sim.h"
+
+#include <Arduino.h>
+#include <atomic>
+#include <fstream>
+#include <math.h>
+#include <vector>
+
+#define STREAM_PORT 9443
+#define STREAM_PING_EVERY 200   // messages
+#define STREAM_SPLIT_EVERY 37   // messages sent as three fragments
+#define STREAM_BINARY_EVERY 501 // messages followed by a binary frame
+#define STREAM_MAX_BURST 5000   // messages added by one poll, bounds memory if the client stalls
+
+static std::atomic<uint32_t> connections(0), messages(0), fragmented(0), pings(0), pongs(0), maxBurst(0);
+
+SimStreamStats simStreamStats()
+{
+  SimStreamStats stats = {connections, messages, fragmented, pings, pongs, maxBurst};
+  return stats;
+}
+
+static void appendFrame(std::string &rx, uint8_t opcode, bool fin, const char *payload, size_t length)
+{
+  rx += (char)((fin ? 0x80 : 0x00) | opcode);
+  if (length < 126)
+  {
+    rx += (char)length;
+  }
+  else if (length < 0x10000)
+  {
+    rx += (char)126;
+    rx += (char)(length >> 8);
+    rx += (char)length;
+  }
+  else
+  {
+    rx += (char)127;
+    for (int shift = 56; shift >= 0; shift -= 8)
+      rx += (char)((uint64_t)length >> shift);
+  }
+  rx.append(payload, length);
+}
+
+static std::vector<std::string> loadFrames(const char *path)
+{
+  std::vector<std::string> frames;
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line))
+  {
+    if (!line.empty())
+      frames.push_back(line);
+  }
+  return frames;
+}
+
+class StreamPeer : public SimPeer
+{
+public:
+  void onWrite(const uint8_t *data, size_t length)
+  {
+    _request.append((const char *)data, length);
+    if (!_upgraded)
+    {
+      size_t end = _request.find("\r\n\r\n");
+      if (end != std::string::npos)
+        upgrade(_request.substr(0, end));
+      return;
+    }
+    readClientFrames();
+  }
+
+  bool poll(std::string &rx)
+  {
+    if (!_reply.empty())
+    {
+      rx += _reply;
+      _reply.clear();
+    }
+    if (_closed)
+      return false;
+    if (!_upgraded)
+      return true;
+
+    uint32_t elapsed = millis() - _start;
+    if (simOptions.streamDropMs != 0 && elapsed >= simOptions.streamDropMs)
+      return false; // connection lost without a close frame
+    uint64_t due = (uint64_t)elapsed * simOptions.streamRate / 1000;
+    uint32_t burst = 0;
+    while (_sent < due && burst < STREAM_MAX_BURST)
+    {
+      sendMessage(rx);
+      burst++;
+    }
+    if (burst > maxBurst)
+      maxBurst = burst;
+    return true;
+  }
+
+private:
+  void upgrade(const std::string &request)
+  {
+    _request.clear();
+    size_t path = request.find("streams=");
+    if (request.compare(0, 4, "GET ") != 0 || request.find("Upgrade: websocket") == std::string::npos ||
+        path == std::string::npos)
+    {
+      _reply = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n";
+      _closed = true;
+      return;
+    }
+    // streams=btcusdt@miniTicker/ethusdt@miniTicker HTTP/1.1
+    std::string list = request.substr(path + 8, request.find(' ', path) - path - 8);
+    for (size_t start = 0; start < list.size();)
+    {
+      size_t end = list.find('/', start);
+      if (end == std::string::npos)
+        end = list.size();
+      std::string name = list.substr(start, end - start);
+      _streams.push_back(name);
+      std::string symbol = name.substr(0, name.find('@'));
+      for (size_t i = 0; i < symbol.size(); i++)
+        symbol[i] = toupper(symbol[i]);
+      _symbols.push_back(symbol);
+      start = end + 1;
+    }
+    if (simOptions.framesPath != NULL)
+      _frames = loadFrames(simOptions.framesPath);
+
+    _reply = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+             "Sec-WebSocket-Accept: c2ltdWxhdGVkLWFjY2VwdA==\r\n\r\n";
+    _upgraded = true;
+    _start = millis();
+    connections++;
+  }
+
+  // Masked client frames: pongs and close
+  void readClientFrames()
+  {
+    while (_request.size() >= 6)
+    {
+      uint8_t opcode = _request[0] & 0x0F;
+      size_t length = _request[1] & 0x7F; // control frames only, always short
+      if (_request.size() < 6 + length)
+        return;
+      if (opcode == 0xA)
+        pongs++;
+      else if (opcode == 0x8)
+        _closed = true;
+      _request.erase(0, 6 + length);
+    }
+  }
+
+  void sendMessage(std::string &rx)
+  {
+    std::string text = _frames.empty() ? generate() : _frames[_sent % _frames.size()];
+    _sent++;
+    messages++;
+
+    if (_sent % STREAM_PING_EVERY == 0)
+    {
+      appendFrame(rx, 0x9, true, "sim", 3);
+      pings++;
+    }
+    if (_sent % STREAM_SPLIT_EVERY == 0 && text.size() >= 3)
+    {
+      size_t third = text.size() / 3;
+      appendFrame(rx, 0x1, false, text.data(), third);
+      appendFrame(rx, 0x9, true, "mid", 3); // control frames may come between fragments
+      pings++;
+      appendFrame(rx, 0x0, false, text.data() + third, third);
+      appendFrame(rx, 0x0, true, text.data() + 2 * third, text.size() - 2 * third);
+      fragmented++;
+    }
+    else
+    {
+      appendFrame(rx, 0x1, true, text.data(), text.size());
+    }
+    if (_sent % STREAM_BINARY_EVERY == 0)
+      appendFrame(rx, 0x2, true, "\x01\x02\x03", 3);
+  }
+
+  // Prices swing within +-3% of the open, so the change stays on the gauge
+  std::string generate()
+  {
+    if (_symbols.empty())
+      return "{}";
+    size_t index = _sent % _symbols.size();
+    const std::string &symbol = _symbols[index];
+    double open = simTickPrice(0.5 + (simOptions.seed * 7919u + index * 104729u) % 6000000 / 100.0);
+    double t = (millis() - _start) / 1000.0;
+    double last = simTickPrice(open * (1.0 + 0.03 * sin(t * 0.7 + index) * cos(t * 0.13 * (index + 1))));
+
+    char text[320];
+    snprintf(text, sizeof(text),
+             "{\"stream\":\"%s\",\"data\":{\"e\":\"24hrMiniTicker\",\"E\":%u,\"s\":\"%s\","
+             "\"c\":\"%.8f\",\"o\":\"%.8f\",\"h\":\"%.8f\",\"l\":\"%.8f\",\"v\":\"12345.67800000\","
+             "\"q\":\"%.8f\"}}",
+             _streams[index].c_str(), (unsigned)millis(), symbol.c_str(), last, open,
+             open * 1.03, open * 0.97, open * 12345.678);
+    return text;
+  }
+
+  std::string _request; // from the client, not yet handled
+  std::string _reply;   // to the client, not yet polled
+  bool _upgraded = false;
+  bool _closed = false;
+  uint32_t _start = 0;
+  uint64_t _sent = 0;
+  std::vector<std::string> _streams; // "btcusdt@miniTicker"
+  std::vector<std::string> _symbols; // "BTCUSDT"
+  std::vector<std::string> _frames;
+};
+
+SimPeer *simConnect(const char *host, uint16_t port, bool *refused)
+{
+  if (port != STREAM_PORT && strstr(host, "stream") == NULL)
+    return simTickerPeer(host);
+  *refused = !simOptions.stream;
+  return simOptions.stream ? new StreamPeer() : NULL;
+}
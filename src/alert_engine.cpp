@@ -0,0 +1,334 @@
+#include "alert_engine.h"
+
+#include <Preferences.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALERT_NAMESPACE "alerts"
+#define ALERT_TEXT_MAX 32 // one rule of parse()'s text
+
+uint32_t alertKey(const CoinStore &coins, const char *text)
+{
+  uint32_t h = coins.hash(); // FNV-1a, carried on over the rules
+  for (const char *c = text; *c != '\0'; c++)
+    h = (h ^ (uint8_t)*c) * 16777619u;
+  return h;
+}
+
+void AlertEngine::begin(FireFn onFire)
+{
+  _onFire = onFire;
+  clear();
+}
+
+void AlertEngine::clear()
+{
+  _count = 0;
+  _slots = 0;
+  memset(_slot, -1, sizeof(_slot));
+  reindex();
+  _dirty = true;
+}
+
+static bool validRule(const AlertRule &rule)
+{
+  if (rule.coin >= MAX_COINS)
+    return false;
+  switch (rule.type)
+  {
+  case ALERT_ABOVE:
+  case ALERT_BELOW:
+    return rule.value > 0;
+  case ALERT_MOVE:
+    return rule.value > 0 && rule.periods >= 1 && rule.periods <= ALERT_WINDOW_MAX;
+  case ALERT_MA_CROSS:
+    return rule.periods >= 2 && rule.periods <= ALERT_WINDOW_MAX;
+  }
+  return false;
+}
+
+bool AlertEngine::add(const AlertRule &rule)
+{
+  if (_count == ALERT_MAX_RULES || !validRule(rule))
+    return false;
+  bool series = rule.type == ALERT_MOVE || rule.type == ALERT_MA_CROSS;
+  if (series && _slot[rule.coin] < 0)
+  {
+    if (_slots == ALERT_SERIES_COINS)
+      return false;
+    _series[_slots].period = 0;
+    _slot[rule.coin] = _slots++;
+  }
+
+  // After the coin's other rules, so the table stays sorted by coin
+  int at = _first[rule.coin + 1];
+  memmove(&_rules[at + 1], &_rules[at], (_count - at) * sizeof(AlertRule));
+  _rules[at] = rule;
+  _count++;
+  reindex();
+  _dirty = true;
+  return true;
+}
+
+void AlertEngine::reindex()
+{
+  int i = 0;
+  for (int coin = 0; coin <= MAX_COINS; coin++)
+  {
+    while (i < _count && _rules[i].coin < coin)
+      i++;
+    _first[coin] = i;
+  }
+}
+
+int AlertEngine::parse(const CoinStore &coins, const char *text)
+{
+  int added = 0;
+  while (*text != '\0')
+  {
+    size_t len = strcspn(text, ",");
+    char item[ALERT_TEXT_MAX];
+    if (len >= sizeof(item))
+      return -1;
+    memcpy(item, text, len);
+    item[len] = '\0';
+    text += len + (text[len] == ',' ? 1 : 0);
+
+    char *op = item + strcspn(item, "<>%^");
+    char kind = *op;
+    if (kind == '\0')
+      return -1;
+    *op++ = '\0';
+    AlertRule rule = {};
+    int coin = coins.find(item);
+    if (coin < 0)
+      return -1;
+    rule.coin = coin;
+    if (kind == '>' || kind == '<')
+    {
+      rule.type = kind == '>' ? ALERT_ABOVE : ALERT_BELOW;
+      if (!parsePrice(op, &rule.value))
+        return -1;
+    }
+    else if (kind == '%')
+    {
+      char *slash = strchr(op, '/'); // "5/60": 5% within 60 minutes
+      int32_t bp;
+      if (slash == NULL)
+        return -1;
+      *slash = '\0';
+      if (!parseChangeBp(op, &bp))
+        return -1;
+      rule.type = ALERT_MOVE;
+      rule.value = bp;
+      rule.periods = atoi(slash + 1);
+    }
+    else
+    {
+      rule.type = ALERT_MA_CROSS;
+      rule.periods = atoi(op);
+    }
+    if (!add(rule))
+      return -1;
+    added++;
+  }
+  return added;
+}
+
+static inline uint8_t before(uint8_t i, int n)
+{
+  return (i + AlertEngine::SERIES_LEN - n) % AlertEngine::SERIES_LEN;
+}
+
+void AlertEngine::push(Series &series, price_fx_t close)
+{
+  uint8_t prev = series.head;
+  series.head = (series.head + 1) % SERIES_LEN;
+  series.sum[series.head] = series.sum[prev] + (uint64_t)close;
+  if (series.filled < SERIES_LEN - 1)
+    series.filled++;
+}
+
+// The price so far is the close of the current period. A new period repeats
+// the last close through any periods without ticks; a gap longer than the
+// series starts it over.
+void AlertEngine::advance(Series &series, price_fx_t price, uint32_t period)
+{
+  int32_t elapsed = (int32_t)(period - series.period);
+  if (series.period == 0 || elapsed > ALERT_WINDOW_MAX)
+  {
+    series.sum[0] = 0;
+    series.head = 0;
+    series.filled = 0;
+    push(series, price);
+    series.period = period;
+  }
+  else if (elapsed <= 0)
+  {
+    series.sum[series.head] = series.sum[before(series.head, 1)] + (uint64_t)price;
+  }
+  else
+  {
+    for (int32_t i = 1; i < elapsed; i++)
+      push(series, series.last);
+    push(series, price);
+    series.period = period;
+  }
+  series.last = price;
+}
+
+price_fx_t AlertEngine::close(const Series &series, int ago) const
+{
+  uint8_t i = before(series.head, ago);
+  return (price_fx_t)(series.sum[i] - series.sum[before(i, 1)]);
+}
+
+price_fx_t AlertEngine::average(const Series &series, int periods) const
+{
+  uint64_t total = series.sum[series.head] - series.sum[before(series.head, periods)];
+  return (price_fx_t)total / periods;
+}
+
+// True when the rule fires on this price
+bool AlertEngine::evaluate(AlertRule &rule, const Series *series, price_fx_t price, price_fx_t *reference)
+{
+  bool hit;
+  bool rearm;
+  switch (rule.type)
+  {
+  case ALERT_ABOVE:
+  case ALERT_BELOW:
+  {
+    price_fx_t margin = rule.value / 10000 * ALERT_HYSTERESIS_BP;
+    *reference = rule.value;
+    hit = rule.type == ALERT_ABOVE ? price >= rule.value : price <= rule.value;
+    rearm = rule.type == ALERT_ABOVE ? price < rule.value - margin : price > rule.value + margin;
+    break;
+  }
+  case ALERT_MOVE:
+  {
+    if (series->filled <= rule.periods)
+      return false; // not that much history yet
+    *reference = close(*series, rule.periods);
+    int32_t bp = abs(changeBpFromPrices(price, *reference));
+    hit = bp >= rule.value;
+    rearm = bp < rule.value - ALERT_HYSTERESIS_BP;
+    break;
+  }
+  default: // ALERT_MA_CROSS
+  {
+    if (series->filled < rule.periods)
+      return false;
+    *reference = average(*series, rule.periods);
+    price_fx_t margin = *reference / 10000 * ALERT_HYSTERESIS_BP;
+    uint8_t side;
+    if (price > *reference + margin)
+      side = ALERT_SIDE_KNOWN | ALERT_SIDE_ABOVE;
+    else if (price < *reference - margin)
+      side = ALERT_SIDE_KNOWN;
+    else
+      return false; // too close to tell
+    uint8_t was = rule.state & (ALERT_SIDE_KNOWN | ALERT_SIDE_ABOVE);
+    if (side == was)
+      return false;
+    rule.state = (rule.state & ~was) | side;
+    _dirty = true;
+    return was != 0;
+  }
+  }
+
+  if (!(rule.state & ALERT_FIRED))
+  {
+    if (!hit)
+      return false;
+    rule.state |= ALERT_FIRED;
+    _dirty = true;
+    return true;
+  }
+  if (rearm)
+  {
+    rule.state &= ~ALERT_FIRED;
+    _dirty = true;
+  }
+  return false;
+}
+
+void AlertEngine::onTick(int coin, price_fx_t price, uint32_t unixTime)
+{
+  if (coin < 0 || coin >= MAX_COINS || price <= 0)
+    return;
+  _stats.ticks++;
+  Series *series = NULL;
+  if (_slot[coin] >= 0)
+  {
+    series = &_series[_slot[coin]];
+    advance(*series, price, unixTime / ALERT_PERIOD_S);
+  }
+
+  int end = _first[coin + 1];
+  for (int i = _first[coin]; i < end; i++)
+  {
+    AlertRule &rule = _rules[i];
+    AlertEvent event;
+    _stats.evaluated++;
+    if (!evaluate(rule, series, price, &event.reference))
+      continue;
+    _stats.fired++;
+    event.price = price;
+    event.rule = i;
+    event.coin = coin;
+    event.type = rule.type;
+    event.periods = rule.periods;
+    if (_onFire != NULL)
+      _onFire(event);
+  }
+}
+
+bool AlertEngine::load(uint32_t key)
+{
+  Preferences prefs;
+  if (!prefs.begin(ALERT_NAMESPACE, true))
+    return false;
+  uint16_t count = prefs.getUShort("count", 0);
+  bool ok = prefs.getUInt("key", 0) == key && count <= ALERT_MAX_RULES &&
+            (count == 0 || prefs.getBytes("rules", _rules, count * sizeof(AlertRule)) == count * sizeof(AlertRule));
+  prefs.end();
+
+  // Saved from a valid, sorted table; checked again all the same
+  _count = 0;
+  _slots = 0;
+  memset(_slot, -1, sizeof(_slot));
+  for (int i = 0; ok && i < count; i++)
+  {
+    const AlertRule &rule = _rules[i];
+    ok = validRule(rule) && (i == 0 || rule.coin >= _rules[i - 1].coin);
+    if (ok && (rule.type == ALERT_MOVE || rule.type == ALERT_MA_CROSS) && _slot[rule.coin] < 0)
+    {
+      ok = _slots < ALERT_SERIES_COINS;
+      _series[_slots].period = 0;
+      _slot[rule.coin] = _slots++;
+    }
+  }
+  if (!ok)
+  {
+    clear();
+    return false;
+  }
+  _count = count;
+  reindex();
+  _dirty = false;
+  return true;
+}
+
+bool AlertEngine::save(uint32_t key)
+{
+  Preferences prefs;
+  if (!prefs.begin(ALERT_NAMESPACE, false))
+    return false;
+  size_t size = _count * sizeof(AlertRule);
+  bool ok = (_count == 0 || prefs.putBytes("rules", _rules, size) == size) && prefs.putUShort("count", _count) == 2 &&
+            prefs.putUInt("key", key) == 4;
+  prefs.end();
+  _dirty = !ok;
+  return ok;
+}
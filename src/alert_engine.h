@@ -0,0 +1,122 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "coin_store.h"
+#include "price_record.h"
+
+#ifndef ALERT_MAX_RULES
+#define ALERT_MAX_RULES 64
+#endif
+#define ALERT_SERIES_COINS 8 // coins that can have move or average rules
+#define ALERT_WINDOW_MAX 60  // periods a move window or an average can span
+#define ALERT_PERIOD_S 60    // one period of the series, a minute
+#define ALERT_HYSTERESIS_BP 10 // a fired rule re-arms, an average cross counts, only this far back over the line
+
+enum AlertType
+{
+  ALERT_ABOVE,    // price rises to value
+  ALERT_BELOW,    // price falls to value
+  ALERT_MOVE,     // price moved value bp, either way, within periods
+  ALERT_MA_CROSS, // price crosses its periods-long moving average
+};
+
+#define ALERT_FIRED 0x01      // waiting to re-arm
+#define ALERT_SIDE_KNOWN 0x02 // ALERT_MA_CROSS: which side of the average the price was
+#define ALERT_SIDE_ABOVE 0x04
+
+// One user-defined rule, 16 bytes as persisted. Its state is kept with it,
+// so a level that stays crossed doesn't fire again after a reboot.
+struct AlertRule
+{
+  price_fx_t value; // a price, or bp for ALERT_MOVE
+  uint16_t coin;
+  uint8_t type;    // AlertType
+  uint8_t periods; // ALERT_MOVE, ALERT_MA_CROSS
+  uint8_t state;   // ALERT_FIRED | ALERT_SIDE_*
+  uint8_t reserved[3];
+};
+
+static_assert(sizeof(AlertRule) == 16, "AlertRule is persisted as it is");
+
+struct AlertEvent
+{
+  price_fx_t price;
+  price_fx_t reference; // the level, the price periods ago or the average
+  uint16_t rule;
+  uint16_t coin;
+  uint8_t type;
+  uint8_t periods;
+};
+
+struct AlertStats
+{
+  uint32_t ticks;
+  uint32_t evaluated; // rule checks
+  uint32_t fired;
+};
+
+// Evaluates price alerts on every tick, in time proportional to the rules of
+// the ticking coin only. Rules are kept sorted by coin with an index per
+// coin. Move and average rules read a per-coin ring of prefix sums of the
+// per-minute closing prices: the close n periods ago is the difference of
+// two neighbouring sums, the average over n periods that of two sums n
+// apart, so any window costs the same two reads. Ticks and evaluation run
+// on one task; fired alerts go to a callback on that task.
+uint32_t alertKey(const CoinStore &coins, const char *text); // for load() and save()
+
+class AlertEngine
+{
+public:
+  typedef void (*FireFn)(const AlertEvent &event);
+  static const int SERIES_LEN = ALERT_WINDOW_MAX + 2;
+
+  void begin(FireFn onFire);
+  bool add(const AlertRule &rule); // false when full or the rule is invalid
+  // "BTC>70000,ETH<2000,SOL%5/60,BTC^20": above, below, a 5% move within 60
+  // minutes and a cross of the 20-minute average; returns the rules added,
+  // -1 if a rule didn't parse
+  int parse(const CoinStore &coins, const char *text);
+  void clear();
+
+  void onTick(int coin, price_fx_t price, uint32_t unixTime);
+
+  // The rules and their state in NVS, valid for one rule text and watchlist
+  bool load(uint32_t key);
+  bool save(uint32_t key);
+  bool dirty() const { return _dirty; } // a rule's state changed since load() or save()
+
+  int count() const { return _count; }
+  const AlertRule &rule(int i) const { return _rules[i]; }
+  const AlertStats &stats() const { return _stats; }
+
+private:
+  // Prefix sums of the closes; the oldest entry is the base of the next
+  // one, so filled periods are readable. The sums wrap around, which their
+  // differences don't mind.
+  struct Series
+  {
+    uint64_t sum[SERIES_LEN];
+    uint32_t period; // unix time / ALERT_PERIOD_S of the newest entry, 0 = empty
+    uint8_t head;
+    uint8_t filled; // periods readable, including the current one
+    price_fx_t last;
+  };
+
+  void reindex();
+  static void push(Series &series, price_fx_t close);
+  void advance(Series &series, price_fx_t price, uint32_t period);
+  price_fx_t close(const Series &series, int ago) const;
+  price_fx_t average(const Series &series, int periods) const;
+  bool evaluate(AlertRule &rule, const Series *series, price_fx_t price, price_fx_t *reference);
+
+  FireFn _onFire = NULL;
+  AlertRule _rules[ALERT_MAX_RULES];
+  uint16_t _count = 0;
+  uint16_t _first[MAX_COINS + 1]; // rules of coin i are [_first[i], _first[i + 1])
+  int8_t _slot[MAX_COINS];        // Series of the coin, -1 = none
+  Series _series[ALERT_SERIES_COINS];
+  uint8_t _slots = 0;
+  bool _dirty = false;
+  AlertStats _stats = {};
+};
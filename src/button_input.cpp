@@ -0,0 +1,164 @@
+#include "button_input.h"
+
+#ifdef ARDUINO
+#include <esp_sleep.h>
+#endif
+
+ButtonInput *ButtonInput::_instance = NULL;
+
+bool ButtonInput::add(uint8_t pin, uint32_t key, uint32_t longKey, bool repeat)
+{
+  if (_count == BUTTON_MAX)
+    return false;
+  _instance = this;
+  Button &button = _buttons[_count];
+  button = {};
+  button.pin = pin;
+  button.key = key;
+  button.longKey = longKey;
+  button.repeat = repeat;
+  pinMode(pin, INPUT_PULLUP);
+  button.pressed = digitalRead(pin) == LOW; // held through boot: no key until released
+  attachInterruptArg(digitalPinToInterrupt(pin), onInterrupt, (void *)(uintptr_t)_count, CHANGE);
+  _count++;
+  addWakePin(pin);
+  return true;
+}
+
+void ButtonInput::addWakePin(uint8_t pin)
+{
+  for (uint8_t i = 0; i < _wakeCount; i++)
+  {
+    if (_wakePins[i] == pin)
+      return;
+  }
+  if (_wakeCount < sizeof(_wakePins) && esp_sleep_is_valid_wakeup_gpio((gpio_num_t)pin))
+    _wakePins[_wakeCount++] = pin;
+}
+
+void IRAM_ATTR ButtonInput::onInterrupt(void *arg)
+{
+  ButtonInput *self = _instance;
+  uint8_t index = (uintptr_t)arg;
+  ButtonEdge edge = {index, digitalRead(self->_buttons[index].pin) == LOW, millis()};
+  self->_stats.edges++;
+  if (!self->_ring.push(edge))
+  {
+    self->_stats.dropped++;
+    self->_overflow = true;
+  }
+  if (self->_onEdge != NULL)
+    self->_onEdge();
+}
+
+bool ButtonInput::apply(uint8_t index, bool pressed, uint32_t ms, uint32_t *key)
+{
+  Button &button = _buttons[index];
+  if (pressed == button.pressed)
+    return false; // the edge back after an ignored bounce
+  if (ms - button.changedMs < BUTTON_DEBOUNCE_MS)
+  {
+    _stats.bounces++;
+    button.unsettled = true;
+    return false;
+  }
+  button.pressed = pressed;
+  button.changedMs = ms;
+  if (pressed)
+  {
+    button.longSent = false;
+    button.nextMs = ms + BUTTON_LONG_MS;
+    if (button.longKey != 0)
+      return false; // short or long is decided later
+    *key = button.key;
+    return true;
+  }
+  if (button.longKey == 0 || button.longSent)
+    return false;
+  *key = button.key; // released before it became a long press
+  return true;
+}
+
+// Levels that settled without an edge we saw, long presses and repeats
+bool ButtonInput::timed(uint32_t now, uint32_t *key)
+{
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    Button &button = _buttons[i];
+    if ((button.unsettled || button.pressed) && now - button.changedMs >= BUTTON_DEBOUNCE_MS)
+    {
+      button.unsettled = false;
+      bool pressed = digitalRead(button.pin) == LOW;
+      if (pressed != button.pressed && apply(i, pressed, now, key))
+        return true;
+    }
+    if (!button.pressed || (int32_t)(now - button.nextMs) < 0)
+      continue;
+    if (button.longKey != 0 && !button.longSent)
+    {
+      button.longSent = true;
+      _stats.longPresses++;
+      *key = button.longKey;
+    }
+    else if (button.repeat)
+    {
+      _stats.repeats++;
+      *key = button.longKey != 0 ? button.longKey : button.key;
+    }
+    else
+    {
+      continue;
+    }
+    button.nextMs += BUTTON_REPEAT_MS;
+    return true;
+  }
+  return false;
+}
+
+bool ButtonInput::read(uint32_t *key)
+{
+  if (_overflow.exchange(false))
+  {
+    for (uint8_t i = 0; i < _count; i++)
+      _buttons[i].unsettled = true; // some edges are lost
+  }
+  bool found = false;
+  ButtonEdge edge;
+  while (!found && _ring.pop(&edge))
+    found = apply(edge.button, edge.pressed, edge.ms, key);
+  if (!found)
+    found = timed(millis(), key);
+  if (found)
+    _stats.keys++;
+  return found;
+}
+
+bool ButtonInput::busy() const
+{
+  if (!_ring.empty() || _overflow)
+    return true;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    if (_buttons[i].pressed || _buttons[i].unsettled)
+      return true;
+  }
+  return false;
+}
+
+void ButtonInput::enableWakeup()
+{
+#if CONFIG_IDF_TARGET_ESP32
+  // The ESP32's ext1 only wakes when all its pins are low, so it can take
+  // one active-low pin; ext0 takes another. Any further pins can't wake it.
+  if (_wakeCount > 0)
+    esp_sleep_enable_ext0_wakeup((gpio_num_t)_wakePins[0], LOW);
+  if (_wakeCount > 1)
+    esp_sleep_enable_ext1_wakeup(1ULL << _wakePins[1], ESP_EXT1_WAKEUP_ALL_LOW);
+#else
+  uint64_t mask = 0;
+  for (uint8_t i = 0; i < _wakeCount; i++)
+    mask |= 1ULL << _wakePins[i];
+  if (mask != 0)
+    esp_sleep_enable_ext1_wakeup(mask, ESP_EXT1_WAKEUP_ANY_LOW);
+#endif
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "spsc_ring.h"
+
+#define BUTTON_MAX 4
+#define BUTTON_RING_LEN 32   // edges, bounces included
+#define BUTTON_DEBOUNCE_MS 20 // a level must hold this long after an accepted edge
+#define BUTTON_LONG_MS 600    // held this long: the long key, or the first repeat
+#define BUTTON_REPEAT_MS 250
+
+struct ButtonEdge
+{
+  uint8_t button;
+  bool pressed;
+  uint32_t ms;
+};
+
+struct ButtonStats
+{
+  uint32_t edges;   // ISR
+  uint32_t dropped; // ISR, ring full
+  uint32_t bounces; // UI, edges within the debounce time
+  uint32_t keys;    // UI, every key handed out
+  uint32_t longPresses;
+  uint32_t repeats;
+};
+
+// Active-low push buttons read through GPIO interrupts. The ISR only
+// timestamps edges; read() debounces them and turns presses into keys for
+// an LVGL keypad indev, so nothing polls the pins while they are idle. A
+// button sends its key on press, or, if it has a long key, on release when
+// that came before BUTTON_LONG_MS. With repeat, holding it re-sends the
+// (long) key every BUTTON_REPEAT_MS. While a button is held or an edge is
+// still settling, read() checks the level itself, so a lost edge can't leave
+// a button stuck.
+class ButtonInput
+{
+public:
+  typedef void (*WakeFn)(); // must be safe to call from an interrupt
+
+  bool add(uint8_t pin, uint32_t key, uint32_t longKey = 0, bool repeat = false);
+  void addWakePin(uint8_t pin); // also ends deep sleep, with the buttons
+  void onEdge(WakeFn fn) { _onEdge = fn; }
+
+  // UI thread: the next key, false if there is none yet
+  bool read(uint32_t *key);
+  bool busy() const; // read() has work now or soon
+  void enableWakeup(); // before deep sleep, on any button or wake pin going low
+
+  const ButtonStats &stats() const { return _stats; }
+
+private:
+  struct Button
+  {
+    uint8_t pin;
+    uint32_t key;
+    uint32_t longKey;
+    bool repeat;
+    bool pressed;   // debounced
+    bool unsettled; // an edge was ignored, check the level once it settles
+    bool longSent;
+    uint32_t changedMs; // last accepted edge
+    uint32_t nextMs;    // long key or next repeat, while pressed
+  };
+
+  static void IRAM_ATTR onInterrupt(void *arg);
+  bool apply(uint8_t button, bool pressed, uint32_t ms, uint32_t *key);
+  bool timed(uint32_t now, uint32_t *key);
+
+  static ButtonInput *_instance; // for the ISR
+
+  Button _buttons[BUTTON_MAX];
+  uint8_t _count = 0;
+  uint8_t _wakePins[BUTTON_MAX + 2];
+  uint8_t _wakeCount = 0;
+  // Each button's ISR pushes here; they run on one core and don't nest
+  SpscRing<ButtonEdge, BUTTON_RING_LEN> _ring;
+  std::atomic<bool> _overflow{false};
+  WakeFn _onEdge = NULL;
+  ButtonStats _stats = {};
+};
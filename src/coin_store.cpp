@@ -0,0 +1,62 @@
+#include "coin_store.h"
+
+#include <string.h>
+
+int CoinStore::add(const char *sym)
+{
+  size_t len = strlen(sym);
+  if (count >= MAX_COINS || len == 0 || len >= COIN_SYMBOL_LEN || find(sym) >= 0)
+    return -1;
+
+  int i = count++;
+  memcpy(symbol[i], sym, len + 1);
+  memset(&record[i], 0, sizeof(record[i]));
+  return i;
+}
+
+int CoinStore::addList(const char *csv)
+{
+  int added = 0;
+  char sym[COIN_SYMBOL_LEN];
+  while (*csv)
+  {
+    const char *end = strchr(csv, ',');
+    size_t len = end ? (size_t)(end - csv) : strlen(csv);
+    if (len < COIN_SYMBOL_LEN)
+    {
+      memcpy(sym, csv, len);
+      sym[len] = '\0';
+      if (add(sym) >= 0)
+        added++;
+    }
+    csv += len;
+    if (*csv == ',')
+      csv++;
+  }
+  return added;
+}
+
+int CoinStore::find(const char *sym) const
+{
+  for (int i = 0; i < count; i++)
+  {
+    if (strcmp(symbol[i], sym) == 0)
+      return i;
+  }
+  return -1;
+}
+
+uint32_t CoinStore::hash() const
+{
+  uint32_t h = 2166136261u; // FNV-1a
+  for (int i = 0; i < count; i++)
+  {
+    for (const char *c = symbol[i]; ; c++)
+    {
+      h = (h ^ (uint8_t)*c) * 16777619u;
+      if (*c == '\0')
+        break;
+    }
+  }
+  return h;
+}
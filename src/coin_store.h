@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+#include "price_record.h"
+
+#ifndef MAX_COINS
+#define MAX_COINS 200
+#endif
+#define COIN_SYMBOL_LEN 12
+
+// Watchlist data kept as a struct of arrays, so scanning one field over the
+// whole list touches contiguous memory and the footprint is fixed up front.
+// Symbols are set once at startup; the value arrays are owned by the UI thread.
+struct CoinStore
+{
+  uint16_t count;
+  char symbol[MAX_COINS][COIN_SYMBOL_LEN];
+  PriceRecord record[MAX_COINS];
+
+  int add(const char *sym);
+  int addList(const char *csv); // "BTC,ETH,GMT"; returns the number added
+  int find(const char *sym) const;
+  uint32_t hash() const; // identifies the watchlist, e.g. for persisted data
+};
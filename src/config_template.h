@@ -6,6 +6,14 @@
 #define WIFI_SSID "YOUR_WIFI_SSID"
 #define WIFI_PASSWORD "YOUR_WIFI_PASSWORD"
 #define API_HOST "https://api.binance.com/api/v3/ticker/24hr"
+#define PRICE_STREAM_URL "wss://stream.binance.com:9443" // miniTicker WebSocket feed; remove to only poll API_HOST
+// #define BITFINEX_HOST "https://api-pub.bitfinex.com" // second source to fail over to
+// #define PRICE_CONSENSUS // ask every source each time and show the median
+#define WATCHLIST "BTC,ETH,GMT" // comma separated, up to MAX_COINS symbols
+// #define BATTERY_ADC_PIN 36 // battery through a 1:2 divider; polls less often when low
+// #define MOTOR_PIN 4 // vibration motor, pulsed when an alert fires
+// Above, below, a 5% move within 60 minutes, a cross of the 20-minute average
+// #define PRICE_ALERTS "BTC>70000,ETH<2000,ETH%5/60,BTC^20"
 
 #define LV_DELAY(x)             \
     do                          \
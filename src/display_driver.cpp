@@ -0,0 +1,262 @@
+#include "display_driver.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <TFT_eSPI.h>
+#include <esp_heap_caps.h>
+
+#if DISPLAY_DMA && !LV_COLOR_16_SWAP
+#error "DISPLAY_DMA needs LV_COLOR_16_SWAP: pushImageDMA() sends the buffers as they are"
+#endif
+
+#define PROFILE_NAMESPACE "display"
+
+static const uint16_t stripCandidates[] = DISPLAY_STRIP_CANDIDATES;
+static const int stripCandidateCount = sizeof(stripCandidates) / sizeof(stripCandidates[0]);
+
+static uint32_t stripCaps()
+{
+  return DISPLAY_DMA ? MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL : MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL;
+}
+
+bool DisplayDriver::allocStrips(uint16_t lines)
+{
+  size_t size = (size_t)_drv.hor_res * lines * sizeof(lv_color_t);
+  _buf1 = (lv_color_t *)heap_caps_malloc(size, stripCaps());
+  if (DISPLAY_DMA)
+    _buf2 = (lv_color_t *)heap_caps_malloc(size, stripCaps());
+  if (_buf1 == NULL || (DISPLAY_DMA && _buf2 == NULL))
+  {
+    freeStrips();
+    return false;
+  }
+  _allocLines = lines;
+  return true;
+}
+
+bool DisplayDriver::resizeStrips(uint16_t lines)
+{
+  size_t size = (size_t)_drv.hor_res * lines * sizeof(lv_color_t);
+  lv_color_t *buf1 = (lv_color_t *)heap_caps_realloc(_buf1, size, stripCaps());
+  if (buf1 == NULL)
+    return false;
+  _buf1 = buf1;
+  _allocLines = lines;
+  if (_buf2 != NULL)
+  {
+    lv_color_t *buf2 = (lv_color_t *)heap_caps_realloc(_buf2, size, stripCaps());
+    if (buf2 != NULL) // otherwise the old, larger one stays valid
+      _buf2 = buf2;
+  }
+  return true;
+}
+
+void DisplayDriver::freeStrips()
+{
+  heap_caps_free(_buf1);
+  heap_caps_free(_buf2);
+  _buf1 = _buf2 = NULL;
+  _allocLines = 0;
+}
+
+// Points LVGL at the first `lines` lines of the strips; only between refreshes
+void DisplayDriver::useLines(uint16_t lines)
+{
+  sync();
+  _lines = lines;
+  lv_disp_draw_buf_init(&_drawBuf, _buf1, _buf2, (uint32_t)_drv.hor_res * lines);
+}
+
+bool DisplayDriver::begin(TFT_eSPI *tft, uint16_t width, uint16_t height)
+{
+  _tft = tft;
+  lv_disp_drv_init(&_drv);
+  _drv.hor_res = width;
+  _drv.ver_res = height;
+  _drv.flush_cb = flush;
+  _drv.monitor_cb = monitor;
+  _drv.user_data = this;
+
+  // A profile only needs its own strip height; tuning wants room for the
+  // tallest candidate. Either way settle for less if memory is short.
+  uint16_t lines = loadProfile();
+  _tuned = lines != 0;
+  for (int i = stripCandidateCount - 1; i >= 0 && _buf1 == NULL; i--)
+  {
+    if (lines == 0 || stripCandidates[i] <= lines)
+      allocStrips(stripCandidates[i]);
+  }
+
+#if DISPLAY_DMA
+  if (_buf1 != NULL && tft->initDMA())
+  {
+    _dma = true;
+    tft->startWrite(); // keeps CS low and the bus claimed for the DMA transfers
+    _drv.wait_cb = wait;
+  }
+  else
+  {
+    Serial.println("DMA display buffers unavailable, using a full-screen buffer");
+    freeStrips();
+  }
+#endif
+
+  if (_buf1 != NULL)
+  {
+    useLines(_tuned || _allocLines < DISPLAY_STRIP_DEFAULT ? _allocLines : DISPLAY_STRIP_DEFAULT);
+  }
+  else
+  {
+    uint32_t pixels = (uint32_t)width * height;
+    _buf1 = (lv_color_t *)ps_malloc(pixels * sizeof(lv_color_t));
+    if (_buf1 == NULL)
+      return false;
+    _lines = 0;
+    _tuned = true; // nothing to choose
+    lv_disp_draw_buf_init(&_drawBuf, _buf1, NULL, pixels);
+  }
+
+  _drv.draw_buf = &_drawBuf;
+  return lv_disp_drv_register(&_drv) != NULL;
+}
+
+// One forced full-screen redraw, including the last transfer
+uint32_t DisplayDriver::timeFrame()
+{
+  lv_obj_invalidate(lv_scr_act());
+  uint32_t start = micros();
+  lv_refr_now(NULL);
+  sync();
+  return micros() - start;
+}
+
+uint16_t DisplayDriver::tune()
+{
+  if (_lines == 0)
+    return 0;
+
+  uint32_t frameUs[stripCandidateCount] = {};
+  uint32_t best = UINT32_MAX;
+  for (int i = 0; i < stripCandidateCount; i++)
+  {
+    if (stripCandidates[i] > _allocLines)
+      break;
+    useLines(stripCandidates[i]);
+    timeFrame(); // warm up caches and font glyphs
+    uint32_t total = 0;
+    for (int r = 0; r < DISPLAY_TUNE_ROUNDS; r++)
+      total += timeFrame();
+    frameUs[i] = total / DISPLAY_TUNE_ROUNDS;
+    if (frameUs[i] < best)
+      best = frameUs[i];
+    Serial.printf("Display strip %u lines: %u us/frame\n", stripCandidates[i], (unsigned)frameUs[i]);
+  }
+
+  // Tall strips cost RAM for little gain once the overhead per flush is amortized
+  uint16_t lines = _lines;
+  uint32_t chosenUs = 0;
+  for (int i = 0; i < stripCandidateCount; i++)
+  {
+    if (frameUs[i] != 0 && frameUs[i] <= best + best * DISPLAY_TUNE_SLACK / 100)
+    {
+      lines = stripCandidates[i];
+      chosenUs = frameUs[i];
+      break;
+    }
+  }
+
+  sync();
+  if (lines < _allocLines)
+    resizeStrips(lines);
+  useLines(lines);
+  saveProfile(lines);
+  _tuned = true;
+
+  uint32_t pixels = (uint32_t)_drv.hor_res * _drv.ver_res;
+  Serial.printf("Display: %s, %u-line strips (%u bytes each), %u us/frame, %u kpx/s\n",
+                _dma ? "2 DMA buffers" : "1 buffer", lines,
+                (unsigned)(_drv.hor_res * lines * sizeof(lv_color_t)), (unsigned)chosenUs,
+                (unsigned)(chosenUs ? (uint64_t)pixels * 1000 / chosenUs : 0));
+  return lines;
+}
+
+// A profile is only valid for the build it was measured with
+uint32_t DisplayDriver::profileKey() const
+{
+  uint32_t key = (uint32_t)_drv.hor_res << 16 | _drv.ver_res;
+  key = key * 31 + DISPLAY_DMA;
+  for (int i = 0; i < stripCandidateCount; i++)
+    key = key * 31 + stripCandidates[i];
+  return key;
+}
+
+uint16_t DisplayDriver::loadProfile()
+{
+  Preferences prefs;
+  if (!prefs.begin(PROFILE_NAMESPACE, true))
+    return 0;
+  uint16_t lines = 0;
+  if (prefs.getUInt("key", 0) == profileKey())
+    lines = prefs.getUShort("lines", 0);
+  prefs.end();
+  return lines;
+}
+
+void DisplayDriver::saveProfile(uint16_t lines)
+{
+  Preferences prefs;
+  if (!prefs.begin(PROFILE_NAMESPACE, false))
+    return;
+  prefs.putUInt("key", profileKey());
+  prefs.putUShort("lines", lines);
+  prefs.end();
+}
+
+void DisplayDriver::sync()
+{
+  if (_dma && _drawBuf.flushing)
+  {
+    _tft->dmaWait();
+    lv_disp_flush_ready(&_drv);
+  }
+}
+
+void DisplayDriver::flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
+{
+  DisplayDriver *self = static_cast<DisplayDriver *>(drv->user_data);
+  uint32_t w = (area->x2 - area->x1 + 1);
+  uint32_t h = (area->y2 - area->y1 + 1);
+  self->_stats.flushes++;
+  self->_stats.pixels += w * h;
+
+  if (self->_dma)
+  {
+    // Returns as soon as the transfer is queued; LVGL goes on rendering into
+    // the other buffer and wait() reports this one ready once DMA is done.
+    // The const overload neither clips nor byte swaps on the CPU.
+    self->_tft->pushImageDMA(area->x1, area->y1, w, h, (const uint16_t *)&color_p->full);
+    return;
+  }
+  self->_tft->pushImage(area->x1, area->y1, w, h, (uint16_t *)&color_p->full);
+  lv_disp_flush_ready(drv);
+}
+
+// Called by LVGL when it needs the buffer that is still being flushed
+void DisplayDriver::wait(lv_disp_drv_t *drv)
+{
+  DisplayDriver *self = static_cast<DisplayDriver *>(drv->user_data);
+  if (self->_tft->dmaBusy())
+  {
+    uint32_t start = micros();
+    self->_tft->dmaWait(); // blocks on the SPI driver until the transfer completes
+    self->_stats.flushWaits++;
+    self->_stats.flushWaitUs += micros() - start;
+  }
+  lv_disp_flush_ready(drv);
+}
+
+void DisplayDriver::monitor(lv_disp_drv_t *drv, uint32_t time, uint32_t px)
+{
+  DisplayDriver *self = static_cast<DisplayDriver *>(drv->user_data);
+  self->_stats.frames++;
+  self->_stats.renderMs += time;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+#include "lvgl.h"
+
+class TFT_eSPI;
+
+#ifndef DISPLAY_DMA
+#define DISPLAY_DMA 0 // set with -DDISPLAY_DMA=1 in platformio.ini, lv_conf.h follows it
+#endif
+
+// Draw buffer heights tune() chooses from, smallest first
+#define DISPLAY_STRIP_CANDIDATES {10, 16, 24, 40, 60}
+#define DISPLAY_STRIP_DEFAULT 24 // until tune() has run
+#define DISPLAY_TUNE_ROUNDS 3    // full-screen redraws per candidate
+#define DISPLAY_TUNE_SLACK 5     // percent: a smaller strip within this of the best wins
+
+// Counters for the flush path. flushWaitUs is the time LVGL sat idle because
+// both buffers were in use, i.e. rendering that did not overlap the transfer.
+struct DisplayStats
+{
+  uint32_t frames;      // completed refreshes
+  uint32_t flushes;     // areas handed to the display
+  uint32_t pixels;      // pixels sent
+  uint32_t renderMs;    // total refresh time reported by LVGL
+  uint32_t flushWaits;  // times LVGL had to wait for the previous transfer
+  uint32_t flushWaitUs; // total time spent waiting
+};
+
+// LVGL display driver for the TFT. LVGL renders into strip buffers in
+// internal RAM, DISPLAY_STRIP_CANDIDATES lines high. With DISPLAY_DMA there
+// are two DMA-capable strips: LVGL renders into one while the SPI DMA streams
+// the other. Otherwise a single strip is pushed with blocking writes. A
+// full-screen PSRAM buffer is only the last resort.
+// The strip height is benchmarked once by tune() and kept in NVS.
+class DisplayDriver
+{
+public:
+  bool begin(TFT_eSPI *tft, uint16_t width, uint16_t height);
+  void sync(); // wait for a pending transfer, before using the TFT directly
+
+  // Times full-screen redraws of the current screen for each candidate
+  // strip height, keeps the best one and frees the rest of the buffers
+  uint16_t tune();
+  bool tuned() const { return _tuned; } // the strip height came from a profile or tune()
+
+  bool usesDma() const { return _dma; }
+  uint16_t stripLines() const { return _lines; } // 0 = full-screen PSRAM buffer
+  const DisplayStats &stats() const { return _stats; }
+
+private:
+  static void flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p);
+  static void wait(lv_disp_drv_t *drv);
+  static void monitor(lv_disp_drv_t *drv, uint32_t time, uint32_t px);
+  bool allocStrips(uint16_t lines);
+  bool resizeStrips(uint16_t lines);
+  void freeStrips();
+  void useLines(uint16_t lines);
+  uint32_t timeFrame();
+  uint32_t profileKey() const;
+  uint16_t loadProfile();
+  void saveProfile(uint16_t lines);
+
+  TFT_eSPI *_tft = NULL;
+  lv_disp_draw_buf_t _drawBuf = {};
+  lv_disp_drv_t _drv = {};
+  lv_color_t *_buf1 = NULL;
+  lv_color_t *_buf2 = NULL;
+  uint16_t _allocLines = 0; // capacity of the strips
+  uint16_t _lines = 0;      // in use
+  bool _dma = false;
+  bool _tuned = false;
+  DisplayStats _stats = {};
+};
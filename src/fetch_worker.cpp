@@ -0,0 +1,112 @@
+#include "fetch_worker.h"
+
+void FetchWorker::runIn(uint32_t ms)
+{
+  _nextMs = ms;
+}
+
+#ifdef ARDUINO
+
+#define FETCH_TASK_STACK 8192 // the TLS handshake and the parser's JsonDocument need a large stack
+#define FETCH_TASK_PRIORITY 1
+#define FETCH_TASK_CORE 0 // loop() and LVGL run on core 1
+
+bool FetchWorker::begin(FetchFn fn, void *ctx, uint32_t periodMs)
+{
+  _fn = fn;
+  _ctx = ctx;
+  _periodMs = periodMs;
+  return xTaskCreatePinnedToCore(taskEntry, "fetch", FETCH_TASK_STACK, this,
+                                 FETCH_TASK_PRIORITY, &_task, FETCH_TASK_CORE) == pdPASS;
+}
+
+void FetchWorker::requestRefresh()
+{
+  if (_task != nullptr)
+    xTaskNotifyGive(_task);
+}
+
+void FetchWorker::end()
+{
+  if (_task != nullptr)
+  {
+    vTaskDelete(_task);
+    _task = nullptr;
+  }
+}
+
+bool FetchWorker::stopping()
+{
+  return false; // end() deletes the task outright
+}
+
+void FetchWorker::taskEntry(void *arg)
+{
+  static_cast<FetchWorker *>(arg)->run();
+}
+
+void FetchWorker::run()
+{
+  for (;;)
+  {
+    _nextMs = NOT_SET;
+    _fn(_ctx);
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(nextWait()));
+  }
+}
+
+#else
+
+#include <chrono>
+
+bool FetchWorker::begin(FetchFn fn, void *ctx, uint32_t periodMs)
+{
+  _fn = fn;
+  _ctx = ctx;
+  _periodMs = periodMs;
+  _stop = false;
+  _refresh = false;
+  _thread = std::thread(&FetchWorker::run, this);
+  return true;
+}
+
+void FetchWorker::requestRefresh()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  _refresh = true;
+  _wake.notify_one();
+}
+
+void FetchWorker::end()
+{
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    _stop = true;
+    _wake.notify_one();
+  }
+  if (_thread.joinable())
+    _thread.join();
+}
+
+bool FetchWorker::stopping()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  return _stop;
+}
+
+void FetchWorker::run()
+{
+  std::unique_lock<std::mutex> guard(_lock);
+  while (!_stop)
+  {
+    guard.unlock();
+    _nextMs = NOT_SET;
+    _fn(_ctx);
+    guard.lock();
+    _wake.wait_for(guard, std::chrono::milliseconds(nextWait()), [this]
+                   { return _refresh || _stop; });
+    _refresh = false;
+  }
+}
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+// Runs a fetch job periodically off the UI thread. On the ESP32 this is a
+// FreeRTOS task pinned to the protocol core (the Arduino loop() runs on the
+// other one); on the host it is a std::thread so the job can be exercised in
+// tests. The job publishes its results itself, e.g. through an SpscMailbox.
+class FetchWorker
+{
+public:
+  typedef void (*FetchFn)(void *ctx);
+
+  bool begin(FetchFn fn, void *ctx, uint32_t periodMs);
+  void requestRefresh(); // run the job now instead of waiting for the period
+  void runIn(uint32_t ms); // from the job: wait this long next time instead of the period, 0 = run again now
+  void end();
+  bool stopping(); // true once end() was called; long-running jobs should return
+
+private:
+  void run();
+  uint32_t nextWait() const { return _nextMs != NOT_SET ? _nextMs : _periodMs; }
+
+  static const uint32_t NOT_SET = UINT32_MAX;
+
+  FetchFn _fn = nullptr;
+  void *_ctx = nullptr;
+  uint32_t _periodMs = 0;
+  uint32_t _nextMs = NOT_SET; // runIn(), NOT_SET = the period
+
+#ifdef ARDUINO
+  static void taskEntry(void *arg);
+  TaskHandle_t _task = nullptr;
+#else
+  std::thread _thread;
+  std::mutex _lock;
+  std::condition_variable _wake;
+  bool _refresh = false;
+  bool _stop = false;
+#endif
+};
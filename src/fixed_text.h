@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// Text built in a fixed buffer, for URLs and labels on paths that must not
+// touch the heap. Whatever doesn't fit is cut off and truncated() says so.
+template <size_t N>
+class FixedText
+{
+public:
+  void clear()
+  {
+    _length = 0;
+    _text[0] = '\0';
+    _truncated = false;
+  }
+
+  FixedText &append(const char *s)
+  {
+    size_t length = strlen(s);
+    if (length > N - 1 - _length)
+    {
+      length = N - 1 - _length;
+      _truncated = true;
+    }
+    memcpy(_text + _length, s, length);
+    _length += length;
+    _text[_length] = '\0';
+    return *this;
+  }
+
+  __attribute__((format(printf, 2, 3))) FixedText &appendf(const char *format, ...)
+  {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(_text + _length, N - _length, format, args);
+    va_end(args);
+    if (length < 0)
+      length = 0;
+    if ((size_t)length > N - 1 - _length)
+    {
+      length = N - 1 - _length;
+      _truncated = true;
+    }
+    _length += length;
+    return *this;
+  }
+
+  const char *c_str() const { return _text; }
+  size_t length() const { return _length; }
+  bool truncated() const { return _truncated; }
+
+private:
+  char _text[N] = "";
+  size_t _length = 0;
+  bool _truncated = false;
+};
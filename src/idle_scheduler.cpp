@@ -0,0 +1,86 @@
+#include "idle_scheduler.h"
+
+#ifdef ARDUINO
+#include <driver/gpio.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#endif
+
+IdleScheduler *IdleScheduler::_instance = NULL;
+
+void IdleScheduler::begin()
+{
+  _instance = this;
+#ifdef ARDUINO
+  _task = xTaskGetCurrentTaskHandle();
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+  esp_pm_config_esp32_t pm = {};
+  pm.max_freq_mhz = getCpuFrequencyMhz();
+  pm.min_freq_mhz = 80; // APB stays at 80 MHz for SPI and I2C
+  pm.light_sleep_enable = true;
+  _lightSleep = esp_pm_configure(&pm) == ESP_OK;
+  if (_lightSleep)
+    esp_sleep_enable_gpio_wakeup();
+#endif
+#endif
+}
+
+void IdleScheduler::addWakePin(uint8_t pin, int level)
+{
+#ifdef ARDUINO
+  if (_lightSleep)
+    gpio_wakeup_enable((gpio_num_t)pin, level == LOW ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+#endif
+}
+
+void IdleScheduler::wake()
+{
+#ifdef ARDUINO
+  if (_task != NULL)
+    xTaskNotifyGive(_task);
+#else
+  _woken = true;
+#endif
+}
+
+void IRAM_ATTR IdleScheduler::wakeFromIsr()
+{
+  IdleScheduler *self = _instance;
+  if (self == NULL)
+    return;
+#ifdef ARDUINO
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(self->_task, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+#else
+  self->_woken = true;
+#endif
+}
+
+void IdleScheduler::idle(uint32_t ms)
+{
+  uint32_t start = micros();
+  if (_stats.wakeups > 0)
+    _stats.busyUs += start - _busySince; // the rest of setup() isn't loop time
+  if (ms > 0)
+  {
+    bool event;
+#ifdef ARDUINO
+    event = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms)) != 0;
+#else
+    uint32_t waited = 0;
+    while (!_woken && waited < ms)
+    {
+      delay(1);
+      waited++;
+    }
+    event = _woken.exchange(false);
+#endif
+    _stats.wakeups++;
+    if (event)
+      _stats.eventWakeups++;
+  }
+  _busySince = micros();
+  _stats.idleUs += _busySince - start;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+struct IdleStats
+{
+  uint32_t wakeups;      // idle() calls that actually waited
+  uint32_t eventWakeups; // of those, cut short by wake()
+  uint64_t busyUs;       // between two idle() calls
+  uint64_t idleUs;       // inside idle()
+};
+
+// Puts the UI loop to sleep until the next LVGL timer is due or something
+// calls wake(): an interrupt (button, touch INT) or another task handing
+// data over. On the ESP32 the loop task blocks on a task notification, so
+// the CPU only runs when there is work; with power management built into
+// the core (CONFIG_PM_ENABLE and tickless idle) the idle task then enters
+// automatic light sleep, with the pins from addWakePin() armed to end it.
+// The host has no light sleep and waits in 1 ms steps.
+class IdleScheduler
+{
+public:
+  void begin(); // from the UI task
+  void addWakePin(uint8_t pin, int level);
+
+  void wake();                         // from any task
+  static void IRAM_ATTR wakeFromIsr(); // from an interrupt handler
+
+  void idle(uint32_t ms); // UI task; returns early on wake()
+
+  const IdleStats &stats() const { return _stats; }
+  bool lightSleep() const { return _lightSleep; }
+
+private:
+  static IdleScheduler *_instance; // for the ISR
+
+  IdleStats _stats = {};
+  uint32_t _busySince = 0; // micros()
+  bool _lightSleep = false;
+#ifdef ARDUINO
+  TaskHandle_t _task = NULL;
+#else
+  std::atomic<bool> _woken{false};
+#endif
+};
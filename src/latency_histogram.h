@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+#define LATENCY_BUCKETS 15 // the last one holds 8 s and more
+
+// Request latencies in power-of-two buckets of milliseconds: bucket 0 is
+// under 1 ms, bucket i covers [2^(i-1), 2^i) ms. Cheap enough to update on
+// every request and small enough to keep one per source.
+struct LatencyHistogram
+{
+  uint32_t buckets[LATENCY_BUCKETS];
+  uint32_t count;
+
+  void add(uint32_t ms)
+  {
+    int i = 0;
+    while (ms != 0 && i < LATENCY_BUCKETS - 1)
+    {
+      ms >>= 1;
+      i++;
+    }
+    buckets[i]++;
+    count++;
+  }
+
+  // Upper bound of the bucket holding the percentile, in ms; 0 if empty
+  uint32_t percentile(int percent) const
+  {
+    if (count == 0)
+      return 0;
+    uint32_t rank = (count * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+      seen += buckets[i];
+      if (seen >= rank && buckets[i] != 0)
+        return 1u << i;
+    }
+    return 1u << (LATENCY_BUCKETS - 1);
+  }
+};
@@ -6,8 +6,25 @@
 #include <WiFi.h>
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
-#include <EEPROM.h>
 #include <time.h>
+#include "alert_engine.h"
+#include "coin_store.h"
+#include "display_driver.h"
+#include "fetch_worker.h"
+#include "refresh_scheduler.h"
+#include "idle_scheduler.h"
+#include "button_input.h"
+#include "price_aggregator.h"
+#include "price_feed.h"
+#include "price_history.h"
+#include "price_log.h"
+#include "price_stream.h"
+#include "spsc_mailbox.h"
+#include "spsc_ring.h"
+#include "ticker_parser.h"
+#include "tile_pager.h"
+#include "touch_input.h"
+#include "wake_state.h"
 
 LV_IMG_DECLARE(logo);
 extern const uint16_t logo_map[];
@@ -24,48 +41,103 @@ static const uint16_t screenHeight = 240;
 TFT_eSPI tft = TFT_eSPI(screenWidth, screenHeight);
 
 #define WAIT 1000
+#define PRICE_REFRESH_MS (60000 * 5) // fetch task period, unless the scheduler asks for another
+#define PRICE_APPLY_MS LV_DISP_DEF_REFR_PERIOD // the UI checks for a new snapshot once per frame
+#define PRICE_PUBLISH_MS 50                      // streamed ticks are handed to the UI at most this often
+#define PRICE_LOG_COMMIT_MS (60000 * 5)          // while streaming, write the price log this often
+#define STREAM_RETRY_AFTER_MS 60000              // reconnect at once if the stream lasted this long
+#define DISPLAY_STATS_MS 10000
+#define LOOP_MAX_IDLE_MS 1000 // the UI loop wakes at least this often
+#define ALERT_SHOW_MS 5000       // a fired alert stays on screen this long
+#define ALERT_BUZZ_MS 200        // and pulses the motor this long
+
+#ifndef WATCHLIST
+#define WATCHLIST "BTC,ETH,GMT"
+#endif
+#ifndef PRICE_ALERTS
+#define PRICE_ALERTS "" // none
+#endif
 
 void lvgl_test(void);
-void create_crypto_watch(lv_obj_t *parent, int index);
+void create_crypto_watch(CoinTile &tile);
+void bind_crypto_watch(CoinTile &tile, int coin);
 void create_system_info(lv_obj_t *parent);
-
-static lv_color_t *buf = NULL;
-static lv_disp_draw_buf_t draw_buf;
-static lv_obj_t *dis = NULL;
+void cycleChartResolution(lv_event_t *e);
+void fetchPrices(void *ctx);
+void updateCryptoPrice(lv_timer_t *timer);
+void updateSystemInfo(lv_timer_t *timer);
+void logDisplayStats();
+void logIdleStats();
+void logStats(lv_timer_t *timer);
+void syncSystemInfoTimer();
+void onPagerViewChanged();
+void refreshNow();
+void logRefreshStats();
+void logSourceStats();
+void checkBattery(lv_timer_t *timer);
+void onNavKey(lv_event_t *e);
+void onAlert(const AlertEvent &event);
+void showAlert(const AlertEvent &event);
+void saveAlerts();
+
+DisplayDriver displayDriver;
 CST816S touch;
-
-const char *coins[] = {"BTC", "ETH", "GMT"};
-const int numCoins = sizeof(coins) / sizeof(coins[0]);
-
-struct CoinInfo
+TouchInput touchInput; // only reads the controller after its INT pulses
+ButtonInput buttonInput; // debounced keys for the keypad indev
+IdleScheduler idleScheduler;
+lv_indev_t *touchIndev;
+lv_indev_t *buttonIndev;
+lv_timer_t *priceTimer;      // paused while there is no snapshot to apply
+lv_timer_t *systemInfoTimer; // paused while the info page is out of view
+
+CoinStore coinStore; // symbols are fixed after setup(), values owned by the UI
+TilePager tilePager;
+
+SpscMailbox<PriceSnapshot> priceMailbox; // fetch task -> UI timer
+PriceCoalescer priceFeed;                // only used from the fetch task
+uint32_t appliedSeq[MAX_COINS];          // PriceSnapshot::seq the UI applied last
+FeedStats feedStats;                     // UI side
+
+// What the diff-based tile binding touched so far
+struct BindStats
 {
-  String currentPrice;
-  float priceChangePercentage;
-  float dailyAverage;
-  float dailyHigh;
-  float dailyLow;
+  uint32_t widgetUpdates;     // setter calls that actually changed a widget
+  uint32_t invalidatedPixels; // by applied price snapshots
 };
+BindStats bindStats;
 
-CoinInfo coinInfos[numCoins];
-
-lv_obj_t *meters[numCoins];
-lv_meter_indicator_t *price_indicators[numCoins];
-lv_obj_t *price_labels[numCoins];
-lv_obj_t *change_labels[numCoins];
-
-int currentCoinIndex = 0;
+FetchWorker fetchWorker;
+RefreshScheduler refreshScheduler; // which symbols the fetch task polls when
+BinanceSource binanceSource(API_HOST);
+#ifdef BITFINEX_HOST
+BitfinexSource bitfinexSource(BITFINEX_HOST);
+#endif
+PriceAggregator priceAggregator; // only used from the fetch task
+PriceStream priceStream; // only used from the fetch task
 
 unsigned long lastInteractionTime = 0;
 const unsigned long sleepDelay = 30000; // 30 seconds of inactivity before sleep
 
-struct CachedData
-{
-  float price;
-  float change;
-  unsigned long timestamp;
-};
+#define PRICE_LOG_SECTORS 8 // flash sectors the price log rotates through
+
+PriceHistory priceHistory;                     // UI thread only
+HistoryResolution chartResolution = HISTORY_15MIN; // tap the chart to change
+
+WakeState wakeState;       // RTC-retained screen and WiFi parameters
+BootTimeline bootTimeline; // also read by the host simulator
 
-CachedData cachedPrices[numCoins];
+#ifdef ARDUINO
+PartitionFlash priceFlash;
+#else
+RamFlash priceFlash; // host simulator
+#endif
+PriceLog priceLog; // only used from the fetch task once setup() is done
+
+AlertEngine alertEngine;           // only used from the fetch task once setup() is done
+uint32_t alertRulesKey;            // PRICE_ALERTS and the watchlist the saved rules belong to
+SpscRing<AlertEvent, 16> alertRing; // fired alerts, fetch task -> UI
+lv_obj_t *alertLabel;              // on the top layer, hidden between alerts
+lv_timer_t *alertTimer;            // ends the motor pulse, then hides the label
 
 lv_obj_t *date_label;
 lv_obj_t *time_label;
@@ -74,54 +146,139 @@ lv_obj_t *last_update_label;
 
 void my_print(const char *buf)
 {
-  Serial.printf(buf);
+  Serial.print(buf);
   Serial.flush();
 }
 
-void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
+#define LOG_LINE_MAX 192
+
+// Serial.printf() without the heap: Print::printf() mallocs a buffer for any
+// line longer than 64 bytes. Longer lines than LOG_LINE_MAX are cut off.
+void logPrintf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+void logPrintf(const char *format, ...)
 {
-  uint32_t w = (area->x2 - area->x1 + 1);
-  uint32_t h = (area->y2 - area->y1 + 1);
-  tft.pushImage(area->x1, area->y1, w, h, (uint16_t *)&color_p->full);
-  lv_disp_flush_ready(disp);
+  char line[LOG_LINE_MAX];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  Serial.print(line);
 }
 
+// Replays the queued samples one per call; without a new one the last
+// state holds, as the controller only reports changes
 void my_touchpad_read(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
 {
-  if (touch.ReadTouch())
+  static TouchSample last = {};
+  TouchSample sample;
+  if (touchInput.read(&sample))
   {
-    uint16_t x = touch.getX();
-    uint16_t y = touch.getY();
+    last = sample;
+    data->continue_reading = touchInput.queued();
+  }
+  data->state = last.pressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+  data->point.x = last.x;
+  data->point.y = last.y;
+  if (last.pressed)
+  {
+    lastInteractionTime = millis();
+  }
+  else if (!data->continue_reading && lv_indev_get_scroll_obj(touchIndev) == NULL)
+  {
+    // Nothing to read until the controller pulses again; loop() resumes the timer
+    lv_timer_pause(indev_driver->read_timer);
+  }
+}
 
+void wakeUi()
+{
+  idleScheduler.wake();
+}
+
+// Each key is reported pressed, then released on the next read, so LVGL
+// sends one LV_EVENT_KEY per key; long presses and repeats are ButtonInput's
+void my_keypad_read(lv_indev_drv_t *indev_driver, lv_indev_data_t *data)
+{
+  static uint32_t lastKey = LV_KEY_RIGHT;
+  static bool down = false;
+  uint32_t key;
+  if (!down && buttonInput.read(&key))
+  {
+    lastKey = key;
+    down = true;
     data->state = LV_INDEV_STATE_PR;
-    data->point.x = x;
-    data->point.y = y;
+    data->continue_reading = true; // the release
     lastInteractionTime = millis();
   }
   else
   {
+    down = false;
     data->state = LV_INDEV_STATE_REL;
+    if (!buttonInput.busy())
+    {
+      lv_timer_pause(indev_driver->read_timer); // until loop() sees an edge
+    }
   }
+  data->key = lastKey;
+}
+
+// Hardware gestures of the touch controller. Swipes are left to the
+// tileview, which sees the same points; a double tap refreshes the prices.
+void onTouchGesture(uint8_t gesture)
+{
+  lastInteractionTime = millis();
+  if (gesture == Double_Click)
+  {
+    refreshNow();
+  }
+}
+
+#define WIFI_POLL_MS 100
+#define WIFI_FAST_CONNECT_MS 3000 // with a known channel and BSSID, before scanning
+#define WIFI_CONNECT_MS 20000
+
+// Polls until associated or timeoutMs passed
+bool waitForWiFi(uint32_t timeoutMs)
+{
+  for (uint32_t waited = 0; WiFi.status() != WL_CONNECTED && waited < timeoutMs; waited += WIFI_POLL_MS)
+  {
+    if (waited % 1000 == 0)
+      Serial.print('.');
+    delay(WIFI_POLL_MS);
+  }
+  return WiFi.status() == WL_CONNECTED;
 }
 
 void initWiFi()
 {
   Serial.println("Initializing WiFi...");
   WiFi.mode(WIFI_STA);
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
   Serial.print("Connecting to WiFi ..");
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < 20)
+  bool connected = false;
+  uint8_t channel = wakeState.wifiChannel();
+  if (channel != 0)
   {
-    Serial.print('.');
-    delay(1000);
-    attempts++;
+    // Skips the scan: the access point from before deep sleep, on its channel
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD, channel, wakeState.wifiBssid());
+    connected = waitForWiFi(WIFI_FAST_CONNECT_MS);
+    if (!connected)
+    {
+      Serial.print(" no fast connect, scanning ..");
+      WiFi.disconnect();
+      wakeState.clearWifi();
+    }
   }
-  if (WiFi.status() == WL_CONNECTED)
+  if (!connected)
   {
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    connected = waitForWiFi(WIFI_CONNECT_MS);
+  }
+  if (connected)
+  {
+    wakeState.setWifi(WiFi.channel(), WiFi.BSSID());
+    bootTimeline.mark(BOOT_WIFI);
     Serial.println("\nWiFi connected. IP address: " + WiFi.localIP().toString());
     configTime(60 * 60 * 8, 0, "pool.ntp.org"); // Configure NTP
-    updateCryptoPrice(NULL);                    // Trigger an immediate update when connected
     Serial.println("NTP configured");
   }
   else
@@ -132,33 +289,65 @@ void initWiFi()
 
 void setup()
 {
+  bootTimeline.mark(BOOT_SETUP);
   Serial.begin(115200);
   Serial.println("Starting setup...");
-  pinMode(TFT_BL, OUTPUT);
-  digitalWrite(TFT_BL, HIGH);
-  pinMode(BUTTON_1, INPUT_PULLUP);
-  pinMode(BUTTON_2, INPUT_PULLUP);
+  coinStore.addList(WATCHLIST);
+  refreshScheduler.begin(coinStore.count);
+  bool warm = wakeState.begin(coinStore.hash());
+  idleScheduler.begin();
 
-  // Vibrate on startup
-  Serial.println("Vibrating...");
-  delay(200);
+  // On a warm wake the backlight stays off until the last screen is drawn
+  pinMode(TFT_BL, OUTPUT);
+  digitalWrite(TFT_BL, warm ? LOW : HIGH);
+  buttonInput.onEdge(IdleScheduler::wakeFromIsr);
+#if BUTTON_2 != TWATCH_TOUCH_INT
+  buttonInput.add(BUTTON_1, LV_KEY_RIGHT, 0, true);
+  buttonInput.add(BUTTON_2, LV_KEY_LEFT, 0, true);
+  idleScheduler.addWakePin(BUTTON_2, LOW);
+#else
+  // The touch INT is on BUTTON_2's pin, so one button goes both ways:
+  // press for the next page, hold to go back, page by page
+  buttonInput.add(BUTTON_1, LV_KEY_RIGHT, LV_KEY_LEFT, true);
+#endif
+  buttonInput.addWakePin(TWATCH_TOUCH_INT);
+  idleScheduler.addWakePin(BUTTON_1, LOW);
+  idleScheduler.addWakePin(TWATCH_TOUCH_INT, LOW);
+
+#ifdef MOTOR_PIN
+  pinMode(MOTOR_PIN, OUTPUT);
+  digitalWrite(MOTOR_PIN, LOW);
+#endif
+  if (!warm)
+  {
+    // Vibrate on startup
+    Serial.println("Vibrating...");
+    delay(200);
+  }
 
   Wire.begin(TWATCH_IICSDA, TWATCH_IICSCL);
   touch.begin(Wire, TWATCH_TOUCH_RES, TWATCH_TOUCH_INT);
+  touchInput.onGesture(onTouchGesture);
+  touchInput.onQueued(wakeUi);
+  if (!touchInput.begin(&touch, TWATCH_TOUCH_INT))
+  {
+    Serial.println("Failed to start touch task");
+  }
 
   Serial.println("Initializing display...");
   tft.begin();
   tft.setRotation(0);
   tft.setSwapBytes(true);
-  tft.pushImage(0, 0, 240, 240, (uint16_t *)logo_map);
+  if (!warm)
+  {
+    tft.pushImage(0, 0, 240, 240, (uint16_t *)logo_map);
+    delay(1000);
+  }
 
-  delay(1000);
   Serial.println("Initializing LVGL...");
   lv_init();
 
-  size_t buffer_size = sizeof(lv_color_t) * EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES;
-  buf = (lv_color_t *)ps_malloc(buffer_size);
-  if (buf == NULL)
+  if (!displayDriver.begin(&tft, EXAMPLE_LCD_H_RES, EXAMPLE_LCD_V_RES))
   {
     Serial.println("Failed to allocate display buffer");
     while (1)
@@ -166,80 +355,261 @@ void setup()
       delay(500);
     }
   }
-  lv_disp_draw_buf_init(&draw_buf, buf, NULL, buffer_size);
-
-  static lv_disp_drv_t disp_drv;
-  lv_disp_drv_init(&disp_drv);
-  disp_drv.hor_res = EXAMPLE_LCD_H_RES;
-  disp_drv.ver_res = EXAMPLE_LCD_V_RES;
-  disp_drv.flush_cb = my_disp_flush;
-  disp_drv.draw_buf = &draw_buf;
-  lv_disp_drv_register(&disp_drv);
 
   static lv_indev_drv_t indev_drv;
   lv_indev_drv_init(&indev_drv);
   indev_drv.type = LV_INDEV_TYPE_POINTER;
   indev_drv.read_cb = my_touchpad_read;
-  lv_indev_drv_register(&indev_drv);
+  touchIndev = lv_indev_drv_register(&indev_drv);
 
-  Serial.println("Initializing EEPROM...");
-  EEPROM.begin(sizeof(CachedData) * numCoins);
-  EEPROM.get(0, cachedPrices);
+  static lv_indev_drv_t keypad_drv;
+  lv_indev_drv_init(&keypad_drv);
+  keypad_drv.type = LV_INDEV_TYPE_KEYPAD;
+  keypad_drv.read_cb = my_keypad_read;
+  buttonIndev = lv_indev_drv_register(&keypad_drv);
+  bootTimeline.mark(BOOT_DISPLAY);
+
+  logPrintf("Watchlist: %u coins%s\n", coinStore.count, warm ? ", resuming from deep sleep" : "");
+  priceHistory.begin(coinStore.hash());
+
+  Serial.println("Loading cached prices...");
+  bool logged = priceFlash.begin(PRICE_LOG_SECTORS) && priceLog.begin(&priceFlash, coinStore.hash(), coinStore.count);
+  for (int i = 0; i < coinStore.count; i++)
+  {
+    price_fx_t price;
+    int32_t changeBp;
+    // The values kept through deep sleep are newer than the last log commit
+    if (wakeState.get(i, &price, &changeBp) || (logged && priceLog.get(i, &price, &changeBp)))
+    {
+      coinStore.record[i].push(price, changeBp, millis());
+      coinStore.record[i].flags |= PRICE_RECORD_CACHED;
+    }
+  }
+
+  // The saved rules carry their state; PRICE_ALERTS only seeds them
+  alertEngine.begin(onAlert);
+  alertRulesKey = alertKey(coinStore, PRICE_ALERTS);
+  if (!alertEngine.load(alertRulesKey))
+  {
+    if (alertEngine.parse(coinStore, PRICE_ALERTS) < 0)
+    {
+      Serial.println("Invalid PRICE_ALERTS rule");
+    }
+    alertEngine.save(alertRulesKey);
+  }
+  logPrintf("Alerts: %d rules\n", alertEngine.count());
+
+  priceAggregator.add(&binanceSource);
+#ifdef BITFINEX_HOST
+  priceAggregator.add(&bitfinexSource);
+#endif
+#ifdef PRICE_CONSENSUS
+  priceAggregator.setConsensus(true);
+#endif
+
+  // WiFi and HTTP run on their own task so they never stall the UI; started
+  // first so associating overlaps building the UI
+  if (!fetchWorker.begin(fetchPrices, NULL, PRICE_REFRESH_MS))
+  {
+    Serial.println("Failed to start fetch task");
+  }
 
   Serial.println("Creating LVGL UI...");
   lvgl_test();
+  int page = wakeState.page();
+  if (page > 0 && page <= coinStore.count)
+  {
+    tilePager.show(page);
+  }
+  lv_refr_now(NULL);
+  displayDriver.sync();
+  digitalWrite(TFT_BL, HIGH);
+  bootTimeline.mark(BOOT_FIRST_FRAME);
+  logPrintf("First frame after %u ms\n", bootTimeline.ms(BOOT_FIRST_FRAME));
 
-  Serial.println("LVGL UI created");
-
-  initWiFi();
+  if (!displayDriver.tuned())
+  {
+    displayDriver.tune(); // first boot with this build: pick the strip height
+  }
 
+  Serial.println("LVGL UI created");
   Serial.println("Setup complete");
 }
 
 void lvgl_test(void)
 {
-  dis = lv_tileview_create(lv_scr_act());
+  lv_obj_t *dis = tilePager.begin(lv_scr_act(), coinStore.count, create_crypto_watch, bind_crypto_watch);
   lv_obj_align(dis, LV_ALIGN_TOP_RIGHT, 0, 0);
   lv_obj_set_size(dis, LV_PCT(100), LV_PCT(100));
   lv_obj_set_style_bg_color(dis, lv_color_hex(0x000000), LV_PART_MAIN);
+  // The buttons' keys go to the tileview, which pages instead of scrolling a bit
+  lv_obj_clear_flag(dis, LV_OBJ_FLAG_SCROLL_WITH_ARROW);
+  lv_obj_add_event_cb(dis, onNavKey, LV_EVENT_KEY, NULL);
+  lv_group_t *navGroup = lv_group_create();
+  lv_group_add_obj(navGroup, dis);
+  lv_indev_set_group(buttonIndev, navGroup);
+
+  lv_obj_t *system_info = lv_obj_create(lv_scr_act()); // moved into a tile by the pager
+  lv_obj_remove_style_all(system_info);
+  lv_obj_set_size(system_info, LV_PCT(100), LV_PCT(100));
+  create_system_info(system_info);
+  tilePager.setInfoPage(system_info);
+
+  priceTimer = lv_timer_create(updateCryptoPrice, PRICE_APPLY_MS, NULL); // Apply snapshots from the fetch task
+  systemInfoTimer = lv_timer_create(updateSystemInfo, 1000, NULL);      // Update system info every second
+  lv_timer_create(logStats, DISPLAY_STATS_MS, NULL);
+  tilePager.onViewChanged(onPagerViewChanged);
+  onPagerViewChanged();
+#ifdef BATTERY_ADC_PIN
+  lv_timer_ready(lv_timer_create(checkBattery, BATTERY_CHECK_MS, NULL));
+#endif
+}
 
-  for (int i = 0; i < numCoins; i++)
-  {
-    lv_obj_t *tv = lv_tileview_add_tile(dis, i, 0, LV_DIR_HOR);
-    create_crypto_watch(tv, i);
-  }
-
-  lv_obj_t *system_info_tile = lv_tileview_add_tile(dis, numCoins, 0, LV_DIR_HOR);
-  create_system_info(system_info_tile);
+// Builds the widgets of one recycled coin tile; bind_crypto_watch() fills them
+void create_crypto_watch(CoinTile &tile)
+{
+  lv_obj_t *parent = tile.tile;
+  tile.meter = lv_meter_create(parent);
+  lv_obj_center(tile.meter);
+  lv_obj_set_size(tile.meter, 240, 240);
+
+  lv_meter_scale_t *scale = lv_meter_add_scale(tile.meter);
+  lv_meter_set_scale_ticks(tile.meter, scale, 21, 2, 10, lv_palette_main(LV_PALETTE_GREY));
+  lv_meter_set_scale_major_ticks(tile.meter, scale, 5, 4, 15, lv_color_black(), 10);
+  lv_meter_set_scale_range(tile.meter, scale, -10, 10, 270, 135); // -10% to +10%, 270 degree arc
+
+  tile.needle = lv_meter_add_needle_line(tile.meter, scale, 4, lv_palette_main(LV_PALETTE_RED), -10);
+  lv_meter_enable_scale_cache(tile.meter, true); // one image for every tile, only the needles move
+
+  tile.priceLabel = lv_label_create(parent);
+  lv_obj_align(tile.priceLabel, LV_ALIGN_CENTER, 0, 20);
+
+  tile.changeLabel = lv_label_create(parent);
+  lv_obj_align(tile.changeLabel, LV_ALIGN_CENTER, 0, 40);
+
+  tile.nameLabel = lv_label_create(parent);
+  lv_obj_align(tile.nameLabel, LV_ALIGN_TOP_MID, 0, 10);
+
+  // Sparkline with a low/high band; the series point at PriceHistory's rings
+  tile.chart = lv_chart_create(parent);
+  lv_obj_set_size(tile.chart, 120, 40);
+  lv_obj_align(tile.chart, LV_ALIGN_BOTTOM_MID, 0, -30);
+  lv_obj_set_style_bg_opa(tile.chart, LV_OPA_TRANSP, 0);
+  lv_obj_set_style_border_width(tile.chart, 0, 0);
+  lv_obj_set_style_pad_all(tile.chart, 0, 0);
+  lv_obj_set_style_size(tile.chart, 0, LV_PART_INDICATOR); // no point markers
+  lv_obj_set_style_line_width(tile.chart, 2, LV_PART_ITEMS);
+  lv_chart_set_div_line_count(tile.chart, 0, 0);
+  lv_chart_set_point_count(tile.chart, HISTORY_POINTS);
+  tile.lowSeries = lv_chart_add_series(tile.chart, lv_palette_darken(LV_PALETTE_GREY, 2), LV_CHART_AXIS_PRIMARY_Y);
+  tile.highSeries = lv_chart_add_series(tile.chart, lv_palette_darken(LV_PALETTE_GREY, 2), LV_CHART_AXIS_PRIMARY_Y);
+  tile.lastSeries = lv_chart_add_series(tile.chart, lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_PRIMARY_Y);
+  lv_obj_add_event_cb(tile.chart, cycleChartResolution, LV_EVENT_CLICKED, NULL);
+}
 
-  lv_timer_create(updateCryptoPrice, 60000 * 5, NULL); // Update every 60 seconds
-  lv_timer_create(updateSystemInfo, 1000, NULL);       // Update system info every second
+void cycleChartResolution(lv_event_t *e)
+{
+  chartResolution = (HistoryResolution)((chartResolution + 1) % HISTORY_RESOLUTIONS);
+  tilePager.refreshAll();
 }
 
-void create_crypto_watch(lv_obj_t *parent, int index)
+void bind_history_chart(CoinTile &tile, int coin)
 {
-  meters[index] = lv_meter_create(parent);
-  lv_obj_center(meters[index]);
-  lv_obj_set_size(meters[index], 240, 240);
+  const HistoryRing *ring = priceHistory.ring(coin, chartResolution);
+  lv_coord_t min, max;
+  if (ring == NULL || !ring->range(&min, &max))
+  {
+    lv_obj_add_flag(tile.chart, LV_OBJ_FLAG_HIDDEN);
+    return;
+  }
+  lv_obj_clear_flag(tile.chart, LV_OBJ_FLAG_HIDDEN);
 
-  lv_meter_scale_t *scale = lv_meter_add_scale(meters[index]);
-  lv_meter_set_scale_ticks(meters[index], scale, 21, 2, 10, lv_palette_main(LV_PALETTE_GREY));
-  lv_meter_set_scale_major_ticks(meters[index], scale, 5, 4, 15, lv_color_black(), 10);
-  lv_meter_set_scale_range(meters[index], scale, -10, 10, 270, 135); // -10% to +10%, 270 degree arc
+  // No copies: the chart reads the ring in place, starting at its oldest point.
+  // Re-pointing a series invalidates the chart, so only do it on a rebind.
+  lv_chart_series_t *series[] = {tile.lastSeries, tile.lowSeries, tile.highSeries};
+  const lv_coord_t *arrays[] = {ring->last, ring->low, ring->high};
+  for (int i = 0; i < 3; i++)
+  {
+    if (lv_chart_get_y_array(tile.chart, series[i]) != arrays[i])
+      lv_chart_set_ext_y_array(tile.chart, series[i], const_cast<lv_coord_t *>(arrays[i])); // only read
+    lv_chart_set_x_start_point(tile.chart, series[i], ring->oldest());
+  }
+  lv_coord_t pad = (max - min) / 10 + 1;
+  lv_chart_set_range(tile.chart, LV_CHART_AXIS_PRIMARY_Y, min - pad, max + pad); // also refreshes
+}
 
-  price_indicators[index] = lv_meter_add_needle_line(meters[index], scale, 4, lv_palette_main(LV_PALETTE_RED), -10);
+// Copies text into the label's static buffer only if it differs from what is shown
+void setLabelText(lv_obj_t *label, char *shown, size_t size, const char *text)
+{
+  if (lv_label_get_text(label) == shown && strcmp(shown, text) == 0)
+  {
+    return;
+  }
+  strncpy(shown, text, size - 1);
+  shown[size - 1] = '\0';
+  lv_label_set_text_static(label, shown);
+  bindStats.widgetUpdates++;
+}
 
-  price_labels[index] = lv_label_create(parent);
-  lv_obj_align(price_labels[index], LV_ALIGN_CENTER, 0, 20);
-  lv_label_set_text(price_labels[index], "Loading...");
+void bind_crypto_watch(CoinTile &tile, int coin)
+{
+  if (lv_label_get_text(tile.nameLabel) != coinStore.symbol[coin])
+  {
+    lv_label_set_text_static(tile.nameLabel, coinStore.symbol[coin]);
+    bindStats.widgetUpdates++;
+  }
+  bind_history_chart(tile, coin);
+
+  // Only widgets whose text, position or colour changed are touched; each
+  // setter invalidates its area even if the value is the same
+  const PriceRecord &record = coinStore.record[coin];
+  char text[sizeof(tile.priceText)];
+  int needle = 0;
+  int trend = 0;
+  if (!record.hasPrice())
+  {
+    setLabelText(tile.priceLabel, tile.priceText, sizeof(tile.priceText), "Loading...");
+    setLabelText(tile.changeLabel, tile.changeText, sizeof(tile.changeText), "24h: --");
+  }
+  else
+  {
+    int32_t changeBp = record.changeBp;
+    formatDisplayPrice(text, sizeof(text), record.price(), record.decimals, PRICE_SIG_DIGITS);
+    setLabelText(tile.priceLabel, tile.priceText, sizeof(tile.priceText), text);
+    formatChangeBp(text, sizeof(text), changeBp);
+    setLabelText(tile.changeLabel, tile.changeText, sizeof(tile.changeText), text);
+    needle = constrain(changeBp / 100, -10, 10); // whole percent on a -10..10 scale
+    trend = (changeBp > 0) - (changeBp < 0);
+  }
 
-  change_labels[index] = lv_label_create(parent);
-  lv_obj_align(change_labels[index], LV_ALIGN_CENTER, 0, 40);
-  lv_label_set_text(change_labels[index], "24h: --");
+  if (needle != tile.shownNeedle)
+  {
+    lv_meter_set_indicator_value(tile.meter, tile.needle, needle);
+    tile.shownNeedle = needle;
+    bindStats.widgetUpdates++;
+  }
 
-  lv_obj_t *coin_name = lv_label_create(parent);
-  lv_obj_align(coin_name, LV_ALIGN_TOP_MID, 0, 10);
-  lv_label_set_text(coin_name, coins[index]);
+  // Change color based on price change
+  if (trend != tile.shownTrend)
+  {
+    lv_color_t color;
+    if (trend > 0)
+    {
+      color = lv_palette_main(LV_PALETTE_GREEN);
+    }
+    else if (trend < 0)
+    {
+      color = lv_palette_main(LV_PALETTE_RED);
+    }
+    else
+    {
+      color = lv_palette_main(LV_PALETTE_GREY);
+    }
+    lv_obj_set_style_text_color(tile.priceLabel, color, 0);
+    lv_obj_set_style_text_color(tile.changeLabel, color, 0);
+    tile.shownTrend = trend;
+    bindStats.widgetUpdates++;
+  }
 }
 
 void create_system_info(lv_obj_t *parent)
@@ -261,191 +631,552 @@ void create_system_info(lv_obj_t *parent)
   lv_label_set_text(last_update_label, "Last update: --:--:--");
 }
 
+// Called by the aggregator with each coin's merged quote
+void updateCachedPrice(int coin, price_fx_t price, int32_t changeBp)
+{
+  priceFeed.set(coin, price, changeBp);
+  refreshScheduler.onPrice(coin, price, millis());
+  alertEngine.onTick(coin, price, time(NULL));
+
+  char text[24];
+  formatPrice(text, sizeof(text), price, priceDecimals(price));
+  logPrintf("Updated %s: Price: $%s, Change: %d bp\n", coinStore.symbol[coin], text, (int)changeBp);
+
+  // Update cached data; only coins whose values changed are written
+  priceLog.set(coin, price, changeBp);
+}
+
+// Requests the symbols the scheduler says are due, in one batch
 void getCryptoPrices()
 {
-  Serial.println("Fetching crypto prices...");
-  HTTPClient http;
-  String url = String(API_HOST) + "/api/crypto?symbols=";
-  for (int i = 0; i < numCoins; i++)
+  int coins[MAX_COINS];
+  int count = refreshScheduler.take(millis(), coins);
+  if (count == 0)
   {
-    url += coins[i];
-    if (i < numCoins - 1)
-      url += ",";
+    return;
   }
-  http.begin(url);
-  int httpCode = http.GET();
-
-  Serial.printf("HTTP response code: %d\n", httpCode);
-
-  if (httpCode == HTTP_CODE_OK)
+  logPrintf("Fetching %d of %u crypto prices...\n", count, coinStore.count);
+  AggregateStatus status = priceAggregator.fetch(coinStore, coins, count, updateCachedPrice);
+  const TickerParseStats &parsed = priceAggregator.lastParse();
+  logPrintf("Parsed %u tickers from %u bytes in %u us, peak document %u bytes\n",
+            (unsigned)parsed.count, (unsigned)parsed.bytesRead, priceAggregator.parseTimings().lastUs,
+            (unsigned)parsed.peakDocUsage);
+
+  if (status == AGG_OK)
   {
-    String payload = http.getString();
-    DynamicJsonDocument doc(1024 * numCoins);
-    DeserializationError error = deserializeJson(doc, payload);
-
-    if (!error)
-    {
-      for (int i = 0; i < numCoins; i++)
-      {
-        float price = doc[i]["lastPrice"];
-        coinInfos[i].currentPrice = String(price, 3);
-        coinInfos[i].priceChangePercentage = doc[i]["priceChangePercent"];
+    refreshScheduler.onSuccess();
+    time_t now;
+    time(&now);
+    priceFeed.publish(priceMailbox, coinStore.count, now, false);
+    idleScheduler.wake();
 
-        // Update cached data
-        cachedPrices[i].price = price;
-        cachedPrices[i].change = coinInfos[i].priceChangePercentage;
-        cachedPrices[i].timestamp = millis();
-
-        Serial.printf("Updated %s: Price: $%s, Change: %.2f%%\n", coins[i], coinInfos[i].currentPrice.c_str(), coinInfos[i].priceChangePercentage);
-      }
-      EEPROM.put(0, cachedPrices);
-      EEPROM.commit();
-
-      // Update last update time
-      time_t now;
-      time(&now);
-      char buffer[20];
-      strftime(buffer, sizeof(buffer), "%H:%M:%S", localtime(&now));
-      if (last_update_label != NULL)
-      {
-        lv_label_set_text(last_update_label, (String("Last update: ") + buffer).c_str());
-      }
-    }
-    else
+    if (!priceLog.commit())
     {
-      Serial.println("Failed to parse JSON");
+      Serial.println("Failed to write price log");
     }
+    logPrintf("Price log: %u bytes written, %u sector erases\n", priceLog.bytesWritten(), priceLog.sectorErases());
+    saveAlerts();
+  }
+  else if (status == AGG_RATE_LIMITED)
+  {
+    Serial.println("Rate limited");
+    refreshScheduler.onRateLimited(millis(), priceAggregator.retryAfterMs());
   }
   else
   {
     Serial.println("Failed to fetch crypto prices");
+    refreshScheduler.onFailure(millis(), REFRESH_FAIL_HTTP);
   }
-  http.end();
+  logRefreshStats();
+  logSourceStats();
 }
 
-void updateCryptoPrice(lv_timer_t *timer)
+// Per source: answers, latency and the connections behind them
+void logSourceStats()
 {
-  Serial.println("Updating crypto prices...");
-  if (WiFi.status() == WL_CONNECTED)
+  for (int i = 0; i < priceAggregator.count(); i++)
   {
-    getCryptoPrices();
-    for (int i = 0; i < numCoins; i++)
-    {
-      lv_label_set_text(price_labels[i], coinInfos[i].currentPrice.c_str());
-
-      int meterValue = map(coinInfos[i].priceChangePercentage * 10, -100, 100, -10, 10);
-      lv_meter_set_indicator_value(meters[i], price_indicators[i], meterValue);
+    const SourceStats &stats = priceAggregator.stats(i);
+    const FetchTimings &timings = priceAggregator.timings(i);
+    logPrintf("Source %s%s: %u requests, %u failures, %u rate limited, errors %u.%u%%; latency %u ms, "
+              "p50 < %u ms, p95 < %u ms\n",
+              priceAggregator.name(i), i == priceAggregator.primary() ? " (primary)" : "", stats.requests,
+              stats.failures, stats.rateLimited, stats.errorPermille / 10, stats.errorPermille % 10, stats.latencyMs,
+              stats.latency.percentile(50), stats.latency.percentile(95));
+    logPrintf("  connections: %u new, %u reused, %u failed; handshake %u ms (total %u), transfer %u ms (total %u)\n",
+              timings.handshakes, timings.reused, timings.failures, timings.lastHandshakeMs, timings.totalHandshakeMs,
+              timings.lastTransferMs, timings.totalTransferMs);
+  }
+}
 
-      String changeText = "24h: " + String(coinInfos[i].priceChangePercentage, 2) + "%";
-      lv_label_set_text(change_labels[i], changeText.c_str());
+#ifdef PRICE_STREAM_URL
+// Feeds streamed ticks to the UI until the stream drops. Returns true if it
+// had been up long enough that reconnecting at once is worth a try.
+bool streamPrices()
+{
+  if (!priceStream.connect(PRICE_STREAM_URL, coinStore))
+  {
+    Serial.println("Price stream unavailable");
+    return false;
+  }
+  Serial.println("Price stream connected");
+  priceAggregator.stop(); // no need to keep more TLS sessions around
 
-      // Change color based on price change
-      lv_color_t color;
-      if (coinInfos[i].priceChangePercentage > 0)
-      {
-        color = lv_palette_main(LV_PALETTE_GREEN);
-      }
-      else if (coinInfos[i].priceChangePercentage < 0)
-      {
-        color = lv_palette_main(LV_PALETTE_RED);
-      }
-      else
+  uint32_t lastPublish = millis();
+  uint32_t lastCommit = lastPublish;
+  int hint = 0;
+  while (!fetchWorker.stopping())
+  {
+    StreamResult result = priceStream.next(PRICE_PUBLISH_MS);
+    if (result == STREAM_CLOSED)
+    {
+      break;
+    }
+    if (result == STREAM_TICKER)
+    {
+      int coin = findTickerCoin(coinStore, priceStream.symbol(), hint);
+      if (coin >= 0)
       {
-        color = lv_palette_main(LV_PALETTE_GREY);
+        priceFeed.set(coin, priceStream.price(), priceStream.changeBp());
+        priceLog.set(coin, priceStream.price(), priceStream.changeBp());
+        refreshScheduler.onPrice(coin, priceStream.price(), millis());
+        alertEngine.onTick(coin, priceStream.price(), time(NULL));
+        hint = coin + 1; // the server cycles through the subscriptions
       }
-      lv_obj_set_style_text_color(price_labels[i], color, 0);
-      lv_obj_set_style_text_color(change_labels[i], color, 0);
+    }
 
-      if (abs(coinInfos[i].priceChangePercentage) > 5.0)
-      {
-        delay(200);
-      }
+    uint32_t now = millis();
+    if (now - lastPublish >= PRICE_PUBLISH_MS)
+    {
+      time_t updatedAt;
+      time(&updatedAt);
+      priceFeed.publish(priceMailbox, coinStore.count, updatedAt, true);
+      idleScheduler.wake();
+      lastPublish = now;
+    }
+    if (now - lastCommit >= PRICE_LOG_COMMIT_MS)
+    {
+      priceLog.commit();
+      saveAlerts();
+      lastCommit = now;
     }
   }
-  else
+  priceStream.close();
+  priceLog.commit();
+  saveAlerts();
+
+  const StreamStats &stats = priceStream.stats();
+  logPrintf("Price stream closed: %u messages, %u bytes, %u parse errors, %u pings, "
+                "parse avg %u us max %u us; %u ticks published in %u snapshots\n",
+                stats.messages, stats.bytesRead, stats.parseErrors, priceStream.pings(),
+                stats.parse.parses ? stats.parse.totalUs / stats.parse.parses : 0, stats.parse.maxUs,
+                priceFeed.updates(), priceFeed.publishes());
+  return millis() - priceStream.connectedAt() >= STREAM_RETRY_AFTER_MS;
+}
+#endif
+
+// Runs on the fetch task, never on the UI thread
+void fetchPrices(void *ctx)
+{
+  uint32_t wait = refreshScheduler.wait(millis());
+  if (wait > 0)
+  {
+    fetchWorker.runIn(wait); // woken early for a focus change or backing off
+    return;
+  }
+  if (WiFi.status() != WL_CONNECTED)
   {
     Serial.println("WiFi disconnected. Attempting to reconnect...");
-    initWiFi(); // Try to reconnect
+    initWiFi();
+    if (WiFi.status() != WL_CONNECTED)
+    {
+      refreshScheduler.onFailure(millis(), REFRESH_FAIL_WIFI);
+      fetchWorker.runIn(refreshScheduler.wait(millis()));
+      return;
+    }
+  }
+#ifdef PRICE_STREAM_URL
+  while (streamPrices() && !fetchWorker.stopping())
+  {
+  }
+  if (fetchWorker.stopping())
+  {
+    return;
+  }
+  Serial.println("Polling until the stream is back");
+#endif
+  getCryptoPrices();
+  fetchWorker.runIn(refreshScheduler.wait(millis()));
+}
+
+// Radio use against how old each price got before it was replaced
+void logRefreshStats()
+{
+  uint32_t now = millis();
+  const RefreshStats &stats = refreshScheduler.stats();
+  logPrintf("Refresh: %u requests (%u in the last hour, %u symbols), %u failures (%u WiFi), "
+                "%u rate limited, next in %u s\n",
+                stats.requests, refreshScheduler.requestsLastHour(now), stats.symbolsRequested, stats.failures,
+                stats.wifiFailures, stats.rateLimited, refreshScheduler.wait(now) / 1000);
+  for (int i = 0; i < coinStore.count; i++)
+  {
+    uint32_t age = refreshScheduler.ageMs(i, now);
+    logPrintf("  %s: every %u s, age %d s, max %u s\n", coinStore.symbol[i], refreshScheduler.interval(i) / 1000,
+                  age == UINT32_MAX ? -1 : (int)(age / 1000), refreshScheduler.maxAgeMs(i) / 1000);
+  }
+}
+
+// Area waiting for the next refresh; overlapping areas are counted twice,
+// LVGL only merges them when it redraws
+uint32_t invalidatedPixels()
+{
+  lv_disp_t *disp = lv_disp_get_default();
+  uint32_t pixels = 0;
+  for (uint16_t i = 0; i < disp->inv_p; i++)
+  {
+    if (!disp->inv_area_joined[i])
+      pixels += lv_area_get_size(&disp->inv_areas[i]);
+  }
+  return pixels;
+}
+
+// LVGL timer: swaps in the newest snapshot, if any, and updates the labels
+void updateCryptoPrice(lv_timer_t *timer)
+{
+  if (!priceMailbox.consume())
+  {
+    lv_timer_pause(timer); // until loop() sees a fresh snapshot
+    return;
+  }
+  const PriceSnapshot &snapshot = priceMailbox.readSlot();
+  if (!snapshot.streamed)
+  {
+    Serial.println("Updating crypto prices...");
+  }
+  uint32_t now = millis();
+  uint32_t pixelsBefore = invalidatedPixels();
+  uint32_t updatesBefore = bindStats.widgetUpdates;
+  int changedCoins = 0;
+  for (int i = 0; i < coinStore.count; i++)
+  {
+    if (snapshot.seq[i] == appliedSeq[i])
+    {
+      continue; // no tick since the last snapshot, however many came in between
+    }
+    appliedSeq[i] = snapshot.seq[i];
+    feedStats.coinUpdates++;
+    PriceRecord &record = coinStore.record[i];
+    bool changed = !record.hasPrice() || record.price() != snapshot.price[i] ||
+                   record.changeBp != snapshot.changeBp[i];
+    record.push(snapshot.price[i], snapshot.changeBp[i], now);
+    if (priceHistory.add(i, snapshot.price[i], snapshot.updatedAt))
+      changed = true;
+    if (changed)
+    {
+      tilePager.refresh(i); // no-op unless the coin is materialized
+      changedCoins++;
+    }
+  }
+  feedStats.snapshots++;
+  if (bootTimeline.mark(BOOT_FRESH_DATA))
+  {
+    logPrintf("Boot (%s): display %u ms, first frame %u ms, WiFi %u ms, fresh data %u ms\n",
+                  wakeState.warm() ? "warm" : "cold", bootTimeline.ms(BOOT_DISPLAY),
+                  bootTimeline.ms(BOOT_FIRST_FRAME), bootTimeline.ms(BOOT_WIFI), bootTimeline.ms(BOOT_FRESH_DATA));
+  }
+  uint32_t pixels = invalidatedPixels() - pixelsBefore;
+  bindStats.invalidatedPixels += pixels;
+  if (!snapshot.streamed)
+    logPrintf("%d coins changed, %u widget updates, %u px invalidated\n",
+                changedCoins, (unsigned)(bindStats.widgetUpdates - updatesBefore), (unsigned)pixels);
+
+  // Update last update time; the label only changes once a second
+  static char lastUpdateText[40];
+  char buffer[20];
+  strftime(buffer, sizeof(buffer), "%H:%M:%S", localtime(&snapshot.updatedAt));
+  if (last_update_label != NULL)
+  {
+    char text[40];
+    snprintf(text, sizeof(text), "Last update: %s", buffer);
+    setLabelText(last_update_label, lastUpdateText, sizeof(lastUpdateText), text);
   }
-  lv_timer_handler(); // Update the display
 }
 
 void updateSystemInfo(lv_timer_t *timer)
 {
   time_t now;
   time(&now);
-  char buffer[20];
-  strftime(buffer, sizeof(buffer), "%Y-%m-%d", localtime(&now));
-  lv_label_set_text(date_label, (String("Date: ") + buffer).c_str());
+  static char dateText[24];
+  static char timeText[24];
+  char buffer[24];
+  struct tm *local = localtime(&now);
+  strftime(buffer, sizeof(buffer), "Date: %Y-%m-%d", local);
+  setLabelText(date_label, dateText, sizeof(dateText), buffer);
 
-  strftime(buffer, sizeof(buffer), "%H:%M:%S", localtime(&now));
-  lv_label_set_text(time_label, (String("Time: ") + buffer).c_str());
+  strftime(buffer, sizeof(buffer), "Time: %H:%M:%S", local);
+  setLabelText(time_label, timeText, sizeof(timeText), buffer);
 
   // lv_label_set_text(wifi_label, (String("WiFi: ") + (WiFi.status() == WL_CONNECTED ? WiFi.SSID() : "Disconnected")).c_str());
+}
 
-  lv_timer_handler(); // Update the display
+void onPagerViewChanged()
+{
+  static int focus = -2;
+  syncSystemInfoTimer();
+  int coin = tilePager.currentCoin();
+  if (coin != focus)
+  {
+    focus = coin;
+    refreshScheduler.focus(coin);
+    fetchWorker.requestRefresh(); // the coin on screen has a shorter deadline
+  }
 }
 
-void handleButtons()
+#ifdef BATTERY_ADC_PIN
+#define BATTERY_CHECK_MS 60000
+#define BATTERY_LOW_MV 3600 // below this the scheduler polls less often
+
+// The cell is read through a 1:2 divider
+void checkBattery(lv_timer_t *timer)
 {
-  static bool lastButton1State = HIGH;
-  static bool lastButton2State = HIGH;
-  bool currentButton1State = digitalRead(BUTTON_1);
-  bool currentButton2State = digitalRead(BUTTON_2);
+  refreshScheduler.setLowPower(analogReadMilliVolts(BATTERY_ADC_PIN) * 2 < BATTERY_LOW_MV);
+}
+#endif
 
-  if (lastButton1State == HIGH && currentButton1State == LOW)
+// The clock on the info page only ticks while the page can be seen
+void syncSystemInfoTimer()
+{
+  if (!tilePager.pageInView(coinStore.count))
   {
-    if (digitalRead(TFT_BL) == LOW)
-    {
-      digitalWrite(TFT_BL, HIGH);
-    }
+    lv_timer_pause(systemInfoTimer);
+  }
+  else if (systemInfoTimer->paused)
+  {
+    lv_timer_resume(systemInfoTimer);
+    lv_timer_ready(systemInfoTimer); // don't show a stale time
+  }
+}
 
-    currentCoinIndex = (currentCoinIndex + 1) % (numCoins + 1); // +1 for system info page
-    lv_obj_set_tile_id(dis, currentCoinIndex, 0, LV_ANIM_ON);
-    lastInteractionTime = millis();
-    if (currentCoinIndex < numCoins && coinInfos[currentCoinIndex].currentPrice == "Loading...")
-    {
-      updateCryptoPrice(NULL); // Trigger an update if there's no current price
-    }
+void logStats(lv_timer_t *timer)
+{
+  logDisplayStats();
+  logIdleStats();
+}
+
+// How often the UI loop woke up and how much of the time it was busy
+void logIdleStats()
+{
+  static IdleStats last;
+  static uint32_t lastMs;
+  uint32_t now = millis();
+  const IdleStats &stats = idleScheduler.stats();
+  uint32_t elapsed = now - lastMs;
+  uint32_t wakeups = stats.wakeups - last.wakeups;
+  uint64_t busy = stats.busyUs - last.busyUs;
+  uint64_t total = busy + stats.idleUs - last.idleUs;
+  logPrintf("Idle%s: %u.%u wakeups/s (%u by events), CPU duty %u.%u%%\n",
+                idleScheduler.lightSleep() ? " (light sleep)" : "",
+                (unsigned)(wakeups * 1000 / elapsed), (unsigned)(wakeups * 10000 / elapsed % 10),
+                (unsigned)(stats.eventWakeups - last.eventWakeups),
+                (unsigned)(total ? busy * 100 / total : 0), (unsigned)(total ? busy * 1000 / total % 10 : 0));
+  last = stats;
+  lastMs = now;
+}
+
+// Frame rate and how much of the SPI transfer time still stalls rendering
+void logDisplayStats()
+{
+  static DisplayStats last;
+  static uint32_t lastMs;
+  uint32_t now = millis();
+  const DisplayStats &stats = displayDriver.stats();
+  uint32_t elapsed = now - lastMs;
+  uint32_t frames = stats.frames - last.frames;
+  logPrintf("Display (%s, %u lines): %u.%u fps, %u flushes, %u px, render %u ms, flush wait %u x %u us\n",
+                displayDriver.usesDma() ? "dma" : "blocking", displayDriver.stripLines(),
+                (unsigned)(frames * 1000 / elapsed), (unsigned)(frames * 10000 / elapsed % 10),
+                (unsigned)(stats.flushes - last.flushes), (unsigned)(stats.pixels - last.pixels),
+                (unsigned)(stats.renderMs - last.renderMs), (unsigned)(stats.flushWaits - last.flushWaits),
+                (unsigned)(stats.flushWaitUs - last.flushWaitUs));
+  last = stats;
+  lastMs = now;
+}
+
+// True unless the page we are moving to is a coin that has no price yet
+bool hasPriceNextTo(int step)
+{
+  int pages = coinStore.count + 1; // +1 for system info page
+  int page = (tilePager.page() + step + pages) % pages;
+  return page == coinStore.count || coinStore.record[page].hasPrice();
+}
+
+// LV_KEY_RIGHT/LEFT from the buttons
+void onNavKey(lv_event_t *e)
+{
+  uint32_t key = lv_event_get_key(e);
+  if (key != LV_KEY_RIGHT && key != LV_KEY_LEFT)
+  {
+    return;
+  }
+  if (digitalRead(TFT_BL) == LOW)
+  {
+    digitalWrite(TFT_BL, HIGH);
   }
 
-  if (lastButton2State == HIGH && currentButton2State == LOW)
+  int step = key == LV_KEY_RIGHT ? 1 : -1;
+  bool cached = hasPriceNextTo(step);
+  if (step > 0)
   {
-    if (digitalRead(TFT_BL) == LOW)
-    {
-      digitalWrite(TFT_BL, HIGH);
-    }
+    tilePager.next();
+  }
+  else
+  {
+    tilePager.prev();
+  }
+  lastInteractionTime = millis();
+  if (!cached)
+  {
+    refreshNow(); // Trigger an update if there's no current price
+  }
+}
 
-    currentCoinIndex = (currentCoinIndex + numCoins) % (numCoins + 1); // +1 for system info page
-    lv_obj_set_tile_id(dis, currentCoinIndex, 0, LV_ANIM_ON);
-    lastInteractionTime = millis();
-    if (currentCoinIndex < numCoins && coinInfos[currentCoinIndex].currentPrice == "Loading...")
-    {
-      updateCryptoPrice(NULL); // Trigger an update if there's no current price
-    }
+// Polls every symbol as soon as backoff and rate limits allow
+void refreshNow()
+{
+  refreshScheduler.requestNow();
+  fetchWorker.requestRefresh();
+}
+
+// Fetch task: hands a fired alert to the UI, waking it if it idles
+void onAlert(const AlertEvent &event)
+{
+  if (!alertRing.push(event))
+  {
+    Serial.println("Alert dropped");
+  }
+  idleScheduler.wake();
+}
+
+// Fetch task: keeps the rules' fired state across reboots
+void saveAlerts()
+{
+  if (alertEngine.dirty() && !alertEngine.save(alertRulesKey))
+  {
+    Serial.println("Failed to save alerts");
+  }
+}
+
+// First the end of the motor pulse, then the end of the alert on screen
+void endAlert(lv_timer_t *timer)
+{
+#ifdef MOTOR_PIN
+  if (digitalRead(MOTOR_PIN) == HIGH)
+  {
+    digitalWrite(MOTOR_PIN, LOW);
+    lv_timer_set_period(timer, ALERT_SHOW_MS - ALERT_BUZZ_MS);
+    return;
+  }
+#endif
+  lv_obj_add_flag(alertLabel, LV_OBJ_FLAG_HIDDEN);
+  lv_timer_pause(timer);
+}
+
+// Shows the alert over whatever page is open and turns the screen on; no
+// blocking, the label and the motor are switched off by alertTimer
+void showAlert(const AlertEvent &event)
+{
+  const char *symbol = coinStore.symbol[event.coin];
+  uint8_t decimals = coinStore.record[event.coin].decimals;
+  char price[24];
+  char text[64];
+  formatDisplayPrice(price, sizeof(price), event.reference, decimals, PRICE_SIG_DIGITS);
+  if (event.type == ALERT_ABOVE || event.type == ALERT_BELOW)
+  {
+    snprintf(text, sizeof(text), "%s %s\n%s", symbol, event.type == ALERT_ABOVE ? "above" : "below", price);
+  }
+  else if (event.type == ALERT_MOVE)
+  {
+    int32_t bp = changeBpFromPrices(event.price, event.reference);
+    snprintf(text, sizeof(text), "%s %c%d.%02d%%\nin %u min", symbol, bp < 0 ? '-' : '+', (int)(abs(bp) / 100),
+             (int)(abs(bp) % 100), event.periods);
+  }
+  else
+  {
+    snprintf(text, sizeof(text), "%s %s its\n%u min average", symbol,
+             event.price > event.reference ? "rose above" : "fell below", event.periods);
   }
+  logPrintf("Alert: %s\n", text);
 
-  lastButton1State = currentButton1State;
-  lastButton2State = currentButton2State;
+  if (alertLabel == NULL)
+  {
+    alertLabel = lv_label_create(lv_layer_top());
+    lv_obj_set_style_bg_color(alertLabel, lv_palette_main(LV_PALETTE_ORANGE), 0);
+    lv_obj_set_style_bg_opa(alertLabel, LV_OPA_COVER, 0);
+    lv_obj_set_style_pad_all(alertLabel, 8, 0);
+    lv_obj_set_style_radius(alertLabel, 8, 0);
+    lv_obj_set_style_text_align(alertLabel, LV_TEXT_ALIGN_CENTER, 0);
+    lv_obj_align(alertLabel, LV_ALIGN_CENTER, 0, 0);
+    alertTimer = lv_timer_create(endAlert, ALERT_SHOW_MS, NULL);
+  }
+  lv_label_set_text(alertLabel, text);
+  lv_obj_clear_flag(alertLabel, LV_OBJ_FLAG_HIDDEN);
+
+#ifdef MOTOR_PIN
+  digitalWrite(MOTOR_PIN, HIGH);
+  lv_timer_set_period(alertTimer, ALERT_BUZZ_MS);
+#else
+  lv_timer_set_period(alertTimer, ALERT_SHOW_MS);
+#endif
+  lv_timer_reset(alertTimer);
+  lv_timer_resume(alertTimer);
+
+  if (digitalRead(TFT_BL) == LOW)
+  {
+    digitalWrite(TFT_BL, HIGH);
+  }
+  lastInteractionTime = millis(); // long enough to be read
 }
 
 void enterSleepMode()
 {
   digitalWrite(TFT_BL, LOW);
-  esp_sleep_enable_ext0_wakeup((gpio_num_t)BUTTON_1, LOW);
-  esp_sleep_enable_ext0_wakeup((gpio_num_t)BUTTON_2, LOW);
+  displayDriver.sync(); // don't cut a DMA transfer short
+  priceHistory.save(); // RTC memory survives deep sleep
+  wakeState.save(coinStore, tilePager.page());
+  buttonInput.enableWakeup();
   esp_deep_sleep_start();
 }
 
 void loop()
 {
-  lv_timer_handler();
-  handleButtons();
+  if (buttonInput.busy())
+  {
+    lv_timer_resume(buttonIndev->driver->read_timer);
+  }
+  if (priceMailbox.fresh())
+  {
+    lv_timer_resume(priceTimer);
+  }
+  if (touchInput.queued())
+  {
+    lv_timer_resume(touchIndev->driver->read_timer);
+  }
+  AlertEvent alert;
+  while (alertRing.pop(&alert))
+  {
+    showAlert(alert);
+  }
+  uint32_t next = lv_timer_handler(); // ms until an LVGL timer is due
 
-  if (lastInteractionTime > 0 && (millis() - lastInteractionTime) > sleepDelay)
+  uint32_t idle = millis() - lastInteractionTime;
+  if (lastInteractionTime > 0 && idle > sleepDelay)
   {
     enterSleepMode();
   }
-
-  delay(5);
+  if (lastInteractionTime > 0)
+  {
+    next = min(next, (uint32_t)(sleepDelay - idle + 1));
+  }
+  // Sleeps until a timer is due, or earlier on touch, a button or a new snapshot
+  idleScheduler.idle(min(next, (uint32_t)LOOP_MAX_IDLE_MS));
 }
\ No newline at end of file
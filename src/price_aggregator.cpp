@@ -0,0 +1,256 @@
+#include "price_aggregator.h"
+
+static SourceUrl sourceUrl; // one source at a time; send() copies it into its request
+
+bool PriceAggregator::add(PriceSource *source)
+{
+  if (_count == AGG_MAX_SOURCES)
+    return false;
+  Source &s = _sources[_count++];
+  s.source = source;
+  s.stats = {};
+  s.blocked = false;
+  s.asked = false;
+  s.answered = false;
+  return true;
+}
+
+bool PriceAggregator::available(int source, uint32_t now) const
+{
+  const Source &s = _sources[source];
+  return !s.blocked || (int32_t)(now - s.blockedUntil) >= 0;
+}
+
+// Lower is better: the smoothed latency, inflated by the error rate. A
+// source that never answered scores as if it took a second.
+uint32_t PriceAggregator::score(int source) const
+{
+  const SourceStats &stats = _sources[source].stats;
+  uint32_t latency = (stats.latency.count > 0 ? stats.latencyMs : 1000) + AGG_LATENCY_SLACK_MS;
+  return (uint64_t)latency * (1000 + AGG_ERROR_WEIGHT * stats.errorPermille) / 1000;
+}
+
+// The best source not asked yet this round, other than skip; -1 if none
+int PriceAggregator::best(uint32_t now, int skip) const
+{
+  int found = -1;
+  for (int i = 0; i < _count; i++)
+  {
+    if (i != skip && !_sources[i].asked && available(i, now) && (found < 0 || score(i) < score(found)))
+      found = i;
+  }
+  return found;
+}
+
+void PriceAggregator::ask(int source, const CoinStore &coins, const int *list, int count)
+{
+  Source &s = _sources[source];
+  s.asked = true;
+  s.answered = false;
+  s.stats.requests++;
+  sourceUrl.clear();
+  s.source->buildUrl(sourceUrl, coins, list, count);
+  s.askedAt = millis();
+  s.sendError = sourceUrl.truncated() ? HTTPC_ERROR_TOO_LESS_RAM : 0;
+  if (s.sendError == 0)
+    s.client.send(sourceUrl.c_str()); // a failure is reported by receive()
+}
+
+// Reads the answer to ask(); true if it brought quotes. rateLimitMs is set
+// when the source wants to be left alone for a while.
+bool PriceAggregator::answer(int source, const CoinStore &coins, uint32_t *rateLimitMs)
+{
+  Source &s = _sources[source];
+  s.answered = true;
+  int code = s.sendError != 0 ? s.sendError : s.client.receive();
+  bool ok = false;
+  *rateLimitMs = s.source->rateLimitMs(code, s.client);
+  if (code == HTTP_CODE_OK)
+  {
+    _parsing = source;
+    uint32_t start = micros();
+    ok = s.source->parse(s.client.body(), coins, onQuote, this, &_lastParse);
+    _parseTimings.add(micros() - start);
+  }
+  s.client.end();
+
+  uint32_t now = millis();
+  if (ok)
+  {
+    uint32_t latency = now - s.askedAt;
+    s.stats.latency.add(latency);
+    s.stats.latencyMs = s.stats.latency.count == 1 ? latency : (s.stats.latencyMs * 3 + latency) / 4;
+  }
+  else
+  {
+    s.stats.failures++;
+  }
+  s.stats.errorPermille = (s.stats.errorPermille * 7 + (ok ? 0 : 1000)) / 8;
+  if (*rateLimitMs != 0)
+  {
+    s.stats.rateLimited++;
+    s.blocked = true;
+    s.blockedUntil = now + *rateLimitMs;
+  }
+  return ok;
+}
+
+void PriceAggregator::onQuote(void *ctx, int coin, price_fx_t price, int32_t changeBp)
+{
+  PriceAggregator *self = (PriceAggregator *)ctx;
+  Quote &quote = self->_quotes[self->_parsing][coin];
+  quote.price = price;
+  quote.changeBp = changeBp;
+  quote.ms = millis() | 1; // 0 = none
+  self->_sources[self->_parsing].stats.quotes++;
+}
+
+// The asked source whose answer is in first, -1 once all were read. After
+// AGG_WAIT_MS without any, the first one left, to wait on the client's timeout.
+int PriceAggregator::nextAnswer(uint32_t since)
+{
+  for (;;)
+  {
+    int first = -1;
+    for (int i = 0; i < _count; i++)
+    {
+      Source &s = _sources[i];
+      if (!s.asked || s.answered)
+        continue;
+      if (s.sendError != 0 || s.client.ready())
+        return i;
+      if (first < 0)
+        first = i;
+    }
+    if (first < 0 || millis() - since >= AGG_WAIT_MS)
+      return first;
+    delay(1);
+  }
+}
+
+template <typename T>
+static T median(T *values, int n)
+{
+  for (int i = 1; i < n; i++)
+  {
+    for (int j = i; j > 0 && values[j] < values[j - 1]; j--)
+    {
+      T swap = values[j];
+      values[j] = values[j - 1];
+      values[j - 1] = swap;
+    }
+  }
+  return n % 2 == 1 ? values[n / 2] : values[n / 2 - 1] + (values[n / 2] - values[n / 2 - 1]) / 2;
+}
+
+void PriceAggregator::merge(const CoinStore &coins, const int *list, int count, uint32_t now, PriceFn onPrice)
+{
+  for (int k = 0; k < count; k++)
+  {
+    int coin = list[k];
+    price_fx_t prices[AGG_MAX_SOURCES];
+    int32_t changes[AGG_MAX_SOURCES];
+    int n = 0;
+    for (int i = 0; i < _count; i++)
+    {
+      const Quote &quote = _quotes[i][coin];
+      if (quote.ms != 0 && now - quote.ms <= AGG_QUOTE_MAX_AGE_MS)
+      {
+        prices[n] = quote.price;
+        changes[n] = quote.changeBp;
+        n++;
+      }
+    }
+    if (n == 0)
+      continue; // none of the sources knows the coin
+    price_fx_t price = median(prices, n);
+    if (n > 1 && changeBpFromPrices(prices[n - 1], prices[0]) > AGG_DIVERGENCE_BP)
+      _divergent++;
+    onPrice(coin, price, median(changes, n));
+  }
+}
+
+AggregateStatus PriceAggregator::fetch(const CoinStore &coins, const int *list, int count, PriceFn onPrice)
+{
+  uint32_t now = millis();
+  for (int i = 0; i < _count; i++)
+    _sources[i].asked = false;
+
+  if (_consensus)
+  {
+    for (int i = 0; i < _count; i++)
+    {
+      if (available(i, now))
+        ask(i, coins, list, count);
+    }
+  }
+  else
+  {
+    int candidate = best(now, -1);
+    if (candidate >= 0 && (!available(_primary, now) || score(candidate) * 100 < score(_primary) * AGG_SWITCH_PERCENT))
+      _primary = candidate;
+    if (available(_primary, now))
+      ask(_primary, coins, list, count);
+    if (!_probed || now - _lastProbe >= AGG_PROBE_MS)
+    {
+      int standby = best(now, _primary);
+      if (standby >= 0)
+        ask(standby, coins, list, count);
+      _probed = true;
+      _lastProbe = now;
+    }
+  }
+
+  // All requests are out; now the answers, as they come in, so a slow
+  // source neither holds up the others nor adds to their latency
+  bool ok = false;
+  bool failed = false;
+  uint32_t sent = millis();
+  for (int i; (i = nextAnswer(sent)) >= 0;)
+  {
+    uint32_t rateLimitMs;
+    if (answer(i, coins, &rateLimitMs))
+      ok = true;
+    else if (rateLimitMs == 0)
+      failed = true;
+  }
+  // Failover: the next best source, one at a time, until one answers
+  while (!ok && !_consensus)
+  {
+    int next = best(millis(), -1);
+    if (next < 0)
+      break;
+    uint32_t rateLimitMs;
+    ask(next, coins, list, count);
+    ok = answer(next, coins, &rateLimitMs);
+    failed |= !ok && rateLimitMs == 0;
+  }
+
+  if (ok)
+  {
+    merge(coins, list, count, millis(), onPrice);
+    return AGG_OK;
+  }
+  if (failed || _count == 0)
+    return AGG_FAILED;
+  now = millis();
+  _retryAfterMs = UINT32_MAX;
+  for (int i = 0; i < _count; i++)
+  {
+    if (!available(i, now))
+      _retryAfterMs = min(_retryAfterMs, _sources[i].blockedUntil - now);
+  }
+  return AGG_RATE_LIMITED;
+}
+
+uint32_t PriceAggregator::quoteAgeMs(int source, int coin, uint32_t now) const
+{
+  const Quote &quote = _quotes[source][coin];
+  return quote.ms == 0 ? UINT32_MAX : now - quote.ms;
+}
+
+void PriceAggregator::stop()
+{
+  for (int i = 0; i < _count; i++)
+    _sources[i].client.stop();
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "coin_store.h"
+#include "latency_histogram.h"
+#include "price_client.h"
+#include "price_source.h"
+#include "ticker_parser.h"
+
+#define AGG_MAX_SOURCES 3
+#define AGG_QUOTE_MAX_AGE_MS 30000 // a source's quote still votes this long
+#define AGG_DIVERGENCE_BP 50       // quotes further apart than this are counted
+#define AGG_PROBE_MS (60000 * 10)  // standby sources are polled along at least this often
+#define AGG_SWITCH_PERCENT 75      // another source takes over when it scores this much of the current one
+#define AGG_ERROR_WEIGHT 4         // an error rate of 100% counts as this many times the latency
+#define AGG_LATENCY_SLACK_MS 50    // added to every latency, so a few ms of jitter don't switch sources
+#define AGG_WAIT_MS 1000           // then the answers are read in order, each with the client's timeout
+
+enum AggregateStatus
+{
+  AGG_OK,           // at least one source answered
+  AGG_FAILED,       // connection errors, 5xx or bad bodies
+  AGG_RATE_LIMITED, // every source asked is backing off; see retryAfterMs()
+};
+
+struct SourceStats
+{
+  uint32_t requests;
+  uint32_t failures;
+  uint32_t rateLimited;
+  uint32_t quotes;
+  uint32_t latencyMs;     // smoothed, request sent until body parsed
+  uint16_t errorPermille; // smoothed
+  LatencyHistogram latency;
+};
+
+// Polls one or more exchanges through their PriceSource adapters and merges
+// the quotes. In failover mode only the best source is asked, by latency and
+// error rate, plus now and then a standby one to keep its figures current;
+// when the one asked fails, the next is tried at once. In consensus mode
+// every source is asked each time. Requests to all the sources of a round
+// are sent before any answer is read, and answers are read as they arrive,
+// so their round trips overlap on the one fetch task. Each coin gets the median of the quotes that arrived in
+// the last AGG_QUOTE_MAX_AGE_MS. Runs on the fetch task only.
+class PriceAggregator
+{
+public:
+  typedef void (*PriceFn)(int coin, price_fx_t price, int32_t changeBp);
+
+  bool add(PriceSource *source);
+  void setConsensus(bool consensus) { _consensus = consensus; }
+
+  AggregateStatus fetch(const CoinStore &coins, const int *list, int count, PriceFn onPrice);
+  uint32_t retryAfterMs() const { return _retryAfterMs; } // after AGG_RATE_LIMITED
+  void stop(); // drops the kept-alive connections, e.g. while streaming
+
+  int count() const { return _count; }
+  int primary() const { return _primary; }
+  const char *name(int source) const { return _sources[source].source->name(); }
+  const SourceStats &stats(int source) const { return _sources[source].stats; }
+  const FetchTimings &timings(int source) const { return _sources[source].client.timings(); }
+  uint32_t quoteAgeMs(int source, int coin, uint32_t now) const; // UINT32_MAX if none
+  uint32_t divergent() const { return _divergent; } // coins whose sources disagreed
+  const TickerParseStats &lastParse() const { return _lastParse; }
+  const TickerParseTimings &parseTimings() const { return _parseTimings; }
+
+private:
+  struct Source
+  {
+    PriceSource *source;
+    PriceClient client;
+    SourceStats stats;
+    uint32_t blockedUntil; // rate limited
+    bool blocked;
+    bool asked; // in the current round
+    bool answered;
+    uint32_t askedAt;
+    int sendError; // the URL didn't fit, 0 = handed to the client
+  };
+
+  struct Quote
+  {
+    price_fx_t price;
+    int32_t changeBp;
+    uint32_t ms; // millis() it arrived, 0 = none
+  };
+
+  static void onQuote(void *ctx, int coin, price_fx_t price, int32_t changeBp);
+  bool available(int source, uint32_t now) const;
+  uint32_t score(int source) const;
+  int best(uint32_t now, int skip) const;
+  void ask(int source, const CoinStore &coins, const int *list, int count);
+  int nextAnswer(uint32_t since);
+  bool answer(int source, const CoinStore &coins, uint32_t *rateLimitMs);
+  void merge(const CoinStore &coins, const int *list, int count, uint32_t now, PriceFn onPrice);
+
+  Source _sources[AGG_MAX_SOURCES];
+  int _count = 0;
+  int _primary = 0;
+  bool _consensus = false;
+  bool _probed = false;
+  uint32_t _lastProbe = 0;
+  uint32_t _retryAfterMs = 0;
+  uint32_t _divergent = 0;
+  Quote _quotes[AGG_MAX_SOURCES][MAX_COINS] = {};
+  int _parsing = 0; // source whose body onQuote() is reading
+  TickerParseStats _lastParse = {};
+  TickerParseTimings _parseTimings = {};
+};
@@ -0,0 +1,331 @@
+#include "price_client.h"
+
+void HttpBodyReader::begin(Stream *stream, int contentLength, bool chunked)
+{
+  _stream = stream;
+  _chunked = chunked;
+  _chunkData = false;
+  _remaining = chunked ? 0 : contentLength;
+  _done = !chunked && contentLength == 0;
+}
+
+int HttpBodyReader::readRaw()
+{
+  // don't use _stream->read() as it ignores the timeout
+  char c;
+  return _stream->readBytes(&c, 1) ? (uint8_t)c : -1;
+}
+
+// Reads the next chunk header: <hex size>[;extensions]\r\n
+bool HttpBodyReader::nextChunk()
+{
+  if (!_chunked)
+  {
+    _done = true;
+    return false;
+  }
+
+  int c;
+  if (_chunkData)
+  {
+    while ((c = readRaw()) >= 0 && c != '\n')
+      ;
+  }
+
+  int32_t size = 0;
+  bool digits = false;
+  bool extension = false;
+  while ((c = readRaw()) >= 0 && c != '\n')
+  {
+    if (extension || c == '\r')
+      continue;
+    if (c == ';')
+      extension = true;
+    else if (isxdigit(c))
+    {
+      size = size * 16 + (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+      digits = true;
+    }
+  }
+  if (c < 0 || !digits)
+  {
+    _done = true;
+    return false;
+  }
+
+  if (size == 0)
+  {
+    // last chunk: skip the trailer section up to the empty line
+    int lineLength = 0;
+    while ((c = readRaw()) >= 0)
+    {
+      if (c == '\n')
+      {
+        if (lineLength == 0)
+          break;
+        lineLength = 0;
+      }
+      else if (c != '\r')
+      {
+        lineLength++;
+      }
+    }
+    _done = true;
+    return false;
+  }
+
+  _remaining = size;
+  _chunkData = true;
+  return true;
+}
+
+int HttpBodyReader::read()
+{
+  if (_done || (_remaining == 0 && !nextChunk()))
+    return -1;
+  int c = readRaw();
+  if (c < 0)
+  {
+    _done = true;
+    return -1;
+  }
+  if (_remaining > 0)
+    _remaining--;
+  return c;
+}
+
+size_t HttpBodyReader::readBytes(char *buffer, size_t length)
+{
+  size_t n = 0;
+  while (n < length && !_done)
+  {
+    if (_remaining == 0 && !nextChunk())
+      break;
+    size_t want = length - n;
+    if (_remaining > 0 && want > (size_t)_remaining)
+      want = _remaining;
+    size_t got = _stream->readBytes(buffer + n, want);
+    if (got == 0)
+    {
+      _done = true;
+      break;
+    }
+    n += got;
+    if (_remaining > 0)
+      _remaining -= got;
+  }
+  return n;
+}
+
+void HttpBodyReader::drain()
+{
+  char scratch[64];
+  while (readBytes(scratch, sizeof(scratch)) > 0)
+    ;
+}
+
+#define HTTP_TIMEOUT_MS 5000
+#define HTTP_LINE_MAX 128
+
+static const char *const HEADER_NAMES[] = {"Retry-After", "X-MBX-USED-WEIGHT-1M"};
+
+PriceClient::PriceClient()
+{
+  _client.setInsecure(); // no CA certificate, as before
+  // Stream's timeout, in ms; WiFiClient::setTimeout() takes seconds on some cores
+  static_cast<Stream &>(_client).setTimeout(HTTP_TIMEOUT_MS);
+  memset(_headers, 0, sizeof(_headers));
+}
+
+// Opens a new TLS connection only if the kept-alive one is gone
+bool PriceClient::ensureConnected()
+{
+  _reused = _client.connected();
+  if (_reused)
+  {
+    _timings.reused++;
+    _timings.lastHandshakeMs = 0;
+    return true;
+  }
+
+  uint32_t start = millis();
+  bool connected = _client.connect(_host, _port);
+  _timings.lastHandshakeMs = millis() - start;
+  _timings.totalHandshakeMs += _timings.lastHandshakeMs;
+  if (connected)
+    _timings.handshakes++;
+  else
+    _error = HTTPC_ERROR_CONNECTION_REFUSED;
+  return connected;
+}
+
+bool PriceClient::writeRequest()
+{
+  if (_client.write((const uint8_t *)_request.c_str(), _request.length()) == _request.length())
+    return true;
+  _error = HTTPC_ERROR_SEND_HEADER_FAILED;
+  _client.stop();
+  return false;
+}
+
+bool PriceClient::send(const char *url)
+{
+  _timings.requests++;
+  _transferStart = millis();
+  _body.begin(&_client, 0, false);
+  _sent = false;
+
+  const char *scheme = strstr(url, "://");
+  const char *host = scheme != NULL ? scheme + 3 : url;
+  size_t hostLength = strcspn(host, "/");
+  const char *path = host[hostLength] != '\0' ? host + hostLength : "/";
+  _request.clear();
+  _request.append("GET ").append(path).append(" HTTP/1.1\r\nHost: ");
+  _request.appendf("%.*s", (int)hostLength, host);
+  _request.append("\r\nUser-Agent: crypto-meter\r\nConnection: keep-alive\r\n\r\n");
+  if (_request.truncated() || hostLength >= sizeof(_host))
+  {
+    _error = HTTPC_ERROR_TOO_LESS_RAM;
+    _timings.failures++;
+    return false;
+  }
+  memcpy(_host, host, hostLength);
+  _host[hostLength] = '\0';
+  _port = strncmp(url, "http://", 7) == 0 ? 80 : 443;
+  char *colon = strchr(_host, ':');
+  if (colon != NULL)
+  {
+    _port = atoi(colon + 1);
+    *colon = '\0';
+  }
+
+  // A kept-alive connection may have been closed by the server without us
+  // noticing yet; in that case once more on a fresh one
+  bool sent = ensureConnected() && writeRequest();
+  if (!sent && _reused)
+    sent = ensureConnected() && writeRequest();
+  if (!sent)
+  {
+    _timings.failures++;
+    return false;
+  }
+  _sent = true;
+  return true;
+}
+
+int PriceClient::receive()
+{
+  if (!_sent)
+    return _error;
+  _sent = false;
+  int code = readHead();
+  if (code <= 0 && _reused)
+  {
+    _client.stop(); // stale, the request went nowhere
+    if (ensureConnected() && writeRequest())
+      code = readHead();
+  }
+  if (code <= 0)
+  {
+    _client.stop();
+    _timings.failures++;
+  }
+  return code;
+}
+
+bool PriceClient::ready()
+{
+  return !_sent || _client.available() > 0 || !_client.connected();
+}
+
+int PriceClient::get(const char *url)
+{
+  return send(url) ? receive() : _error;
+}
+
+// Reads one header line without the CRLF, cut to size; false on timeout
+static bool readLine(Stream &stream, char *line, size_t size)
+{
+  size_t n = 0;
+  char c;
+  while (stream.readBytes(&c, 1) == 1)
+  {
+    if (c == '\n')
+    {
+      line[n] = '\0';
+      return true;
+    }
+    if (c != '\r' && n + 1 < size)
+      line[n++] = c;
+  }
+  return false;
+}
+
+int PriceClient::readHead()
+{
+  char line[HTTP_LINE_MAX];
+  if (!readLine(_client, line, sizeof(line)))
+    return HTTPC_ERROR_READ_TIMEOUT;
+  if (strncmp(line, "HTTP/1.", 7) != 0 || strlen(line) < 12)
+    return HTTPC_ERROR_NO_HTTP_SERVER;
+  int code = atoi(line + 9); // HTTP/1.1 200 OK
+
+  int contentLength = -1; // until the server closes
+  bool chunked = false;
+  _close = line[7] == '0'; // HTTP/1.0 closes unless asked otherwise
+  memset(_headers, 0, sizeof(_headers));
+  for (;;)
+  {
+    if (!readLine(_client, line, sizeof(line)))
+      return HTTPC_ERROR_READ_TIMEOUT;
+    if (line[0] == '\0')
+      break;
+    char *colon = strchr(line, ':');
+    if (colon == NULL)
+      continue;
+    *colon = '\0';
+    const char *value = colon + 1;
+    while (*value == ' ')
+      value++;
+
+    if (strcasecmp(line, "Content-Length") == 0)
+      contentLength = atoi(value);
+    else if (strcasecmp(line, "Transfer-Encoding") == 0)
+      chunked = strcasecmp(value, "chunked") == 0;
+    else if (strcasecmp(line, "Connection") == 0)
+      _close = strcasecmp(value, "close") == 0;
+    for (size_t i = 0; i < sizeof(HEADER_NAMES) / sizeof(HEADER_NAMES[0]); i++)
+    {
+      if (strcasecmp(line, HEADER_NAMES[i]) == 0)
+      {
+        strncpy(_headers[i], value, HTTP_HEADER_VALUE_MAX - 1);
+      }
+    }
+  }
+  _body.begin(&_client, chunked ? 0 : contentLength, chunked);
+  return code > 0 ? code : HTTPC_ERROR_NO_HTTP_SERVER;
+}
+
+const char *PriceClient::header(const char *name) const
+{
+  for (size_t i = 0; i < sizeof(HEADER_NAMES) / sizeof(HEADER_NAMES[0]); i++)
+  {
+    if (strcasecmp(name, HEADER_NAMES[i]) == 0)
+      return _headers[i];
+  }
+  return "";
+}
+
+void PriceClient::end()
+{
+  _body.drain();
+  if (_close)
+    _client.stop();
+  _timings.lastTransferMs = millis() - _transferStart;
+  _timings.totalTransferMs += _timings.lastTransferMs;
+}
+
+void PriceClient::stop()
+{
+  _client.stop();
+}
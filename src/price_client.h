@@ -0,0 +1,92 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <HTTPClient.h> // status and HTTPC_ERROR_* codes only
+#include "fixed_text.h"
+
+#define HTTP_REQUEST_MAX 2560 // request line and headers; the URL lists every watched symbol
+#define HTTP_HEADER_VALUE_MAX 16
+
+// Reads exactly one response body off a kept-alive connection, decoding
+// chunked transfer encoding, so the socket is left at the start of the next
+// response once the body has been consumed.
+class HttpBodyReader
+{
+public:
+  void begin(Stream *stream, int contentLength, bool chunked);
+
+  int read();
+  size_t readBytes(char *buffer, size_t length);
+  void drain(); // discard whatever is left of the body
+
+private:
+  bool nextChunk();
+  int readRaw();
+
+  Stream *_stream = NULL;
+  int32_t _remaining = 0; // in the current chunk or body, -1 = until close
+  bool _chunked = false;
+  bool _chunkData = false; // a chunk's data (and its CRLF) precedes the next header
+  bool _done = true;
+};
+
+// Timing counters, in milliseconds, to compare connection setup against the
+// actual request/response transfer
+struct FetchTimings
+{
+  uint32_t requests;
+  uint32_t handshakes; // new TCP + TLS connections
+  uint32_t reused;     // requests sent on a kept-alive connection
+  uint32_t failures;
+  uint32_t lastHandshakeMs;
+  uint32_t totalHandshakeMs;
+  uint32_t lastTransferMs; // request sent until body drained
+  uint32_t totalTransferMs;
+};
+
+// Long-lived HTTPS client for the periodic price requests. The TLS connection
+// is kept open between polls and re-established transparently when the
+// server or the network dropped it. It speaks HTTP/1.1 itself rather than
+// through HTTPClient, which copies the URL and every header into Strings, so
+// a request on a kept-alive connection doesn't touch the heap.
+class PriceClient
+{
+public:
+  PriceClient();
+
+  // Sends a GET request; returns the HTTP status or a negative HTTPC_ERROR_*
+  int get(const char *url);
+  // get() in two halves, so requests to several servers can be in flight at
+  // once: send() returns false if the request could not be sent, receive()
+  // then returns the error, otherwise it waits for the status and headers
+  bool send(const char *url);
+  int receive();
+  bool ready(); // receive() won't wait: the answer or an error is there
+  HttpBodyReader &body() { return _body; }
+  // Retry-After or X-MBX-USED-WEIGHT-1M of the last response, "" if absent
+  const char *header(const char *name) const;
+  // Must follow every get(): finishes the body and keeps the connection alive
+  void end();
+  void stop(); // drops the kept-alive connection, e.g. while it is not needed
+
+  const FetchTimings &timings() const { return _timings; }
+
+private:
+  bool ensureConnected();
+  bool writeRequest();
+  int readHead(); // status line and headers
+
+  WiFiClientSecure _client;
+  HttpBodyReader _body;
+  FixedText<HTTP_REQUEST_MAX> _request;
+  char _headers[2][HTTP_HEADER_VALUE_MAX]; // values, in the order of HEADER_NAMES
+  char _host[64] = "";
+  uint16_t _port = 443;
+  bool _close = false;  // the server will close the connection after this body
+  bool _reused = false; // the request went out on a kept-alive connection
+  bool _sent = false;   // awaiting receive()
+  int _error = 0;       // why send() failed
+  FetchTimings _timings = {};
+  uint32_t _transferStart = 0;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string.h>
+#include <time.h>
+#include "coin_store.h"
+#include "spsc_mailbox.h"
+
+// Everything the fetch task hands over to the UI in one go, indexed like coinStore
+struct PriceSnapshot
+{
+  price_fx_t price[MAX_COINS];
+  int32_t changeBp[MAX_COINS];
+  uint32_t seq[MAX_COINS]; // bumped on every update of the coin, 0 = never updated
+  time_t updatedAt;
+  bool streamed; // from the WebSocket feed rather than a poll
+};
+
+// UI side: what was applied, to compare against PriceCoalescer::updates()
+struct FeedStats
+{
+  uint32_t snapshots;   // consumed from the mailbox
+  uint32_t coinUpdates; // coins whose seq had moved
+};
+
+// Fetch task side of the price hand-over. Updates are written into a pending
+// snapshot as they arrive, however fast, and publish() passes the whole
+// state on at most once per call. The UI applies a coin only when its seq
+// moved since the snapshot it applied last, so a burst of ticks for one
+// coin costs the UI a single update.
+class PriceCoalescer
+{
+public:
+  void set(int coin, price_fx_t price, int32_t changeBp)
+  {
+    _pending.price[coin] = price;
+    _pending.changeBp[coin] = changeBp;
+    _pending.seq[coin]++;
+    _dirty = true;
+    _updates++;
+  }
+
+  const PriceSnapshot &pending() const { return _pending; }
+  bool dirty() const { return _dirty; }
+
+  // Copies the pending values of the first count coins into the mailbox if
+  // anything changed since the last publish
+  bool publish(SpscMailbox<PriceSnapshot> &mailbox, int count, time_t updatedAt, bool streamed)
+  {
+    if (!_dirty)
+      return false;
+    PriceSnapshot &slot = mailbox.writeSlot();
+    memcpy(slot.price, _pending.price, count * sizeof(slot.price[0]));
+    memcpy(slot.changeBp, _pending.changeBp, count * sizeof(slot.changeBp[0]));
+    memcpy(slot.seq, _pending.seq, count * sizeof(slot.seq[0]));
+    slot.updatedAt = updatedAt;
+    slot.streamed = streamed;
+    mailbox.publish();
+    _dirty = false;
+    _publishes++;
+    return true;
+  }
+
+  uint32_t updates() const { return _updates; }
+  uint32_t publishes() const { return _publishes; }
+
+private:
+  PriceSnapshot _pending = {};
+  bool _dirty = false;
+  uint32_t _updates = 0;
+  uint32_t _publishes = 0;
+};
@@ -0,0 +1,116 @@
+#include "price_history.h"
+
+#include <esp_attr.h>
+#include <string.h>
+
+#define HISTORY_MAGIC 0x48495354 // "HIST"
+#define HISTORY_VALUE_LIMIT 32000 // keeps clear of LV_CHART_POINT_NONE
+
+struct RetainedHistory
+{
+  uint32_t magic;
+  uint32_t watchlistHash;
+  CoinHistory coins[HISTORY_COINS];
+};
+
+RTC_DATA_ATTR static RetainedHistory retained;
+
+uint32_t PriceHistory::period(HistoryResolution res)
+{
+  static const uint32_t seconds[HISTORY_RESOLUTIONS] = {60, 15 * 60, 60 * 60};
+  return seconds[res];
+}
+
+void PriceHistory::begin(uint32_t watchlistHash)
+{
+  _hash = watchlistHash;
+  if (retained.magic == HISTORY_MAGIC && retained.watchlistHash == watchlistHash)
+    memcpy(_coins, retained.coins, sizeof(_coins));
+  else
+    memset(_coins, 0, sizeof(_coins));
+}
+
+void PriceHistory::save() const
+{
+  memcpy(retained.coins, _coins, sizeof(_coins));
+  retained.watchlistHash = _hash;
+  retained.magic = HISTORY_MAGIC;
+}
+
+bool PriceHistory::addToRing(HistoryRing &ring, lv_coord_t value, uint32_t bucket)
+{
+  if (ring.bucket != 0 && bucket == ring.bucket)
+  {
+    // same period: aggregate
+    bool changed = ring.last[ring.head] != value;
+    ring.last[ring.head] = value;
+    if (value < ring.low[ring.head])
+      ring.low[ring.head] = value;
+    if (value > ring.high[ring.head])
+      ring.high[ring.head] = value;
+    return changed; // low/high can only move if last did
+  }
+  if (ring.bucket != 0 && bucket < ring.bucket)
+    return false; // clock went backwards
+
+  uint32_t steps = ring.bucket == 0 ? HISTORY_POINTS : bucket - ring.bucket;
+  if (steps > HISTORY_POINTS)
+    steps = HISTORY_POINTS;
+  for (uint32_t i = 1; i < steps; i++)
+  {
+    // periods without a tick
+    ring.head = (ring.head + 1) % HISTORY_POINTS;
+    ring.last[ring.head] = ring.low[ring.head] = ring.high[ring.head] = LV_CHART_POINT_NONE;
+  }
+  ring.head = (ring.head + 1) % HISTORY_POINTS;
+  ring.last[ring.head] = ring.low[ring.head] = ring.high[ring.head] = value;
+  ring.bucket = bucket;
+  return true;
+}
+
+bool PriceHistory::add(int coin, price_fx_t price, uint32_t unixTime)
+{
+  if (coin < 0 || coin >= HISTORY_COINS || price <= 0 || unixTime == 0)
+    return false;
+
+  CoinHistory &history = _coins[coin];
+  if (history.anchor == 0)
+    history.anchor = price;
+
+  int64_t value = (price - history.anchor) * 10000 / history.anchor;
+  if (value > HISTORY_VALUE_LIMIT)
+    value = HISTORY_VALUE_LIMIT;
+  else if (value < -HISTORY_VALUE_LIMIT)
+    value = -HISTORY_VALUE_LIMIT;
+
+  bool changed = false;
+  for (int r = 0; r < HISTORY_RESOLUTIONS; r++)
+  {
+    if (addToRing(history.ring[r], (lv_coord_t)value, unixTime / period((HistoryResolution)r)))
+      changed = true;
+  }
+  return changed;
+}
+
+const HistoryRing *PriceHistory::ring(int coin, HistoryResolution res) const
+{
+  if (coin < 0 || coin >= HISTORY_COINS || _coins[coin].ring[res].bucket == 0)
+    return NULL;
+  return &_coins[coin].ring[res];
+}
+
+bool HistoryRing::range(lv_coord_t *min, lv_coord_t *max) const
+{
+  bool any = false;
+  for (int i = 0; i < HISTORY_POINTS; i++)
+  {
+    if (low[i] == LV_CHART_POINT_NONE)
+      continue;
+    if (!any || low[i] < *min)
+      *min = low[i];
+    if (!any || high[i] > *max)
+      *max = high[i];
+    any = true;
+  }
+  return any;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+#include "lvgl.h"
+#include "price_record.h"
+
+#define HISTORY_POINTS 24 // per resolution: 24 min, 6 h and 24 h
+#define HISTORY_COINS 8   // the first coins of the watchlist keep a history
+
+enum HistoryResolution
+{
+  HISTORY_1MIN,
+  HISTORY_15MIN,
+  HISTORY_1H,
+  HISTORY_RESOLUTIONS
+};
+
+// One resolution of one coin. Each point aggregates the ticks of one period
+// as low/high/last, in 1/100 percent relative to the coin's anchor price, so
+// the arrays can be handed to lv_chart_set_ext_y_array() as they are.
+// Missing periods hold LV_CHART_POINT_NONE.
+struct HistoryRing
+{
+  uint32_t bucket; // period number (unix time / period) of the newest point, 0 = empty
+  uint8_t head;    // index of the newest point
+  lv_coord_t last[HISTORY_POINTS];
+  lv_coord_t low[HISTORY_POINTS];
+  lv_coord_t high[HISTORY_POINTS];
+
+  uint16_t oldest() const { return (head + 1) % HISTORY_POINTS; } // for lv_chart_set_x_start_point()
+  bool range(lv_coord_t *min, lv_coord_t *max) const;
+};
+
+struct CoinHistory
+{
+  price_fx_t anchor; // 0 = no history yet
+  HistoryRing ring[HISTORY_RESOLUTIONS];
+};
+
+// Multi-resolution price history, updated incrementally with every tick.
+// It lives in normal RAM; save() copies it into RTC slow memory before deep
+// sleep and begin() restores it after wake-up.
+class PriceHistory
+{
+public:
+  void begin(uint32_t watchlistHash);
+  void save() const;
+
+  bool add(int coin, price_fx_t price, uint32_t unixTime); // true if any point changed
+  const HistoryRing *ring(int coin, HistoryResolution res) const; // NULL without data
+
+  static uint32_t period(HistoryResolution res);
+
+private:
+  static bool addToRing(HistoryRing &ring, lv_coord_t value, uint32_t bucket);
+
+  uint32_t _hash = 0;
+  CoinHistory _coins[HISTORY_COINS];
+};
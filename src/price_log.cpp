@@ -0,0 +1,225 @@
+#include "price_log.h"
+
+#include <string.h>
+
+#define STATE_KNOWN 0x01
+#define STATE_DIRTY 0x02
+
+#ifdef ARDUINO
+
+bool PartitionFlash::begin(uint16_t sectors)
+{
+  _partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, NULL);
+  if (_partition == NULL)
+    return false;
+  _sectors = sectors;
+  if ((uint32_t)_sectors * SPI_FLASH_SEC_SIZE > _partition->size)
+    _sectors = _partition->size / SPI_FLASH_SEC_SIZE;
+  return _sectors >= 2;
+}
+
+bool PartitionFlash::read(uint32_t offset, void *dst, size_t len)
+{
+  return esp_partition_read(_partition, offset, dst, len) == ESP_OK;
+}
+
+bool PartitionFlash::write(uint32_t offset, const void *src, size_t len)
+{
+  return esp_partition_write(_partition, offset, src, len) == ESP_OK;
+}
+
+bool PartitionFlash::eraseSector(uint16_t sector)
+{
+  return esp_partition_erase_range(_partition, (uint32_t)sector * SPI_FLASH_SEC_SIZE, SPI_FLASH_SEC_SIZE) == ESP_OK;
+}
+
+#else
+
+bool RamFlash::begin(uint16_t sectors)
+{
+  _sectors = sectors;
+  _data.assign((size_t)sectors * sectorSize(), 0xFF);
+  return _sectors >= 2;
+}
+
+bool RamFlash::read(uint32_t offset, void *dst, size_t len)
+{
+  if (offset + len > _data.size())
+    return false;
+  memcpy(dst, &_data[offset], len);
+  return true;
+}
+
+bool RamFlash::write(uint32_t offset, const void *src, size_t len)
+{
+  if (offset + len > _data.size())
+    return false;
+  const uint8_t *bytes = (const uint8_t *)src;
+  for (size_t i = 0; i < len; i++)
+    _data[offset + i] &= bytes[i]; // like NOR flash
+  return true;
+}
+
+bool RamFlash::eraseSector(uint16_t sector)
+{
+  if (sector >= _sectors)
+    return false;
+  memset(&_data[(size_t)sector * sectorSize()], 0xFF, sectorSize());
+  return true;
+}
+
+#endif
+
+// header + one entry per coin
+static_assert(16 + MAX_COINS * 16 <= 4096, "a checkpoint must fit in one flash sector");
+
+uint16_t PriceLog::crc16(const uint8_t *data, size_t len)
+{
+  uint16_t crc = 0xFFFF; // CRC-16/CCITT-FALSE
+  while (len--)
+  {
+    crc ^= (uint16_t)*data++ << 8;
+    for (int i = 0; i < 8; i++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+bool PriceLog::begin(FlashRegion *flash, uint32_t watchlistHash, uint16_t coinCount)
+{
+  _flash = flash;
+  _hash = watchlistHash;
+  _coinCount = coinCount < MAX_COINS ? coinCount : MAX_COINS;
+  _sector = -1;
+  _sequence = 0;
+  memset(_state, 0, sizeof(_state));
+
+  // Sector holding the newest log for this watchlist, if any
+  for (uint16_t s = 0; s < _flash->sectorCount(); s++)
+  {
+    SectorHeader header;
+    if (!_flash->read((uint32_t)s * _flash->sectorSize(), &header, sizeof(header)))
+      continue;
+    if (header.magic != PRICE_LOG_MAGIC || header.version != PRICE_LOG_VERSION)
+      continue;
+    if (header.sequence >= _sequence)
+    {
+      // also remember sequences of other watchlists so they are never reused
+      _sequence = header.sequence;
+      bool ours = header.watchlistHash == _hash && header.coinCount == _coinCount;
+      _sector = ours ? s : -1;
+    }
+  }
+
+  if (_sector < 0)
+  {
+    _writeOffset = 0; // nothing usable: the first commit starts a new sector
+    return false;
+  }
+  return replay(_sector);
+}
+
+bool PriceLog::replay(uint16_t sector)
+{
+  uint32_t base = (uint32_t)sector * _flash->sectorSize();
+  uint32_t offset = sizeof(SectorHeader);
+  for (; offset + sizeof(Entry) <= _flash->sectorSize(); offset += sizeof(Entry))
+  {
+    Entry entry;
+    if (!_flash->read(base + offset, &entry, sizeof(entry)))
+      break;
+    if (entry.coin == 0xFFFF && entry.crc == 0xFFFF)
+      break; // erased: end of the log
+    if (entry.crc != crc16((const uint8_t *)&entry, offsetof(Entry, crc)) || entry.coin >= _coinCount)
+    {
+      offset = _flash->sectorSize(); // torn write: never append after it
+      break;
+    }
+    _price[entry.coin] = entry.price;
+    _changeBp[entry.coin] = entry.changeBp;
+    _state[entry.coin] = STATE_KNOWN;
+  }
+  _writeOffset = offset;
+  return true;
+}
+
+bool PriceLog::get(uint16_t coin, price_fx_t *price, int32_t *changeBp) const
+{
+  if (coin >= _coinCount || !(_state[coin] & STATE_KNOWN))
+    return false;
+  *price = _price[coin];
+  *changeBp = _changeBp[coin];
+  return true;
+}
+
+void PriceLog::set(uint16_t coin, price_fx_t price, int32_t changeBp)
+{
+  if (coin >= _coinCount)
+    return;
+  if ((_state[coin] & STATE_KNOWN) && _price[coin] == price && _changeBp[coin] == changeBp)
+    return; // unchanged: nothing to write
+  _price[coin] = price;
+  _changeBp[coin] = changeBp;
+  _state[coin] = STATE_KNOWN | STATE_DIRTY;
+}
+
+bool PriceLog::append(uint16_t coin)
+{
+  Entry entry;
+  entry.price = _price[coin];
+  entry.changeBp = _changeBp[coin];
+  entry.coin = coin;
+  entry.crc = crc16((const uint8_t *)&entry, offsetof(Entry, crc));
+  if (!_flash->write((uint32_t)_sector * _flash->sectorSize() + _writeOffset, &entry, sizeof(entry)))
+    return false;
+  _writeOffset += sizeof(entry);
+  _bytesWritten += sizeof(entry);
+  _state[coin] &= ~STATE_DIRTY;
+  return true;
+}
+
+// Starts the next sector with a checkpoint of every known coin
+bool PriceLog::rotate()
+{
+  uint16_t next = (uint16_t)((_sector + 1) % _flash->sectorCount());
+  if (!_flash->eraseSector(next))
+    return false;
+  _erases++;
+  _sector = next;
+  _writeOffset = 0;
+
+  SectorHeader header = {PRICE_LOG_MAGIC, PRICE_LOG_VERSION, _coinCount, ++_sequence, _hash};
+  if (!_flash->write((uint32_t)_sector * _flash->sectorSize(), &header, sizeof(header)))
+    return false;
+  _writeOffset = sizeof(header);
+  _bytesWritten += sizeof(header);
+
+  for (uint16_t coin = 0; coin < _coinCount; coin++)
+  {
+    if ((_state[coin] & STATE_KNOWN) && !append(coin))
+      return false;
+  }
+  return true;
+}
+
+bool PriceLog::commit()
+{
+  int dirty = 0;
+  for (uint16_t coin = 0; coin < _coinCount; coin++)
+  {
+    if (_state[coin] & STATE_DIRTY)
+      dirty++;
+  }
+  if (dirty == 0)
+    return true;
+
+  if (_sector < 0 || _writeOffset + dirty * sizeof(Entry) > _flash->sectorSize())
+    return rotate();
+
+  for (uint16_t coin = 0; coin < _coinCount; coin++)
+  {
+    if ((_state[coin] & STATE_DIRTY) && !append(coin))
+      return false;
+  }
+  return true;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "coin_store.h"
+#include "price_record.h"
+
+// Raw, sector-erasable storage the price log is written to
+class FlashRegion
+{
+public:
+  virtual ~FlashRegion() {}
+  virtual uint32_t sectorSize() const = 0;
+  virtual uint16_t sectorCount() const = 0;
+  virtual bool read(uint32_t offset, void *dst, size_t len) = 0;
+  virtual bool write(uint32_t offset, const void *src, size_t len) = 0;
+  virtual bool eraseSector(uint16_t sector) = 0;
+};
+
+#ifdef ARDUINO
+#include <esp_partition.h>
+
+// The first sectors of the (otherwise unused) SPIFFS data partition
+class PartitionFlash : public FlashRegion
+{
+public:
+  bool begin(uint16_t sectors);
+
+  uint32_t sectorSize() const { return SPI_FLASH_SEC_SIZE; }
+  uint16_t sectorCount() const { return _sectors; }
+  bool read(uint32_t offset, void *dst, size_t len);
+  bool write(uint32_t offset, const void *src, size_t len);
+  bool eraseSector(uint16_t sector);
+
+private:
+  const esp_partition_t *_partition = NULL;
+  uint16_t _sectors = 0;
+};
+#else
+#include <vector>
+
+// Erased-flash stand-in for the host simulator; writes can only clear bits
+class RamFlash : public FlashRegion
+{
+public:
+  bool begin(uint16_t sectors);
+
+  uint32_t sectorSize() const { return 4096; }
+  uint16_t sectorCount() const { return _sectors; }
+  bool read(uint32_t offset, void *dst, size_t len);
+  bool write(uint32_t offset, const void *src, size_t len);
+  bool eraseSector(uint16_t sector);
+
+private:
+  std::vector<uint8_t> _data;
+  uint16_t _sectors = 0;
+};
+#endif
+
+#define PRICE_LOG_MAGIC 0x474F4C50 // "PLOG"
+#define PRICE_LOG_VERSION 1
+
+// Append-only, versioned on-flash log of the last known price per coin.
+//
+// Each sector starts with a header carrying a sequence number, followed by
+// 16-byte entries. commit() appends one entry per coin that changed since the
+// last commit. When the active sector is full the log moves on to the next
+// sector in the ring, erases it and writes a checkpoint of every known coin
+// first, so the newest sector alone always holds the complete state and the
+// erase cycles are spread over all sectors.
+class PriceLog
+{
+public:
+  // Replays the newest sector written for this watchlist
+  bool begin(FlashRegion *flash, uint32_t watchlistHash, uint16_t coinCount);
+
+  bool get(uint16_t coin, price_fx_t *price, int32_t *changeBp) const;
+  void set(uint16_t coin, price_fx_t price, int32_t changeBp);
+  bool commit();
+
+  uint32_t bytesWritten() const { return _bytesWritten; }
+  uint32_t sectorErases() const { return _erases; }
+
+private:
+  struct SectorHeader
+  {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t coinCount;
+    uint32_t sequence;
+    uint32_t watchlistHash;
+  };
+
+  struct Entry
+  {
+    price_fx_t price;
+    int32_t changeBp;
+    uint16_t coin;
+    uint16_t crc; // CRC-16 of the preceding 14 bytes
+  };
+
+  static uint16_t crc16(const uint8_t *data, size_t len);
+  bool replay(uint16_t sector);
+  bool rotate();
+  bool append(uint16_t coin);
+
+  FlashRegion *_flash = NULL;
+  uint32_t _hash = 0;
+  uint16_t _coinCount = 0;
+  int32_t _sector = -1;
+  uint32_t _sequence = 0;
+  uint32_t _writeOffset = 0;
+  uint32_t _bytesWritten = 0;
+  uint32_t _erases = 0;
+
+  price_fx_t _price[MAX_COINS];
+  int32_t _changeBp[MAX_COINS];
+  uint8_t _state[MAX_COINS]; // KNOWN | DIRTY
+};
@@ -0,0 +1,261 @@
+#include "price_record.h"
+
+#include <math.h>
+
+price_fx_t PriceRecord::tick(int age) const
+{
+  return ticks[(head + PRICE_RING_LEN - age) % PRICE_RING_LEN];
+}
+
+void PriceRecord::push(price_fx_t price, int32_t change, uint32_t now)
+{
+  if (count > 0)
+    head = (head + 1) % PRICE_RING_LEN;
+  if (count < PRICE_RING_LEN)
+    count++;
+  ticks[head] = price;
+  uint8_t tickDecimals = priceDecimals(price);
+  if (tickDecimals > decimals)
+    decimals = tickDecimals;
+  changeBp = change;
+  updatedAt = now;
+  flags &= ~PRICE_RECORD_CACHED;
+}
+
+price_fx_t priceFromDouble(double value)
+{
+  return (price_fx_t)llround(value * PRICE_SCALE);
+}
+
+int32_t changeBpFromDouble(double percent)
+{
+  return (int32_t)lround(percent * 100);
+}
+
+bool parsePrice(const char *text, price_fx_t *price)
+{
+  const char *p = text;
+  bool negative = *p == '-';
+  if (*p == '-' || *p == '+')
+    p++;
+  uint64_t mag = 0;
+  int decimals = -1; // digits seen after the point, -1 = no point yet
+  bool digits = false;
+  bool roundUp = false;
+  for (; *p != '\0'; p++)
+  {
+    if (*p == '.' && decimals < 0)
+    {
+      decimals = 0;
+      continue;
+    }
+    if (*p < '0' || *p > '9')
+      return false;
+    digits = true;
+    if (decimals >= PRICE_DECIMALS)
+    {
+      if (decimals++ == PRICE_DECIMALS)
+        roundUp = *p >= '5'; // half away from zero, on the first dropped digit
+      continue;
+    }
+    if (mag > (uint64_t)(INT64_MAX / 10))
+      return false;
+    mag = mag * 10 + (*p - '0');
+    if (decimals >= 0)
+      decimals++;
+  }
+  if (!digits)
+    return false;
+  for (int i = decimals < 0 ? 0 : decimals; i < PRICE_DECIMALS; i++)
+  {
+    if (mag > (uint64_t)(INT64_MAX / 10))
+      return false;
+    mag *= 10;
+  }
+  if (roundUp)
+    mag++;
+  if (mag > (uint64_t)INT64_MAX)
+    return false;
+  *price = negative ? -(price_fx_t)mag : (price_fx_t)mag;
+  return true;
+}
+
+// Percent in fixed point is bp * 1e6
+bool parseChangeBp(const char *percent, int32_t *changeBp)
+{
+  price_fx_t fx;
+  if (!parsePrice(percent, &fx))
+    return false;
+  price_fx_t bp = (fx + (fx < 0 ? -500000 : 500000)) / 1000000;
+  if (bp > INT32_MAX || bp < INT32_MIN)
+    return false;
+  *changeBp = (int32_t)bp;
+  return true;
+}
+
+int32_t changeBpFromPrices(price_fx_t last, price_fx_t open)
+{
+  if (open <= 0)
+    return 0;
+  int64_t move = last - open;
+  while (move > INT64_MAX / 10000 || move < -(INT64_MAX / 10000))
+  {
+    move /= 2;
+    open /= 2;
+  }
+  int64_t bp = (move * 10000 + (move < 0 ? -open / 2 : open / 2)) / open;
+  return bp > INT32_MAX ? INT32_MAX : bp < INT32_MIN ? INT32_MIN : (int32_t)bp;
+}
+
+uint8_t priceDecimals(price_fx_t price)
+{
+  uint64_t mag = price < 0 ? -(uint64_t)price : (uint64_t)price;
+  uint8_t decimals = PRICE_DECIMALS;
+  while (decimals > 0 && mag % 10 == 0)
+  {
+    mag /= 10;
+    decimals--;
+  }
+  return decimals;
+}
+
+// Writes the digits of v right-aligned ending at end, returns the first one
+static char *writeDigits(char *end, uint64_t v, int minDigits)
+{
+  do
+  {
+    *--end = '0' + (char)(v % 10);
+    v /= 10;
+    minDigits--;
+  } while (v != 0 || minDigits > 0);
+  return end;
+}
+
+static int copyOut(char *buf, size_t size, const char *start, const char *end)
+{
+  size_t len = end - start;
+  if (size == 0)
+    return 0;
+  if (len >= size)
+    len = size - 1;
+  for (size_t i = 0; i < len; i++)
+    buf[i] = start[i];
+  buf[len] = '\0';
+  return (int)len;
+}
+
+int formatPrice(char *buf, size_t size, price_fx_t price, uint8_t decimals)
+{
+  char tmp[32];
+  char *end = tmp + sizeof(tmp);
+  if (decimals > PRICE_DECIMALS)
+    decimals = PRICE_DECIMALS;
+
+  // round away the digits we do not show
+  uint64_t div = 1;
+  for (int i = decimals; i < PRICE_DECIMALS; i++)
+    div *= 10;
+  uint64_t mag = price < 0 ? -(uint64_t)price : (uint64_t)price;
+  mag = (mag + div / 2) / div;
+
+  uint64_t unit = 1;
+  for (int i = 0; i < decimals; i++)
+    unit *= 10;
+
+  char *p = end;
+  if (decimals > 0)
+  {
+    p = writeDigits(p, mag % unit, decimals);
+    *--p = '.';
+  }
+  p = writeDigits(p, mag / unit, 1);
+  if (price < 0 && mag != 0)
+    *--p = '-';
+  return copyOut(buf, size, p, end);
+}
+
+int formatDisplayPrice(char *buf, size_t size, price_fx_t price, uint8_t decimals, uint8_t sigDigits)
+{
+  char tmp[40];
+  char *end = tmp + sizeof(tmp);
+  uint64_t mag = price < 0 ? -(uint64_t)price : (uint64_t)price;
+  if (decimals > PRICE_DECIMALS)
+    decimals = PRICE_DECIMALS;
+
+  // Significant digits left for the fraction: after the integer part, or
+  // after the fraction's leading zeros for prices below 1
+  uint64_t whole = mag / PRICE_SCALE;
+  int room = sigDigits;
+  uint64_t nextDigit = 1; // the whole part reaching this took another digit
+  if (whole != 0)
+  {
+    for (uint64_t v = whole; v != 0; v /= 10)
+    {
+      nextDigit *= 10;
+      if (room > 0)
+        room--;
+    }
+  }
+  else
+  {
+    for (uint64_t limit = PRICE_SCALE / 10; limit > 0 && mag < limit; limit /= 10)
+      room++;
+  }
+  uint8_t shown = room < decimals ? (uint8_t)room : decimals;
+
+  uint64_t div = 1;
+  for (int i = shown; i < PRICE_DECIMALS; i++)
+    div *= 10;
+  mag = (mag + div / 2) / div;
+  uint64_t unit = 1;
+  for (int i = 0; i < shown; i++)
+    unit *= 10;
+  if (shown > 0 && mag / unit >= nextDigit)
+  {
+    mag /= 10; // rounded up to a power of ten, e.g. 99,999.995: the dropped digit is 0
+    unit /= 10;
+    shown--;
+  }
+
+  char *p = end;
+  if (shown > 0)
+  {
+    p = writeDigits(p, mag % unit, shown);
+    *--p = '.';
+  }
+  whole = mag / unit;
+  for (int group = 0;; group++)
+  {
+    if (group > 0)
+      *--p = ',';
+    if (whole < 1000)
+    {
+      p = writeDigits(p, whole, 1);
+      break;
+    }
+    p = writeDigits(p, whole % 1000, 3);
+    whole /= 1000;
+  }
+  if (price < 0 && mag != 0)
+    *--p = '-';
+  return copyOut(buf, size, p, end);
+}
+
+int formatChangeBp(char *buf, size_t size, int32_t changeBp)
+{
+  static const char prefix[] = "24h: ";
+  char tmp[24];
+  char *end = tmp + sizeof(tmp);
+  uint32_t mag = changeBp < 0 ? -(uint32_t)changeBp : (uint32_t)changeBp;
+
+  char *p = end;
+  *--p = '%';
+  p = writeDigits(p, mag % 100, 2);
+  *--p = '.';
+  p = writeDigits(p, mag / 100, 1);
+  if (changeBp < 0)
+    *--p = '-';
+  for (int i = sizeof(prefix) - 2; i >= 0; i--)
+    *--p = prefix[i];
+  return copyOut(buf, size, p, end);
+}
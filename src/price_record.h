@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PRICE_DECIMALS 8
+#define PRICE_SCALE 100000000LL // fixed-point prices are in units of 1e-8
+#define PRICE_RING_LEN 6
+#define PRICE_SIG_DIGITS 7 // shown on a tile; the integer part is never cut
+
+typedef int64_t price_fx_t;
+
+#define PRICE_RECORD_CACHED 0x01 // restored from flash, not refreshed yet
+
+// Latest quote plus a short ring of previous ticks for one symbol, laid out
+// to fill exactly one 64-byte cache line.
+struct PriceRecord
+{
+  int32_t changeBp;   // 24h change in 1/100 percent
+  uint32_t updatedAt; // millis() of the latest tick
+  uint8_t head;       // ring index of the latest tick
+  uint8_t count;      // ticks stored, 0 = no price yet
+  uint8_t flags;
+  uint8_t decimals;   // tick precision, the most decimals any of its prices had
+  uint8_t reserved[4];
+  price_fx_t ticks[PRICE_RING_LEN];
+
+  bool hasPrice() const { return count > 0; }
+  price_fx_t price() const { return ticks[head]; }
+  price_fx_t tick(int age) const; // 0 = latest, up to count - 1
+  void push(price_fx_t price, int32_t change, uint32_t now);
+};
+
+static_assert(sizeof(PriceRecord) == 64, "PriceRecord must stay one cache line");
+
+price_fx_t priceFromDouble(double value);
+int32_t changeBpFromDouble(double percent);
+
+// Exact decimal parsing of the exchange's strings, e.g. "67000.01000000";
+// digits past PRICE_DECIMALS are rounded. False if text is not a number or
+// out of range.
+bool parsePrice(const char *text, price_fx_t *price);
+bool parseChangeBp(const char *percent, int32_t *changeBp);
+int32_t changeBpFromPrices(price_fx_t last, price_fx_t open);
+uint8_t priceDecimals(price_fx_t price); // without trailing zeros
+
+// Integer-only formatting into caller-provided buffers; return the length
+int formatPrice(char *buf, size_t size, price_fx_t price, uint8_t decimals);
+// With thousands separators and at most sigDigits significant digits, but
+// no more than decimals after the point, e.g. 67,000.01 or 0.00001234
+int formatDisplayPrice(char *buf, size_t size, price_fx_t price, uint8_t decimals, uint8_t sigDigits);
+int formatChangeBp(char *buf, size_t size, int32_t changeBp);
@@ -0,0 +1,199 @@
+#include "price_source.h"
+
+#include <time.h>
+
+#define BITFINEX_FIELD_CHANGE 6 // DAILY_CHANGE_RELATIVE, a fraction
+#define BITFINEX_FIELD_LAST 7   // LAST_PRICE
+#define BITFINEX_FIELD_MAX 24   // characters kept of a field
+
+uint32_t PriceSource::rateLimitMs(int httpCode, const PriceClient &client) const
+{
+  if (httpCode != HTTP_CODE_TOO_MANY_REQUESTS)
+    return 0;
+  int retryAfter = atoi(client.header("Retry-After"));
+  return retryAfter > 0 ? retryAfter * 1000 : SOURCE_RATE_LIMIT_MS;
+}
+
+void BinanceSource::buildUrl(SourceUrl &url, const CoinStore &coins, const int *list, int count) const
+{
+  url.append(_host).append("/api/crypto?symbols=");
+  for (int i = 0; i < count; i++)
+  {
+    url.append(coins.symbol[list[i]]);
+    if (i < count - 1)
+      url.append(",");
+  }
+}
+
+bool BinanceSource::parse(HttpBodyReader &body, const CoinStore &coins, QuoteFn fn, void *ctx,
+                          TickerParseStats *stats) const
+{
+  return parseTickerStream(
+      body,
+      [&](size_t index, JsonObjectConst item)
+      {
+        int coin;
+        const char *symbol = item["symbol"];
+        if (symbol == NULL)
+          coin = (int)index < coins.count ? (int)index : -1; // no symbol: rely on the request order
+        else
+          coin = findTickerCoin(coins, symbol, (int)index);
+        if (coin < 0)
+          return;
+
+        // The exchange sends decimal strings; parsed exactly, without a
+        // float. Plain JSON numbers, e.g. from a recorded or proxied
+        // response, go through double.
+        price_fx_t price;
+        int32_t changeBp;
+        const char *lastPrice = item["lastPrice"];
+        const char *changePercent = item["priceChangePercent"];
+        if (lastPrice == NULL)
+          price = priceFromDouble(item["lastPrice"].as<double>());
+        else if (!parsePrice(lastPrice, &price))
+          return;
+        if (changePercent == NULL || !parseChangeBp(changePercent, &changeBp))
+          changeBp = changeBpFromDouble(item["priceChangePercent"].as<double>());
+        fn(ctx, coin, price, changeBp);
+      },
+      stats);
+}
+
+// 429 (or 418, banned for ignoring 429s) with Retry-After, and a pause until
+// the minute is over once the used weight gets high
+uint32_t BinanceSource::rateLimitMs(int httpCode, const PriceClient &client) const
+{
+  if (httpCode == HTTP_CODE_TOO_MANY_REQUESTS || httpCode == 418)
+    return atoi(client.header("Retry-After")) * 1000;
+  const char *weight = client.header("X-MBX-USED-WEIGHT-1M");
+  if (*weight != '\0' && atoi(weight) > RATE_WEIGHT_SOFT_LIMIT)
+    return (60 - time(NULL) % 60) * 1000; // the weight resets each minute
+  return 0;
+}
+
+// tBTCUSD, or tDOGE:USD for symbols longer than three letters
+void BitfinexSource::buildUrl(SourceUrl &url, const CoinStore &coins, const int *list, int count) const
+{
+  url.append(_host).append("/v2/tickers?symbols=");
+  for (int i = 0; i < count; i++)
+  {
+    const char *symbol = coins.symbol[list[i]];
+    url.append("t").append(symbol).append(strlen(symbol) > 3 ? ":USD" : "USD");
+    if (i < count - 1)
+      url.append(",");
+  }
+}
+
+static int findBitfinexCoin(const CoinStore &coins, const char *symbol, int hint)
+{
+  if (*symbol++ != 't')
+    return -1;
+  for (int i = -1; i < coins.count; i++)
+  {
+    int coin = i < 0 ? hint : i;
+    if (coin < 0 || coin >= coins.count)
+      continue;
+    size_t n = strlen(coins.symbol[coin]);
+    if (strncmp(symbol, coins.symbol[coin], n) == 0 &&
+        (strcmp(symbol + n, "USD") == 0 || strcmp(symbol + n, ":USD") == 0))
+      return coin;
+  }
+  return -1;
+}
+
+// One field of a row: a string without its quotes, or a number or literal
+// as it is, cut to size. Returns the ',' or ']' after it, -1 if malformed.
+static int readField(TickerReader<HttpBodyReader> &reader, char *text, size_t size)
+{
+  size_t n = 0;
+  int c = reader.readNonSpace();
+  if (c == '"')
+  {
+    while ((c = reader.read()) != '"')
+    {
+      if (c < 0)
+        return -1;
+      if (c == '\\')
+        c = reader.read();
+      if (n + 1 < size)
+        text[n++] = (char)c;
+    }
+    c = reader.readNonSpace();
+  }
+  else
+  {
+    while (c >= 0 && c != ',' && c != ']' && c != '[' && c != '{')
+    {
+      if (c != ' ' && c != '\t' && c != '\r' && c != '\n' && n + 1 < size)
+        text[n++] = (char)c;
+      c = reader.read();
+    }
+  }
+  text[n] = '\0';
+  return c == ',' || c == ']' ? c : -1;
+}
+
+// Positional rows aren't what ArduinoJson's filter can trim, and their
+// numbers would come out as doubles; a row is only a dozen flat fields, so
+// they are scanned here instead, keeping the digits as sent.
+bool BitfinexSource::parse(HttpBodyReader &body, const CoinStore &coins, QuoteFn fn, void *ctx,
+                           TickerParseStats *stats) const
+{
+  TickerReader<HttpBodyReader> reader(body);
+  size_t count = 0;
+  bool ok = false;
+  char symbol[BITFINEX_FIELD_MAX];
+  char change[BITFINEX_FIELD_MAX];
+  char last[BITFINEX_FIELD_MAX];
+  char field[BITFINEX_FIELD_MAX];
+
+  if (reader.readNonSpace() == '[')
+  {
+    int c = reader.readNonSpace();
+    ok = c == ']';
+    while (c == '[')
+    {
+      symbol[0] = change[0] = last[0] = '\0';
+      int end = ',';
+      for (int i = 0; end == ','; i++)
+      {
+        char *text = i == 0 ? symbol : i == BITFINEX_FIELD_CHANGE ? change : i == BITFINEX_FIELD_LAST ? last : field;
+        end = readField(reader, text, BITFINEX_FIELD_MAX);
+      }
+      if (end != ']')
+        break;
+
+      int coin = findBitfinexCoin(coins, symbol, (int)count);
+      count++;
+      price_fx_t price;
+      price_fx_t relative;
+      if (coin >= 0 && *last != '\0')
+      {
+        if (!parsePrice(last, &price))
+          price = priceFromDouble(strtod(last, NULL)); // e.g. 1.2e-05
+        int32_t changeBp;
+        if (parsePrice(change, &relative))
+          changeBp = (int32_t)((relative + (relative < 0 ? -5000 : 5000)) / 10000); // a fraction, 1 bp = 10000
+        else
+          changeBp = changeBpFromDouble(strtod(change, NULL) * 100);
+        fn(ctx, coin, price, changeBp);
+      }
+
+      c = reader.readNonSpace();
+      if (c == ']')
+      {
+        ok = true;
+        break;
+      }
+      c = c == ',' ? reader.readNonSpace() : -1;
+    }
+  }
+
+  if (stats != NULL)
+  {
+    stats->count = count;
+    stats->bytesRead = reader.bytesRead();
+    stats->peakDocUsage = 0;
+  }
+  return ok;
+}
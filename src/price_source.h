@@ -0,0 +1,61 @@
+#pragma once
+
+#include "coin_store.h"
+#include "fixed_text.h"
+#include "price_client.h"
+#include "ticker_parser.h"
+
+#define SOURCE_RATE_LIMIT_MS 60000 // a 429 without Retry-After
+#define RATE_WEIGHT_SOFT_LIMIT 3000 // X-MBX-USED-WEIGHT-1M above this: pause until the next minute
+
+typedef FixedText<HTTP_REQUEST_MAX> SourceUrl;
+
+// Called by a source for each quote of a watched coin in a response
+typedef void (*QuoteFn)(void *ctx, int coin, price_fx_t price, int32_t changeBp);
+
+// Adapter for one exchange's REST ticker endpoint: how to ask for a set of
+// coins and how to pull their quotes out of the answer as it streams in,
+// without holding more than one element at a time.
+class PriceSource
+{
+public:
+  virtual ~PriceSource() {}
+  virtual const char *name() const = 0;
+  virtual void buildUrl(SourceUrl &url, const CoinStore &coins, const int *list, int count) const = 0;
+  // False on malformed or truncated input; quotes reported before are valid
+  virtual bool parse(HttpBodyReader &body, const CoinStore &coins, QuoteFn fn, void *ctx,
+                     TickerParseStats *stats) const = 0;
+  // How long to leave the source alone after this answer, 0 = no limit hit
+  virtual uint32_t rateLimitMs(int httpCode, const PriceClient &client) const;
+};
+
+// Binance's 24hr ticker, or a proxy answering in its format:
+//   host/api/crypto?symbols=BTC,ETH -> [{"symbol":"BTCUSDT","lastPrice":"67000.01",...},...]
+// Its weight header is watched so we slow down before being rate limited.
+class BinanceSource : public PriceSource
+{
+public:
+  explicit BinanceSource(const char *host) : _host(host) {}
+  const char *name() const { return "binance"; }
+  void buildUrl(SourceUrl &url, const CoinStore &coins, const int *list, int count) const;
+  bool parse(HttpBodyReader &body, const CoinStore &coins, QuoteFn fn, void *ctx, TickerParseStats *stats) const;
+  uint32_t rateLimitMs(int httpCode, const PriceClient &client) const;
+
+private:
+  const char *_host;
+};
+
+// Bitfinex's public tickers, one array of fields per symbol, numbers unquoted:
+//   host/v2/tickers?symbols=tBTCUSD,tDOGE:USD -> [["tBTCUSD",BID,...,DAILY_CHANGE_RELATIVE,LAST_PRICE,...],...]
+// Prices are against USD rather than USDT.
+class BitfinexSource : public PriceSource
+{
+public:
+  explicit BitfinexSource(const char *host) : _host(host) {}
+  const char *name() const { return "bitfinex"; }
+  void buildUrl(SourceUrl &url, const CoinStore &coins, const int *list, int count) const;
+  bool parse(HttpBodyReader &body, const CoinStore &coins, QuoteFn fn, void *ctx, TickerParseStats *stats) const;
+
+private:
+  const char *_host;
+};
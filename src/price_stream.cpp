@@ -0,0 +1,82 @@
+#include "price_stream.h"
+
+PriceStream::PriceStream()
+{
+  _client.setInsecure(); // like PriceClient
+  _symbol[0] = '\0';
+}
+
+bool PriceStream::connect(const char *baseUrl, const CoinStore &coins)
+{
+  close();
+
+  _url.clear();
+  _url.append(baseUrl).append("/stream?streams=");
+  for (int i = 0; i < coins.count; i++)
+  {
+    char stream[COIN_SYMBOL_LEN + 20];
+    int n = snprintf(stream, sizeof(stream), "%s%susdt@miniTicker", i > 0 ? "/" : "", coins.symbol[i]);
+    if (_url.length() + n >= STREAM_URL_MAX)
+      break;
+    for (char *c = stream; *c != '\0'; c++)
+    {
+      if (*c != '@')
+        *c = tolower(*c);
+    }
+    _url.append(stream);
+  }
+
+  if (!_ws.connect(_client, _url.c_str()))
+  {
+    _stats.failures++;
+    return false;
+  }
+  static_cast<Stream &>(_client).setTimeout(1000); // for the rest of a frame once its header is in
+  _stats.connects++;
+  _connectedAt = millis();
+  _open = true;
+  return true;
+}
+
+void PriceStream::close()
+{
+  _open = false;
+  _ws.close();
+}
+
+StreamResult PriceStream::next(uint32_t timeoutMs)
+{
+  if (!_ws.nextMessage(timeoutMs))
+  {
+    if (_ws.connected())
+      return STREAM_IDLE;
+    if (_open)
+      _stats.drops++;
+    close();
+    return STREAM_CLOSED;
+  }
+
+  StaticJsonDocument<TICKER_DOC_SIZE> doc;
+  TickerReader<WsClient> reader(_ws);
+  uint32_t start = micros();
+  DeserializationError error = deserializeJson(doc, reader, DeserializationOption::Filter(miniTickerFilter()));
+  _stats.parse.add(micros() - start);
+  _stats.messages++;
+  _stats.bytesRead += reader.bytesRead();
+
+  JsonObjectConst data = doc["data"];
+  const char *symbol = data["s"];
+  const char *last = data["c"];
+  const char *open = data["o"];
+  price_fx_t openPrice = 0;
+  if (error || symbol == NULL || last == NULL || open == NULL || !parsePrice(last, &_price) ||
+      !parsePrice(open, &openPrice) || openPrice <= 0)
+  {
+    _stats.parseErrors++;
+    return STREAM_IDLE;
+  }
+  strncpy(_symbol, symbol, sizeof(_symbol) - 1);
+  _symbol[sizeof(_symbol) - 1] = '\0';
+  _changeBp = changeBpFromPrices(_price, openPrice);
+  return STREAM_TICKER;
+}
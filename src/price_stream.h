@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include "coin_store.h"
+#include "ticker_parser.h"
+#include "ws_client.h"
+
+#define STREAM_URL_MAX 1024 // longest subscription URL; symbols beyond it are left out
+
+struct StreamStats
+{
+  uint32_t connects;
+  uint32_t failures; // connection or upgrade refused
+  uint32_t drops;    // established streams that ended
+  uint32_t messages;
+  uint32_t parseErrors;
+  uint32_t bytesRead; // JSON bytes, without the frame headers
+  TickerParseTimings parse;
+};
+
+enum StreamResult
+{
+  STREAM_TICKER, // symbol(), price() and changeBp() hold the new values
+  STREAM_IDLE,   // no ticker arrived in time
+  STREAM_CLOSED
+};
+
+// Push feed for the watchlist: one WebSocket connection subscribed to the
+// miniTicker stream of every coin. Each message is parsed straight off the
+// socket through a field filter, like the polled ticker response.
+class PriceStream
+{
+public:
+  PriceStream();
+
+  // baseUrl: e.g. "wss://stream.binance.com:9443"
+  bool connect(const char *baseUrl, const CoinStore &coins);
+  bool connected() { return _ws.connected(); }
+  void close();
+
+  StreamResult next(uint32_t timeoutMs);
+  const char *symbol() const { return _symbol; }
+  price_fx_t price() const { return _price; }
+  int32_t changeBp() const { return _changeBp; }
+
+  uint32_t connectedAt() const { return _connectedAt; } // millis()
+  const StreamStats &stats() const { return _stats; }
+  uint32_t pings() const { return _ws.pings(); }
+
+private:
+  WiFiClientSecure _client;
+  WsClient _ws;
+  FixedText<STREAM_URL_MAX> _url;
+  char _symbol[COIN_SYMBOL_LEN + 8];
+  price_fx_t _price = 0;
+  int32_t _changeBp = 0;
+  uint32_t _connectedAt = 0;
+  bool _open = false; // not closed by us, for the drop counter
+  StreamStats _stats = {};
+};
@@ -0,0 +1,170 @@
+#include "refresh_scheduler.h"
+
+#include <Arduino.h>
+
+#define MINUTE_MS 60000
+
+void RefreshScheduler::begin(int count)
+{
+  _count = count;
+}
+
+uint32_t RefreshScheduler::interval(int coin) const
+{
+  uint32_t ms = REFRESH_DEFAULT_MS;
+  if (_rateBpH[coin] != 0)
+  {
+    uint64_t expected = (uint64_t)REFRESH_MOVE_BP * 3600000 / _rateBpH[coin];
+    ms = expected > REFRESH_MAX_MS ? REFRESH_MAX_MS : expected < REFRESH_MIN_MS ? REFRESH_MIN_MS : (uint32_t)expected;
+  }
+  if (coin == _focus && ms > REFRESH_VISIBLE_MAX_MS)
+    ms = REFRESH_VISIBLE_MAX_MS;
+  if (_lowPower)
+    ms *= REFRESH_LOW_POWER_FACTOR;
+  return ms;
+}
+
+uint32_t RefreshScheduler::wait(uint32_t now) const
+{
+  if (_blocked && (int32_t)(_blockedUntil - now) > 0)
+    return _blockedUntil - now;
+  if (_forced)
+    return 0;
+  uint32_t next = UINT32_MAX;
+  for (int i = 0; i < _count; i++)
+  {
+    if (!_attempted[i])
+      return 0;
+    uint32_t elapsed = now - _attemptMs[i];
+    uint32_t period = interval(i);
+    next = min(next, elapsed >= period ? 0 : period - elapsed);
+  }
+  return next;
+}
+
+int RefreshScheduler::take(uint32_t now, int *coins)
+{
+  if (wait(now) != 0)
+    return 0;
+  bool forced = _forced.exchange(false);
+  _blocked = false;
+  int count = 0;
+  for (int i = 0; i < _count; i++)
+  {
+    uint32_t elapsed = now - _attemptMs[i];
+    if (forced || !_attempted[i] || elapsed + REFRESH_BATCH_MS >= interval(i))
+    {
+      coins[count++] = i;
+      _attempted[i] = true;
+      _inFlight[i] = true;
+      _attemptMs[i] = now;
+    }
+    else
+    {
+      _inFlight[i] = false;
+    }
+  }
+
+  _stats.requests++;
+  _stats.symbolsRequested += count;
+  uint32_t minute = now / MINUTE_MS;
+  for (uint32_t m = _minute + 1; m <= minute && m <= _minute + 60; m++)
+    _minuteCounts[m % 60] = 0; // minutes without requests
+  _minute = minute;
+  _minuteCounts[minute % 60]++;
+  return count;
+}
+
+uint32_t RefreshScheduler::requestsLastHour(uint32_t now) const
+{
+  uint32_t minute = now / MINUTE_MS;
+  uint32_t total = 0;
+  for (uint32_t k = 0; k < 60 && k <= _minute; k++)
+  {
+    if (minute - (_minute - k) < 60)
+      total += _minuteCounts[(_minute - k) % 60];
+  }
+  return total;
+}
+
+void RefreshScheduler::onPrice(int coin, price_fx_t price, uint32_t now)
+{
+  if (_priceMs[coin] != 0)
+    _maxAgeMs[coin] = max(_maxAgeMs[coin], now - _priceMs[coin]);
+  _priceMs[coin] = now;
+
+  if (_refPrice[coin] <= 0 || price <= 0)
+  {
+    _refPrice[coin] = price;
+    _refMs[coin] = now;
+    return;
+  }
+  uint32_t span = now - _refMs[coin];
+  if (span < REFRESH_VOL_SAMPLE_MS)
+    return; // streamed ticks: wait for a longer span
+  price_fx_t ref = _refPrice[coin];
+  price_fx_t move = price > ref ? price - ref : ref - price;
+  while (move > INT64_MAX / 10000)
+  {
+    move >>= 1;
+    ref >>= 1;
+  }
+  uint64_t moveBp = move * 10000 / ref;
+  uint32_t sample = (uint32_t)min<uint64_t>(moveBp * 3600000 / span, UINT32_MAX / 4);
+  uint32_t rate = _rateBpH[coin] == 0 ? sample : (_rateBpH[coin] * 3 + sample) / 4;
+  _rateBpH[coin] = rate > 0 ? rate : 1; // known, and quiet
+  _refPrice[coin] = price;
+  _refMs[coin] = now;
+}
+
+uint32_t RefreshScheduler::ageMs(int coin, uint32_t now) const
+{
+  return _priceMs[coin] == 0 ? UINT32_MAX : now - _priceMs[coin];
+}
+
+void RefreshScheduler::onSuccess()
+{
+  _failures = 0;
+  for (int i = 0; i < _count; i++)
+    _inFlight[i] = false;
+}
+
+// The last request's symbols are due again as soon as the wait is over
+void RefreshScheduler::retryInFlight()
+{
+  for (int i = 0; i < _count; i++)
+  {
+    if (_inFlight[i])
+      _attempted[i] = false;
+    _inFlight[i] = false;
+  }
+}
+
+// Exponential backoff with equal jitter: half the step is fixed, half random
+void RefreshScheduler::onFailure(uint32_t now, RefreshFailure kind)
+{
+  if (_failures < 16)
+    _failures++;
+  uint32_t step = REFRESH_BACKOFF_MIN_MS;
+  for (uint8_t i = 1; i < _failures && step < REFRESH_BACKOFF_MAX_MS; i++)
+    step *= 2;
+  step = min(step, (uint32_t)REFRESH_BACKOFF_MAX_MS);
+  uint32_t delayMs = step / 2 + random(step / 2 + 1);
+  _stats.failures++;
+  if (kind == REFRESH_FAIL_WIFI)
+    _stats.wifiFailures++;
+  _stats.backoffMs = delayMs;
+  _blockedUntil = now + delayMs;
+  _blocked = true;
+  retryInFlight();
+}
+
+void RefreshScheduler::onRateLimited(uint32_t now, uint32_t retryAfterMs)
+{
+  retryAfterMs = max(retryAfterMs, (uint32_t)REFRESH_BACKOFF_MIN_MS);
+  _stats.rateLimited++;
+  if (!_blocked || (int32_t)(now + retryAfterMs - _blockedUntil) > 0)
+    _blockedUntil = now + retryAfterMs;
+  _blocked = true;
+  retryInFlight();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include "coin_store.h"
+#include "price_record.h"
+
+#define REFRESH_MIN_MS 20000            // never poll a symbol more often
+#define REFRESH_MAX_MS (60000 * 15)     // nor less often, unless in low power
+#define REFRESH_DEFAULT_MS (60000 * 5)  // until its volatility is known
+#define REFRESH_VISIBLE_MAX_MS 60000    // the coin on screen
+#define REFRESH_LOW_POWER_FACTOR 4      // intervals are stretched this much on battery saving
+#define REFRESH_MOVE_BP 10              // poll about when a symbol is expected to have moved this much
+#define REFRESH_BATCH_MS 15000          // symbols due this soon go along with a request anyway
+#define REFRESH_VOL_SAMPLE_MS 10000     // shortest span a volatility sample is taken over
+#define REFRESH_BACKOFF_MIN_MS 2000
+#define REFRESH_BACKOFF_MAX_MS (60000 * 10)
+
+enum RefreshFailure
+{
+  REFRESH_FAIL_WIFI,
+  REFRESH_FAIL_HTTP, // connection errors and 5xx
+};
+
+// What the scheduler spent and what it got, for trading freshness against
+// radio time
+struct RefreshStats
+{
+  uint32_t requests;
+  uint32_t symbolsRequested;
+  uint32_t failures;
+  uint32_t wifiFailures; // of those
+  uint32_t rateLimited; // 429/418 answers and voluntary waits on the used weight
+  uint32_t backoffMs;   // the last wait after a failure
+};
+
+// Decides when the fetch task polls which symbols. Each symbol gets its own
+// interval: the time it takes, at its recent volatility, to move about
+// REFRESH_MOVE_BP, shortened while it is on screen and stretched in low power.
+// Due symbols, plus those due within REFRESH_BATCH_MS, go into one request.
+// Failures back off exponentially with jitter and rate-limit answers are
+// honoured before anything else is sent. Runs on the fetch task; focus(),
+// setLowPower() and requestNow() may be called from the UI.
+class RefreshScheduler
+{
+public:
+  void begin(int count);
+
+  // UI side
+  void focus(int coin) { _focus = coin; } // -1: no coin on screen
+  void setLowPower(bool lowPower) { _lowPower = lowPower; }
+  void requestNow() { _forced = true; } // everything, once backoff allows
+
+  uint32_t wait(uint32_t now) const; // ms until something is due, 0 = now
+  int take(uint32_t now, int *coins); // the symbols to request now, fills coins[]
+  void onPrice(int coin, price_fx_t price, uint32_t now); // from a response or the stream
+
+  void onSuccess();
+  void onFailure(uint32_t now, RefreshFailure kind);
+  void onRateLimited(uint32_t now, uint32_t retryAfterMs);
+
+  uint32_t interval(int coin) const;
+  uint32_t ageMs(int coin, uint32_t now) const; // since its last price, UINT32_MAX if none
+  uint32_t maxAgeMs(int coin) const { return _maxAgeMs[coin]; }
+  uint32_t requestsLastHour(uint32_t now) const;
+  const RefreshStats &stats() const { return _stats; }
+
+private:
+  void retryInFlight();
+
+  int _count = 0;
+  uint32_t _attemptMs[MAX_COINS] = {}; // last request that included the symbol
+  bool _attempted[MAX_COINS] = {};
+  bool _inFlight[MAX_COINS] = {}; // taken, answer pending
+  uint32_t _priceMs[MAX_COINS] = {};
+  uint32_t _maxAgeMs[MAX_COINS] = {}; // worst age at the moment a new price came in
+  price_fx_t _refPrice[MAX_COINS] = {}; // start of the current volatility sample
+  uint32_t _refMs[MAX_COINS] = {};
+  uint32_t _rateBpH[MAX_COINS] = {}; // smoothed movement, bp per hour; 0 = unknown
+
+  uint32_t _blockedUntil = 0; // backoff or rate limit
+  bool _blocked = false;
+  uint8_t _failures = 0;
+
+  // Requests per minute over the last hour
+  uint16_t _minuteCounts[60] = {};
+  uint32_t _minute = 0; // of the newest count
+
+  std::atomic<int> _focus{-1};
+  std::atomic<bool> _lowPower{false};
+  std::atomic<bool> _forced{false};
+  RefreshStats _stats = {};
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// Single-producer/single-consumer "latest value" mailbox (a triple buffer).
+// The producer owns one slot, the consumer owns another and the third one is
+// handed over with a single atomic exchange, so neither side ever blocks and
+// the consumer always sees a complete value. Values that are published faster
+// than they are consumed are simply overwritten by newer ones.
+template <typename T>
+class SpscMailbox
+{
+public:
+  SpscMailbox() : _middle(1), _back(0), _front(2) {}
+
+  // Producer side: fill writeSlot(), then publish() it.
+  T &writeSlot() { return _slots[_back]; }
+
+  void publish()
+  {
+    uint8_t prev = _middle.exchange(_back | FRESH, std::memory_order_acq_rel);
+    _back = prev & INDEX_MASK;
+  }
+
+  // Consumer side: returns true if a newer value was swapped into readSlot().
+  bool consume()
+  {
+    if (!(_middle.load(std::memory_order_acquire) & FRESH))
+      return false;
+    uint8_t prev = _middle.exchange(_front, std::memory_order_acq_rel);
+    _front = prev & INDEX_MASK;
+    return true;
+  }
+
+  const T &readSlot() const { return _slots[_front]; }
+  bool fresh() const { return _middle.load(std::memory_order_acquire) & FRESH; } // consume() would succeed
+
+private:
+  static const uint8_t INDEX_MASK = 0x03;
+  static const uint8_t FRESH = 0x04;
+
+  T _slots[3];
+  std::atomic<uint8_t> _middle;
+  uint8_t _back;  // only touched by the producer
+  uint8_t _front; // only touched by the consumer
+};
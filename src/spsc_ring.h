@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Single-producer/single-consumer FIFO of N - 1 values. Unlike SpscMailbox
+// every value is kept, in order, until the consumer takes it; when the ring
+// is full the producer's push() fails instead of overwriting. Safe to push
+// from an interrupt or another core without locks.
+template <typename T, size_t N>
+class SpscRing
+{
+public:
+  static_assert((N & (N - 1)) == 0, "N must be a power of two");
+
+  bool push(const T &value)
+  {
+    uint32_t head = _head.load(std::memory_order_relaxed);
+    uint32_t next = (head + 1) & (N - 1);
+    if (next == _tail.load(std::memory_order_acquire))
+      return false;
+    _items[head] = value;
+    _head.store(next, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T *value)
+  {
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire))
+      return false;
+    *value = _items[tail];
+    _tail.store((tail + 1) & (N - 1), std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const { return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire); }
+
+private:
+  T _items[N];
+  std::atomic<uint32_t> _head{0}; // written by the producer
+  std::atomic<uint32_t> _tail{0}; // written by the consumer
+};
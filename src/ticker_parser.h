@@ -0,0 +1,197 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include <string.h>
+#include "coin_store.h"
+
+// Streaming parser for the 24hr ticker response, an array of objects:
+//   [{"symbol":"BTCUSDT","lastPrice":"67000.01","priceChangePercent":"-1.2",...},...]
+// Elements are deserialized one at a time straight from the source stream
+// through a field filter, so only the fields we display are ever stored and
+// the peak document size does not depend on the number of symbols.
+
+#define TICKER_DOC_SIZE 256 // one filtered element plus room for a skipped key
+
+struct TickerParseStats
+{
+  size_t count;        // elements parsed
+  size_t bytesRead;    // bytes consumed from the stream
+  size_t peakDocUsage; // largest JsonDocument::memoryUsage() seen
+};
+
+// Time spent parsing, across responses; measured by the caller
+struct TickerParseTimings
+{
+  uint32_t parses;
+  uint32_t lastUs;
+  uint32_t totalUs;
+  uint32_t maxUs;
+
+  void add(uint32_t us)
+  {
+    parses++;
+    lastUs = us;
+    totalUs += us;
+    if (us > maxUs)
+      maxUs = us;
+  }
+};
+
+// Built once, shared by every parse
+inline JsonDocument &tickerFilter()
+{
+  static StaticJsonDocument<96> filter;
+  if (filter.isNull())
+  {
+    filter["symbol"] = true;
+    filter["lastPrice"] = true;
+    filter["priceChangePercent"] = true;
+  }
+  return filter;
+}
+
+// One message of a combined miniTicker stream:
+//   {"stream":"btcusdt@miniTicker","data":{"e":"24hrMiniTicker","s":"BTCUSDT","c":"67000.01","o":"66000.00",...}}
+// "c" is the last price and "o" the price 24 hours ago.
+inline JsonDocument &miniTickerFilter()
+{
+  static StaticJsonDocument<128> filter;
+  if (filter.isNull())
+  {
+    JsonObject data = filter.createNestedObject("data");
+    data["s"] = true;
+    data["c"] = true;
+    data["o"] = true;
+  }
+  return filter;
+}
+
+// Wraps ArduinoJson's own reader for TStream (ArduinoStreamReader for an
+// Arduino Stream, so the stream timeout is honoured) and adds one byte of
+// push-back plus a byte counter.
+template <typename TStream>
+class TickerReader
+{
+public:
+  explicit TickerReader(TStream &stream) : _reader(stream) {}
+
+  int read()
+  {
+    if (_pending >= 0)
+    {
+      int c = _pending;
+      _pending = -1;
+      return c;
+    }
+    int c = _reader.read();
+    if (c >= 0)
+      _bytesRead++;
+    return c;
+  }
+
+  size_t readBytes(char *buffer, size_t length)
+  {
+    size_t n = 0;
+    if (length > 0 && _pending >= 0)
+    {
+      buffer[n++] = (char)_pending;
+      _pending = -1;
+    }
+    size_t got = _reader.readBytes(buffer + n, length - n);
+    _bytesRead += got;
+    return n + got;
+  }
+
+  void unread(int c) { _pending = c; }
+
+  int readNonSpace()
+  {
+    int c;
+    do
+    {
+      c = read();
+    } while (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+    return c;
+  }
+
+  size_t bytesRead() const { return _bytesRead; }
+
+private:
+  ARDUINOJSON_NAMESPACE::Reader<TStream> _reader;
+  int _pending = -1;
+  size_t _bytesRead = 0;
+};
+
+// Calls onItem(index, JsonObjectConst) for each array element, in order.
+// Returns false on malformed input or a truncated stream; elements reported
+// before the error are still valid.
+template <typename TStream, typename TCallback>
+bool parseTickerStream(TStream &stream, TCallback onItem, TickerParseStats *stats = NULL)
+{
+  TickerReader<TStream> reader(stream);
+  StaticJsonDocument<TICKER_DOC_SIZE> doc;
+  DeserializationOption::Filter filter(tickerFilter());
+  size_t count = 0;
+  size_t peak = 0;
+  bool ok = false;
+
+  if (reader.readNonSpace() == '[')
+  {
+    int c = reader.readNonSpace();
+    if (c == ']')
+    {
+      ok = true;
+    }
+    else
+    {
+      reader.unread(c);
+      for (;;)
+      {
+        if (deserializeJson(doc, reader, filter))
+          break;
+        if (doc.memoryUsage() > peak)
+          peak = doc.memoryUsage();
+        onItem(count++, doc.as<JsonObjectConst>());
+
+        c = reader.readNonSpace();
+        if (c == ']')
+        {
+          ok = true;
+          break;
+        }
+        if (c != ',')
+          break;
+      }
+    }
+  }
+
+  if (stats != NULL)
+  {
+    stats->count = count;
+    stats->bytesRead = reader.bytesRead();
+    stats->peakDocUsage = peak;
+  }
+  return ok;
+}
+
+// True if a ticker symbol such as "BTCUSDT" belongs to the coin "BTC"
+inline bool tickerSymbolMatches(const char *symbol, const char *coin)
+{
+  size_t n = strlen(coin);
+  return strncmp(symbol, coin, n) == 0 &&
+         (symbol[n] == '\0' || strcmp(symbol + n, "USDT") == 0);
+}
+
+// Index of a ticker symbol such as "BTCUSDT" in coins, -1 if not watched.
+// hint is checked first: responses usually come in request order.
+inline int findTickerCoin(const CoinStore &coins, const char *symbol, int hint)
+{
+  if (hint >= 0 && hint < coins.count && tickerSymbolMatches(symbol, coins.symbol[hint]))
+    return hint;
+  for (int i = 0; i < coins.count; i++)
+  {
+    if (tickerSymbolMatches(symbol, coins.symbol[i]))
+      return i;
+  }
+  return -1;
+}
@@ -0,0 +1,221 @@
+#include "tile_pager.h"
+
+lv_obj_t *TilePager::begin(lv_obj_t *parent, int coinCount, CreateFn create, BindFn bind)
+{
+  _coinCount = coinCount;
+  _bind = bind;
+  _page = 0;
+
+  _view = lv_tileview_create(parent);
+  for (int i = 0; i < TILE_SLOTS; i++)
+  {
+    CoinTile &slot = _slots[i];
+    slot.tile = lv_tileview_add_tile(_view, i, 0, LV_DIR_HOR);
+    slot.page = -1;
+    slot.shownNeedle = INT16_MIN;
+    slot.shownTrend = INT8_MIN;
+    slot.priceText[0] = '\0';
+    slot.changeText[0] = '\0';
+    create(slot);
+  }
+  lv_obj_add_event_cb(_view, onValueChanged, LV_EVENT_VALUE_CHANGED, this);
+  lv_obj_add_event_cb(_view, onScroll, LV_EVENT_SCROLL_BEGIN, this);
+  lv_obj_add_event_cb(_view, onScroll, LV_EVENT_SCROLL_END, this);
+  bindSlots();
+  jumpToMiddle();
+  return _view;
+}
+
+void TilePager::setInfoPage(lv_obj_t *info)
+{
+  _info = info;
+  bindSlots();
+}
+
+bool TilePager::pageInView(int page) const
+{
+  if (!_scrolling)
+    return page == _page;
+  for (int i = 0; i < TILE_SLOTS; i++)
+  {
+    if (_slots[i].page == page)
+      return true;
+  }
+  return false;
+}
+
+int TilePager::pageAt(int slot) const
+{
+  int pages = _coinCount + 1;
+  return ((_page + slot - 1) % pages + pages) % pages;
+}
+
+void TilePager::bindSlots()
+{
+  bool infoPlaced = false;
+  for (int n = 0; n < TILE_SLOTS; n++)
+  {
+    int i = (n + 1) % TILE_SLOTS; // visible tile first, it wins the info page
+    CoinTile &slot = _slots[i];
+    int page = pageAt(i);
+    bool isInfo = page == _coinCount;
+
+    // Coin widgets are hidden while the tile hosts the info page
+    lv_obj_t *widgets[] = {slot.meter, slot.nameLabel, slot.priceLabel, slot.changeLabel, slot.chart};
+    for (unsigned w = 0; w < sizeof(widgets) / sizeof(widgets[0]); w++)
+    {
+      if (isInfo)
+        lv_obj_add_flag(widgets[w], LV_OBJ_FLAG_HIDDEN);
+      else
+        lv_obj_clear_flag(widgets[w], LV_OBJ_FLAG_HIDDEN);
+    }
+
+    if (isInfo)
+    {
+      if (_info != NULL && !infoPlaced)
+      {
+        if (lv_obj_get_parent(_info) != slot.tile)
+          lv_obj_set_parent(_info, slot.tile);
+        infoPlaced = true;
+      }
+      slot.page = page;
+    }
+    else if (slot.page != page)
+    {
+      slot.page = page;
+      bindSlot(i);
+    }
+  }
+
+  if (_info != NULL)
+  {
+    if (infoPlaced)
+      lv_obj_clear_flag(_info, LV_OBJ_FLAG_HIDDEN);
+    else
+      lv_obj_add_flag(_info, LV_OBJ_FLAG_HIDDEN);
+  }
+}
+
+// Binds the visible tile now and defers the others
+void TilePager::bindSlot(int slot)
+{
+  if (slot == 1 || _scrolling)
+  {
+    _stale[slot] = false;
+    _bind(_slots[slot], _slots[slot].page);
+  }
+  else
+  {
+    _stale[slot] = true;
+  }
+}
+
+void TilePager::bindStale()
+{
+  for (int i = 0; i < TILE_SLOTS; i++)
+  {
+    if (_stale[i])
+    {
+      _stale[i] = false;
+      if (_slots[i].page >= 0 && _slots[i].page < _coinCount)
+        _bind(_slots[i], _slots[i].page);
+    }
+  }
+}
+
+void TilePager::recentre()
+{
+  lv_obj_t *active = lv_tileview_get_tile_act(_view);
+  int pages = _coinCount + 1;
+  if (active == _slots[0].tile)
+    _page = (_page + pages - 1) % pages;
+  else if (active == _slots[2].tile)
+    _page = (_page + 1) % pages;
+  else
+    return;
+
+  _scrolling = false; // the swipe has settled, only the new middle tile is needed now
+  bindSlots();
+  jumpToMiddle();
+  if (_viewChanged != NULL)
+    _viewChanged();
+}
+
+void TilePager::jumpToMiddle()
+{
+  _jumping = true;
+  lv_obj_set_tile_id(_view, 1, 0, LV_ANIM_OFF);
+  _jumping = false;
+}
+
+void TilePager::onValueChanged(lv_event_t *e)
+{
+  static_cast<TilePager *>(lv_event_get_user_data(e))->recentre();
+}
+
+void TilePager::onScroll(lv_event_t *e)
+{
+  TilePager *pager = static_cast<TilePager *>(lv_event_get_user_data(e));
+  if (pager->_jumping)
+    return;
+  pager->_scrolling = lv_event_get_code(e) == LV_EVENT_SCROLL_BEGIN;
+  if (pager->_scrolling)
+    pager->bindStale(); // the neighbours are about to come into view
+  if (pager->_viewChanged != NULL)
+    pager->_viewChanged();
+  if (!pager->_scrolling && pager->_steps != 0)
+  {
+    int dir = pager->_steps > 0 ? 1 : -1;
+    pager->_steps -= dir;
+    pager->step(dir);
+  }
+}
+
+void TilePager::next()
+{
+  step(1);
+}
+
+void TilePager::prev()
+{
+  step(-1);
+}
+
+// Steps asked for while the view still moves wait until it settles, so
+// quickly repeated keys aren't lost
+void TilePager::step(int dir)
+{
+  if (_scrolling)
+  {
+    _steps += dir;
+    return;
+  }
+  lv_obj_set_tile_id(_view, dir > 0 ? 2 : 0, 0, LV_ANIM_ON);
+}
+
+void TilePager::show(int page)
+{
+  _page = page;
+  bindSlots();
+  jumpToMiddle();
+  if (_viewChanged != NULL)
+    _viewChanged();
+}
+
+void TilePager::refresh(int coin)
+{
+  for (int i = 0; i < TILE_SLOTS; i++)
+  {
+    if (_slots[i].page == coin && coin < _coinCount)
+      bindSlot(i);
+  }
+}
+
+void TilePager::refreshAll()
+{
+  for (int i = 0; i < TILE_SLOTS; i++)
+  {
+    if (_slots[i].page >= 0 && _slots[i].page < _coinCount)
+      bindSlot(i);
+  }
+}
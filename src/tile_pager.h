@@ -0,0 +1,79 @@
+#pragma once
+
+#include "lvgl.h"
+
+#define TILE_SLOTS 3 // previous, visible, next
+
+// Widgets of one materialized coin tile, recycled as the user swipes
+struct CoinTile
+{
+  lv_obj_t *tile;
+  lv_obj_t *meter;
+  lv_meter_indicator_t *needle;
+  lv_obj_t *nameLabel;
+  lv_obj_t *priceLabel;
+  lv_obj_t *changeLabel;
+  lv_obj_t *chart;
+  lv_chart_series_t *lastSeries;
+  lv_chart_series_t *lowSeries;
+  lv_chart_series_t *highSeries;
+  char priceText[24]; // label texts are set with lv_label_set_text_static()
+  char changeText[16];
+  // What the widgets currently show, so a rebind only touches what changed
+  int16_t shownNeedle; // INT16_MIN = not set yet
+  int8_t shownTrend;   // sign of the change, INT8_MIN = not set yet
+  int page;            // logical page currently bound, -1 = none
+};
+
+// Virtualized horizontal pager on top of lv_tileview. Whatever the length of
+// the watchlist, only three tiles exist: the visible one and its neighbours.
+// After a swipe settles the pager shifts its logical page, rebinds the three
+// tiles and silently scrolls back to the middle one. Pages 0..coinCount-1 are
+// coins; page coinCount is the info page, whose container is reparented into
+// whichever tile shows it. Navigation wraps around.
+// Only the visible tile is bound right away; the neighbours are marked stale
+// and bound when a scroll starts, just before they come into view.
+class TilePager
+{
+public:
+  typedef void (*CreateFn)(CoinTile &tile);          // build the coin widgets into tile.tile
+  typedef void (*BindFn)(CoinTile &tile, int coin); // show coin's data in the widgets
+  typedef void (*ViewFn)();                         // what is in view may have changed
+
+  lv_obj_t *begin(lv_obj_t *parent, int coinCount, CreateFn create, BindFn bind);
+  void setInfoPage(lv_obj_t *info); // created with any parent; moved as needed
+  void onViewChanged(ViewFn fn) { _viewChanged = fn; }
+
+  void next();
+  void prev();
+  void show(int page);
+
+  int page() const { return _page; }
+  int currentCoin() const { return _page < _coinCount ? _page : -1; }
+  bool pageInView(int page) const; // visible, or a neighbour while a scroll is under way
+  void refresh(int coin); // rebind coin if it is materialized
+  void refreshAll();
+
+private:
+  static void onValueChanged(lv_event_t *e);
+  static void onScroll(lv_event_t *e);
+  void recentre();
+  void bindSlots();
+  void bindSlot(int slot);
+  void bindStale();
+  void jumpToMiddle();
+  void step(int dir);
+  int pageAt(int slot) const;
+
+  lv_obj_t *_view = NULL;
+  lv_obj_t *_info = NULL;
+  CoinTile _slots[TILE_SLOTS];
+  bool _stale[TILE_SLOTS] = {};
+  bool _scrolling = false;
+  bool _jumping = false; // our own unanimated recentring scroll
+  int _steps = 0;        // next()/prev() still to do, once the scroll ends
+  BindFn _bind = NULL;
+  ViewFn _viewChanged = NULL;
+  int _coinCount = 0;
+  int _page = 0;
+};
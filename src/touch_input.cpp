@@ -0,0 +1,110 @@
+#include "touch_input.h"
+
+#define TOUCH_TASK_STACK 2048
+#define TOUCH_TASK_PRIORITY 2 // above the fetch task, so touches are never late
+#define TOUCH_TASK_CORE 1     // next to LVGL, which consumes the samples
+#define TOUCH_RELEASE_MS 100  // re-read a held touch this often in case a release pulse was missed
+
+TouchInput *TouchInput::_instance = NULL;
+
+bool TouchInput::begin(CST816S *touch, uint8_t intPin)
+{
+  _touch = touch;
+  _instance = this;
+  // Points while touched and on release, plus the chip's own gestures
+  _touch->setIrqMode(IRQ_EN_TOUCH | IRQ_EN_CHANGE | IRQ_EN_MOTION | IRQ_ONCE_WLP);
+#ifdef ARDUINO
+  if (xTaskCreatePinnedToCore(taskEntry, "touch", TOUCH_TASK_STACK, this,
+                              TOUCH_TASK_PRIORITY, &_task, TOUCH_TASK_CORE) != pdPASS)
+    return false;
+#endif
+  attachInterrupt(digitalPinToInterrupt(intPin), onInterrupt, FALLING);
+  return true;
+}
+
+void IRAM_ATTR TouchInput::onInterrupt()
+{
+  TouchInput *self = _instance;
+  self->_stats.interrupts++;
+#ifdef ARDUINO
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(self->_task, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+#else
+  self->_pending = true;
+  if (self->_onQueued != NULL)
+    self->_onQueued();
+#endif
+}
+
+void TouchInput::service()
+{
+  _touch->TouchInt();
+  _stats.reads++;
+
+  TouchSample sample;
+  sample.pressed = _touch->getTouchType() != 0;
+  sample.x = _touch->getX();
+  sample.y = _touch->getY();
+  sample.gesture = _touch->getGesture();
+  if (sample.pressed && !_pressed)
+    _gesture = No_Gesture; // the register keeps the previous gesture until a new one
+  if (sample.gesture == _gesture)
+    sample.gesture = No_Gesture;
+  else
+    _gesture = sample.gesture;
+
+  if (!sample.pressed && !_pressed && sample.gesture == No_Gesture)
+    return; // a trailing pulse after the release
+  _pressed = sample.pressed;
+  if (_ring.push(sample))
+    _stats.samples++;
+  else
+    _stats.dropped++;
+#ifdef ARDUINO
+  if (_onQueued != NULL)
+    _onQueued();
+#endif
+}
+
+bool TouchInput::queued() const
+{
+#ifdef ARDUINO
+  return !_ring.empty();
+#else
+  return !_ring.empty() || _pending;
+#endif
+}
+
+bool TouchInput::read(TouchSample *sample)
+{
+#ifndef ARDUINO
+  if (_pending.exchange(false))
+    service();
+#endif
+  if (!_ring.pop(sample))
+    return false;
+  if (sample->gesture != No_Gesture)
+  {
+    _stats.gestures++;
+    if (_onGesture != NULL)
+      _onGesture(sample->gesture);
+  }
+  return true;
+}
+
+#ifdef ARDUINO
+void TouchInput::taskEntry(void *arg)
+{
+  TouchInput *self = static_cast<TouchInput *>(arg);
+  for (;;)
+  {
+    // Sleeps until the next INT pulse; while a finger is down, also wakes
+    // now and then so a lost release pulse can't leave LVGL pressed
+    TickType_t wait = self->_pressed ? pdMS_TO_TICKS(TOUCH_RELEASE_MS) : portMAX_DELAY;
+    ulTaskNotifyTake(pdTRUE, wait);
+    self->service();
+  }
+}
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Arduino.h>
+#include <CST816S.h>
+#include "spsc_ring.h"
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <atomic>
+#endif
+
+#define TOUCH_RING_LEN 16 // samples; LVGL drains them every indev read period
+
+struct TouchSample
+{
+  uint16_t x;
+  uint16_t y;
+  bool pressed;
+  uint8_t gesture; // the chip's GestureID, No_Gesture for plain points
+};
+
+// Each counter has a single writer: the ISR, the reader or the UI
+struct TouchStats
+{
+  uint32_t interrupts;
+  uint32_t reads; // I2C transactions
+  uint32_t samples;
+  uint32_t dropped; // ring full
+  uint32_t gestures;
+};
+
+// Interrupt-driven touch input. The controller is only read after it pulses
+// its INT line, and each reading is queued for the LVGL read callback, so an
+// untouched screen costs no I2C traffic at all. On the ESP32 the reads run on
+// a small task woken by the ISR, as Wire can't be used from an interrupt; on
+// the host they run in read() when an interrupt is pending.
+class TouchInput
+{
+public:
+  typedef void (*GestureFn)(uint8_t gesture);
+  typedef void (*WakeFn)();
+
+  bool begin(CST816S *touch, uint8_t intPin);
+  void onGesture(GestureFn fn) { _onGesture = fn; } // called from read()
+  void onQueued(WakeFn fn) { _onQueued = fn; }      // from the reader task, or the ISR on the host
+
+  // UI thread: the oldest queued sample, false if there is none
+  bool read(TouchSample *sample);
+  bool queued() const;
+
+  const TouchStats &stats() const { return _stats; }
+
+private:
+  static void IRAM_ATTR onInterrupt();
+  void service(); // one read of the controller
+
+  static TouchInput *_instance; // for the ISR
+
+  CST816S *_touch = NULL;
+  SpscRing<TouchSample, TOUCH_RING_LEN> _ring;
+  GestureFn _onGesture = NULL;
+  WakeFn _onQueued = NULL;
+  bool _pressed = false;
+  uint8_t _gesture = No_Gesture; // last one queued, until the next press
+  TouchStats _stats = {};
+
+#ifdef ARDUINO
+  static void taskEntry(void *arg);
+  TaskHandle_t _task = NULL;
+#else
+  std::atomic<bool> _pending{false};
+#endif
+};
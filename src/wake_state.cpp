@@ -0,0 +1,90 @@
+#include "wake_state.h"
+
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <string.h>
+#ifdef ARDUINO
+#include <esp_sleep.h>
+#endif
+
+#define WAKE_MAGIC 0x57414B45 // "WAKE"
+
+struct RetainedPrices
+{
+  uint32_t magic;
+  uint32_t watchlistHash;
+  uint16_t count;
+  int16_t page;
+  price_fx_t price[WAKE_COINS];
+  int32_t changeBp[WAKE_COINS];
+};
+
+struct RetainedWifi
+{
+  uint32_t magic;
+  uint8_t channel;
+  uint8_t bssid[6];
+};
+
+RTC_DATA_ATTR static RetainedPrices retainedPrices;
+RTC_DATA_ATTR static RetainedWifi retainedWifi;
+
+bool WakeState::begin(uint32_t watchlistHash)
+{
+  _hash = watchlistHash;
+  _warm = esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_UNDEFINED &&
+          retainedPrices.magic == WAKE_MAGIC && retainedPrices.watchlistHash == watchlistHash;
+  if (!_warm)
+    retainedPrices.magic = 0;
+  return _warm;
+}
+
+bool WakeState::get(int coin, price_fx_t *price, int32_t *changeBp) const
+{
+  if (!_warm || coin < 0 || coin >= retainedPrices.count || retainedPrices.price[coin] <= 0)
+    return false;
+  *price = retainedPrices.price[coin];
+  *changeBp = retainedPrices.changeBp[coin];
+  return true;
+}
+
+int WakeState::page() const
+{
+  return _warm ? retainedPrices.page : -1;
+}
+
+void WakeState::save(const CoinStore &coins, int page)
+{
+  retainedPrices.count = coins.count < WAKE_COINS ? coins.count : WAKE_COINS;
+  for (int i = 0; i < retainedPrices.count; i++)
+  {
+    const PriceRecord &record = coins.record[i];
+    retainedPrices.price[i] = record.hasPrice() ? record.price() : 0;
+    retainedPrices.changeBp[i] = record.changeBp;
+  }
+  retainedPrices.page = page;
+  retainedPrices.watchlistHash = _hash;
+  retainedPrices.magic = WAKE_MAGIC;
+}
+
+uint8_t WakeState::wifiChannel() const
+{
+  return retainedWifi.magic == WAKE_MAGIC ? retainedWifi.channel : 0;
+}
+
+const uint8_t *WakeState::wifiBssid() const
+{
+  return retainedWifi.bssid;
+}
+
+void WakeState::setWifi(uint8_t channel, const uint8_t *bssid)
+{
+  retainedWifi.channel = channel;
+  memcpy(retainedWifi.bssid, bssid, sizeof(retainedWifi.bssid));
+  retainedWifi.magic = WAKE_MAGIC;
+}
+
+void WakeState::clearWifi()
+{
+  retainedWifi.magic = 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdint.h>
+#include "coin_store.h"
+
+#define WAKE_COINS 32 // the first coins of the watchlist keep their last price
+
+// What the app needs to show its last screen right after waking from deep
+// sleep, kept in RTC slow memory: the last prices, the page that was open
+// and the access point it was connected to. Everything is validated against
+// the watchlist, so a new build or watchlist starts cold.
+class WakeState
+{
+public:
+  bool begin(uint32_t watchlistHash); // true on a warm wake with usable state
+  bool warm() const { return _warm; }
+
+  bool get(int coin, price_fx_t *price, int32_t *changeBp) const;
+  int page() const; // tile page to reopen, -1 = none
+  void save(const CoinStore &coins, int page); // just before deep sleep
+
+  // Fast-connect parameters; the channel is 0 when none are known
+  uint8_t wifiChannel() const;
+  const uint8_t *wifiBssid() const;
+  void setWifi(uint8_t channel, const uint8_t *bssid); // fetch task
+  void clearWifi();
+
+private:
+  uint32_t _hash = 0;
+  bool _warm = false;
+};
+
+enum BootPhase
+{
+  BOOT_SETUP,       // setup() entered
+  BOOT_DISPLAY,     // panel and LVGL up
+  BOOT_FIRST_FRAME, // last known screen (or the empty UI) drawn
+  BOOT_WIFI,        // associated
+  BOOT_FRESH_DATA,  // first fetched prices applied by the UI
+  BOOT_PHASES
+};
+
+// micros() at which each phase of the boot was first reached, 0 = not yet.
+// Phases are marked from the UI thread and the fetch task.
+struct BootTimeline
+{
+  std::atomic<uint32_t> us[BOOT_PHASES];
+
+  bool mark(BootPhase phase) // true the first time
+  {
+    uint32_t none = 0;
+    uint32_t now = micros();
+    return us[phase].compare_exchange_strong(none, now != 0 ? now : 1);
+  }
+  uint32_t ms(BootPhase phase) const { return us[phase] / 1000; }
+};
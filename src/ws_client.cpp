@@ -0,0 +1,295 @@
+#include "ws_client.h"
+
+#define WS_OP_CONTINUATION 0x0
+#define WS_OP_TEXT 0x1
+#define WS_OP_BINARY 0x2
+#define WS_OP_CLOSE 0x8
+#define WS_OP_PING 0x9
+#define WS_OP_PONG 0xA
+
+#define WS_CONTROL_MAX 125        // longest control frame payload
+#define WS_HANDSHAKE_TIMEOUT 5000 // ms
+
+static void base64(const uint8_t *in, size_t length, char *out)
+{
+  static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t i = 0;
+  for (; i + 2 < length; i += 3)
+  {
+    *out++ = digits[in[i] >> 2];
+    *out++ = digits[(in[i] & 0x03) << 4 | in[i + 1] >> 4];
+    *out++ = digits[(in[i + 1] & 0x0F) << 2 | in[i + 2] >> 6];
+    *out++ = digits[in[i + 2] & 0x3F];
+  }
+  if (i < length)
+  {
+    *out++ = digits[in[i] >> 2];
+    if (i + 1 < length)
+    {
+      *out++ = digits[(in[i] & 0x03) << 4 | in[i + 1] >> 4];
+      *out++ = digits[(in[i + 1] & 0x0F) << 2];
+    }
+    else
+    {
+      *out++ = digits[(in[i] & 0x03) << 4];
+      *out++ = '=';
+    }
+    *out++ = '=';
+  }
+  *out = '\0';
+}
+
+// Reads one header line without the CRLF; false on timeout
+static bool readLine(Stream &stream, char *line, size_t size)
+{
+  size_t n = 0;
+  char c;
+  while (stream.readBytes(&c, 1) == 1)
+  {
+    if (c == '\n')
+    {
+      line[n] = '\0';
+      return true;
+    }
+    if (c != '\r' && n + 1 < size)
+      line[n++] = c;
+  }
+  return false;
+}
+
+bool WsClient::connect(WiFiClientSecure &client, const char *url)
+{
+  _client = &client;
+  _remaining = 0;
+  _fin = true;
+  _inMessage = false;
+
+  const char *scheme = strstr(url, "://");
+  const char *host = scheme != NULL ? scheme + 3 : url;
+  size_t hostLength = strcspn(host, "/");
+  const char *path = host[hostLength] != '\0' ? host + hostLength : "/";
+  char hostName[64];
+  if (hostLength >= sizeof(hostName))
+    return false;
+  memcpy(hostName, host, hostLength);
+  hostName[hostLength] = '\0';
+  uint16_t port = strncmp(url, "ws://", 5) == 0 ? 80 : 443;
+  char *colon = strchr(hostName, ':');
+  if (colon != NULL)
+  {
+    port = atoi(colon + 1);
+    *colon = '\0';
+  }
+
+  if (!client.connect(hostName, port))
+    return false;
+
+  uint8_t nonce[16];
+  for (size_t i = 0; i < sizeof(nonce); i++)
+    nonce[i] = (uint8_t)random(256);
+  char key[25];
+  base64(nonce, sizeof(nonce), key);
+
+  _request.clear();
+  _request.append("GET ").append(path).append(" HTTP/1.1\r\nHost: ");
+  _request.appendf("%.*s", (int)hostLength, host);
+  _request.append("\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: ").append(key);
+  _request.append("\r\nSec-WebSocket-Version: 13\r\n\r\n");
+  if (_request.truncated())
+  {
+    client.stop();
+    return false;
+  }
+  client.write((const uint8_t *)_request.c_str(), _request.length());
+
+  // Only the status is checked; the connection is TLS already, so the
+  // Sec-WebSocket-Accept digest adds nothing worth a SHA-1 here
+  // Stream's timeout, in ms; WiFiClient::setTimeout() takes seconds on some cores
+  static_cast<Stream &>(client).setTimeout(WS_HANDSHAKE_TIMEOUT);
+  char line[128];
+  if (!readLine(client, line, sizeof(line)) || strncmp(line, "HTTP/1.1 101", 12) != 0)
+  {
+    client.stop();
+    return false;
+  }
+  while (readLine(client, line, sizeof(line)))
+  {
+    if (line[0] == '\0')
+      return true;
+  }
+  client.stop();
+  return false;
+}
+
+bool WsClient::connected()
+{
+  return _client != NULL && _client->connected();
+}
+
+void WsClient::close()
+{
+  if (connected())
+  {
+    sendFrame(WS_OP_CLOSE, NULL, 0);
+    _client->stop();
+  }
+  _inMessage = false;
+}
+
+bool WsClient::readExact(uint8_t *buffer, size_t length)
+{
+  return _client->readBytes((char *)buffer, length) == length;
+}
+
+void WsClient::skip(uint64_t length)
+{
+  uint8_t scratch[32];
+  while (length > 0)
+  {
+    size_t n = length < sizeof(scratch) ? length : sizeof(scratch);
+    if (!readExact(scratch, n))
+    {
+      _client->stop();
+      return;
+    }
+    length -= n;
+  }
+}
+
+bool WsClient::sendFrame(uint8_t opcode, const uint8_t *payload, size_t length)
+{
+  // Client frames must be masked; length is at most WS_CONTROL_MAX here
+  uint8_t frame[6 + WS_CONTROL_MAX];
+  uint32_t mask = random(0x7FFFFFFF);
+  frame[0] = 0x80 | opcode;
+  frame[1] = 0x80 | length;
+  memcpy(frame + 2, &mask, 4);
+  for (size_t i = 0; i < length; i++)
+    frame[6 + i] = payload[i] ^ frame[2 + i % 4];
+  return _client->write(frame, 6 + length) == 6 + length;
+}
+
+// Reads frame headers until a data frame; control frames are handled here
+bool WsClient::readHeader()
+{
+  for (;;)
+  {
+    uint8_t header[2];
+    if (!readExact(header, 2))
+      return false;
+    uint8_t opcode = header[0] & 0x0F;
+    bool masked = header[1] & 0x80;
+    uint64_t length = header[1] & 0x7F;
+    if (length >= 126)
+    {
+      uint8_t extended[8];
+      size_t n = length == 126 ? 2 : 8;
+      if (!readExact(extended, n))
+        return false;
+      length = 0;
+      for (size_t i = 0; i < n; i++)
+        length = length << 8 | extended[i];
+    }
+    uint8_t mask[4];
+    if (masked && !readExact(mask, 4))
+      return false; // servers don't mask, but skip the key if one does
+
+    if (opcode < WS_OP_CLOSE)
+    {
+      _opcode = opcode == WS_OP_CONTINUATION ? _opcode : opcode;
+      _fin = header[0] & 0x80;
+      _remaining = length;
+      return true;
+    }
+
+    uint8_t payload[WS_CONTROL_MAX];
+    if (length > sizeof(payload) || !readExact(payload, length))
+      return false;
+    if (opcode == WS_OP_PING)
+    {
+      _pings++;
+      sendFrame(WS_OP_PONG, payload, length);
+    }
+    else if (opcode == WS_OP_CLOSE)
+    {
+      sendFrame(WS_OP_CLOSE, payload, length < 2 ? length : 2);
+      _client->stop();
+      return false;
+    }
+  }
+}
+
+bool WsClient::nextMessage(uint32_t timeoutMs)
+{
+  if (!connected())
+    return false;
+
+  // Finish the current message first
+  while (_inMessage && read() >= 0)
+  {
+    char scratch[64];
+    readBytes(scratch, sizeof(scratch));
+  }
+
+  uint32_t start = millis();
+  for (;;)
+  {
+    while (_client->available() <= 0)
+    {
+      if (!_client->connected() || millis() - start >= timeoutMs)
+        return false;
+      delay(1);
+    }
+    if (!readHeader())
+    {
+      _client->stop();
+      return false;
+    }
+    if (_opcode == WS_OP_TEXT)
+    {
+      _inMessage = true;
+      return true;
+    }
+    // binary message: not for us
+    skip(_remaining);
+    while (!_fin && readHeader())
+      skip(_remaining);
+    _remaining = 0;
+  }
+}
+
+int WsClient::read()
+{
+  char c;
+  return readBytes(&c, 1) == 1 ? (uint8_t)c : -1;
+}
+
+size_t WsClient::readBytes(char *buffer, size_t length)
+{
+  size_t n = 0;
+  while (n < length && _inMessage)
+  {
+    if (_remaining == 0)
+    {
+      if (_fin || !readHeader())
+      {
+        _inMessage = false;
+        break;
+      }
+      continue;
+    }
+    size_t want = length - n;
+    if (want > _remaining)
+      want = _remaining;
+    size_t got = _client->readBytes(buffer + n, want);
+    if (got == 0)
+    {
+      _client->stop();
+      _inMessage = false;
+      break;
+    }
+    n += got;
+    _remaining -= got;
+  }
+  return n;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include "fixed_text.h"
+
+#define WS_REQUEST_MAX 1280 // upgrade request; the path lists every subscribed stream
+
+// Minimal RFC 6455 client for a server that pushes text messages, e.g. an
+// exchange's ticker stream. Messages are not buffered: after nextMessage()
+// the payload is read straight off the socket with read()/readBytes(), across
+// fragments, so a JSON parser can consume it as it arrives. Pings are
+// answered while reading; binary messages are skipped.
+class WsClient
+{
+public:
+  // url: wss://host[:port]/path or ws://...; the socket is opened by connect()
+  bool connect(WiFiClientSecure &client, const char *url);
+  bool connected();
+  void close();
+
+  // Waits up to timeoutMs for the next text message, discarding whatever is
+  // left of the current one. False on timeout or when the connection closed.
+  bool nextMessage(uint32_t timeoutMs);
+  int read(); // -1 at the end of the message
+  size_t readBytes(char *buffer, size_t length);
+
+  uint32_t pings() const { return _pings; }
+
+private:
+  bool readHeader();
+  bool readExact(uint8_t *buffer, size_t length);
+  bool sendFrame(uint8_t opcode, const uint8_t *payload, size_t length);
+  void skip(uint64_t length);
+
+  WiFiClientSecure *_client = NULL;
+  FixedText<WS_REQUEST_MAX> _request;
+  uint64_t _remaining = 0; // payload bytes left in the current frame
+  uint8_t _opcode = 0;     // of the current data frame
+  bool _fin = true;        // current frame ends the message
+  bool _inMessage = false;
+  uint32_t _pings = 0;
+};